@@ -136,10 +136,14 @@ loadDGraph(std::vector<unsigned>& scaleFactor,
   galois::StatTimer dGraphTimer("GraphConstructTime", "DistBench");
   dGraphTimer.start();
 
+  galois::graphs::PartitionCache cache =
+      galois::graphs::openPartitionCache<EdgeData>(
+          iterateOutEdges ? "out" : "in", scaleFactor);
+
   galois::graphs::DistGraph<NodeData, EdgeData>* loadedGraph = nullptr;
   loadedGraph =
       galois::graphs::constructGraph<NodeData, EdgeData, iterateOutEdges>(
-          scaleFactor);
+          scaleFactor, cache);
   assert(loadedGraph != nullptr);
 
 #ifdef __GALOIS_HET_CUDA__
@@ -151,6 +155,7 @@ loadDGraph(std::vector<unsigned>& scaleFactor,
   // Save local graph structure
   if (saveLocalGraph)
     (*loadedGraph).save_local_graph_to_file(localGraphFileName);
+  cache.store(*loadedGraph);
 
   return loadedGraph;
 }
@@ -178,12 +183,14 @@ loadSymmetricDGraph(std::vector<unsigned>& scaleFactor,
   galois::StatTimer dGraphTimer("GraphConstructTime", "DistBench");
   dGraphTimer.start();
 
+  galois::graphs::PartitionCache cache;
   galois::graphs::DistGraph<NodeData, EdgeData>* loadedGraph = nullptr;
 
   // make sure that the symmetric graph flag was passed in
   if (inputFileSymmetric) {
+    cache = galois::graphs::openPartitionCache<EdgeData>("sym", scaleFactor);
     loadedGraph = galois::graphs::constructSymmetricGraph<NodeData, EdgeData>(
-        scaleFactor);
+        scaleFactor, cache);
   } else {
     GALOIS_DIE("must use -symmetricGraph flag with a symmetric graph for "
                "this benchmark");
@@ -200,6 +207,7 @@ loadSymmetricDGraph(std::vector<unsigned>& scaleFactor,
   // Save local graph structure
   if (saveLocalGraph)
     (*loadedGraph).save_local_graph_to_file(localGraphFileName);
+  cache.store(*loadedGraph);
 
   return loadedGraph;
 }
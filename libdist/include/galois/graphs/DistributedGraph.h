@@ -37,6 +37,7 @@
 #include "galois/graphs/OfflineGraph.h"
 #include "galois/runtime/SyncStructures.h"
 #include "galois/runtime/DataCommMode.h"
+#include "galois/runtime/SyncEncoding.h"
 #include "galois/DynamicBitset.h"
 
 #ifdef __GALOIS_HET_CUDA__
@@ -60,6 +61,8 @@
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/unordered_map.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/stream.hpp>
 
 namespace cll = llvm::cl;
 
@@ -91,6 +94,8 @@ extern cll::opt<uint32_t> nodeAlphaRanges;
 extern cll::opt<unsigned> numFileThreads;
 //! Specifies the size of the buffer used for
 extern cll::opt<unsigned> edgePartitionSendBufSize;
+//! Specifies how often streaming partitioners exchange partition loads
+extern cll::opt<unsigned> streamSyncRounds;
 
 //! Enumeration for specifiying write location for sync calls
 enum WriteLocation {
@@ -220,6 +225,8 @@ private:
 
   galois::DynamicBitSet syncBitset;
   galois::PODResizeableArray<unsigned int> syncOffsets;
+  //! delta encoded offsets of the message being built or read
+  galois::PODResizeableArray<uint8_t> syncEncodedOffsets;
 
 protected:
   //! Prints graph statistics.
@@ -1182,15 +1189,31 @@ private:
    *
    * @param global_total_mirror_nodes number of mirror nodes on all hosts
    * @param global_total_owned_nodes number of "owned" nodes on all hosts
+   * @param max_owned_nodes max number of "owned" nodes on a host
+   * @param global_total_edges number of edges on all hosts
+   * @param max_edges max number of edges on a host
    */
   void report_master_mirror_stats(uint64_t global_total_mirror_nodes,
-                                  uint64_t global_total_owned_nodes) {
+                                  uint64_t global_total_owned_nodes,
+                                  uint64_t max_owned_nodes,
+                                  uint64_t global_total_edges,
+                                  uint64_t max_edges) {
     float replication_factor =
         (float)(global_total_mirror_nodes + numGlobalNodes) /
         (float)numGlobalNodes;
     galois::runtime::reportStat_Single(GRNAME, "ReplicationFactor",
                                        replication_factor);
 
+    // max / mean load over hosts; 1 is perfectly balanced
+    float master_balance = (global_total_owned_nodes == 0) ? 1 :
+        (float)max_owned_nodes * numHosts / (float)global_total_owned_nodes;
+    float edge_balance = (global_total_edges == 0) ? 1 :
+        (float)max_edges * numHosts / (float)global_total_edges;
+    galois::runtime::reportStat_Single(GRNAME, "MasterLoadBalance",
+                                       master_balance);
+    galois::runtime::reportStat_Single(GRNAME, "EdgeLoadBalance",
+                                       edge_balance);
+
     galois::runtime::reportStatCond_Single<MORE_DIST_STATS>(
         GRNAME, "TotalNodes", numGlobalNodes);
     galois::runtime::reportStatCond_Single<MORE_DIST_STATS>(
@@ -1206,6 +1229,9 @@ private:
 
     uint64_t global_total_mirror_nodes = size() - numOwned;
     uint64_t global_total_owned_nodes  = numOwned;
+    uint64_t global_total_edges        = sizeEdges();
+    uint64_t max_owned_nodes           = global_total_owned_nodes;
+    uint64_t max_edges                 = global_total_edges;
 
     // send info to host
     for (unsigned x = 0; x < numHosts; ++x) {
@@ -1213,7 +1239,8 @@ private:
         continue;
 
       galois::runtime::SendBuffer b;
-      gSerialize(b, global_total_mirror_nodes, global_total_owned_nodes);
+      gSerialize(b, global_total_mirror_nodes, global_total_owned_nodes,
+                 global_total_edges);
       net.sendTagged(x, galois::runtime::evilPhase, b);
     }
 
@@ -1229,10 +1256,16 @@ private:
 
       uint64_t total_mirror_nodes_from_others;
       uint64_t total_owned_nodes_from_others;
+      uint64_t total_edges_from_others;
       galois::runtime::gDeserialize(p->second, total_mirror_nodes_from_others,
-                                    total_owned_nodes_from_others);
+                                    total_owned_nodes_from_others,
+                                    total_edges_from_others);
       global_total_mirror_nodes += total_mirror_nodes_from_others;
       global_total_owned_nodes += total_owned_nodes_from_others;
+      global_total_edges += total_edges_from_others;
+      max_owned_nodes = std::max(max_owned_nodes,
+                                 total_owned_nodes_from_others);
+      max_edges = std::max(max_edges, total_edges_from_others);
     }
     increment_evilPhase();
 
@@ -1240,7 +1273,8 @@ private:
     // report stats
     if (net.ID == 0) {
       report_master_mirror_stats(global_total_mirror_nodes,
-                                 global_total_owned_nodes);
+                                 global_total_owned_nodes, max_owned_nodes,
+                                 global_total_edges, max_edges);
     }
   }
 
@@ -1397,8 +1431,21 @@ private:
                                         bit_set_count);
     }
 
-    data_mode =
-        get_data_mode<typename FnTy::ValTy>(bit_set_count, indices.size());
+    size_t encoded_offsets_size = 0;
+#ifndef __GALOIS_HET_CUDA__
+    // GPUs cannot decode encoded offsets, so only consider them on CPU runs
+    if ((enforce_data_mode == noData ||
+         enforce_data_mode == encodedOffsetsData) &&
+        bit_set_count > 0) {
+      // estimated from the density; an exact count would be another pass
+      // over the offsets for every message
+      encoded_offsets_size = galois::runtime::estimateEncodedOffsetsSize(
+          bit_set_count, indices.size());
+    }
+#endif
+
+    data_mode = get_data_mode<typename FnTy::ValTy>(
+        bit_set_count, indices.size(), encoded_offsets_size);
   }
 
   /**
@@ -2408,6 +2455,34 @@ private:
       Tserialize.start();
       gSerialize(b, data_mode, bit_set_count, bit_set_comm, val_vec);
       Tserialize.stop();
+    } else if (data_mode == encodedOffsetsData) {
+      using ValTy = typename std::remove_reference<decltype(val_vec[0])>::type;
+      galois::PODResizeableArray<uint8_t>& encoded = syncEncodedOffsets;
+      galois::runtime::PackedValues<ValTy> packed;
+      val_vec.resize(bit_set_count);
+      Tserialize.start();
+      galois::runtime::encodeOffsets(offsets, bit_set_count, encoded);
+      bool isPacked =
+          galois::runtime::packValues<ValTy>(val_vec, bit_set_count, packed);
+      size_t start  = b.size();
+      if (isPacked) {
+        gSerialize(b, data_mode, bit_set_count, encoded, isPacked, packed.base,
+                   packed.bitWidth, packed.words);
+      } else {
+        gSerialize(b, data_mode, bit_set_count, encoded, isPacked, val_vec);
+      }
+      Tserialize.stop();
+
+      size_t plain_size = sizeof(DataCommMode) + sizeof(bit_set_count) +
+                          2 * sizeof(size_t) +
+                          bit_set_count * (sizeof(unsigned int) + sizeof(ValTy));
+      size_t encoded_size = b.size() - start;
+      // negative when encoding does not pay off for this message
+      std::string statSavedBytes_str(syncTypeStr + "EncodedSavedBytes_" +
+                                     get_run_identifier(loopName));
+      galois::runtime::reportStat_Tsum(
+          GRNAME, statSavedBytes_str,
+          int64_t(plain_size) - int64_t(encoded_size));
     } else { // onlyData
       Tserialize.start();
       gSerialize(b, data_mode, val_vec);
@@ -2522,8 +2597,7 @@ private:
           bit_set_count = indices.size();
           extract_subset<SyncFnTy, syncType, true, true>(
               loopName, indices, bit_set_count, offsets, val_vec);
-        } else if (data_mode !=
-                   noData) { // bitsetData or offsetsData or gidsData
+        } else if (data_mode != noData) { // bitset/offsets/encoded/gidsData
           extract_subset<SyncFnTy, syncType, false, true>(
               loopName, indices, bit_set_count, offsets, val_vec);
         }
@@ -2657,8 +2731,7 @@ private:
           bit_set_count = indices.size();
           extract_subset<SyncFnTy, syncType, true, true, true>(
               loopName, indices, bit_set_count, offsets, val_vec, i);
-        } else if (data_mode !=
-                   noData) { // bitsetData or offsetsData or gidsData
+        } else if (data_mode != noData) { // bitset/offsets/encoded/gidsData
           // galois::gInfo(id, " node ", i, " has data to send");
           extract_subset<SyncFnTy, syncType, false, true, true>(
               loopName, indices, bit_set_count, offsets, val_vec, i);
@@ -2941,6 +3014,26 @@ private:
         convert_gid_to_lid<syncType>(loopName, offsets);
       } else if (data_mode == offsetsData) {
         galois::runtime::gDeserialize(buf, offsets);
+      } else if (data_mode == encodedOffsetsData) {
+        using ValTy =
+            typename std::remove_reference<decltype(val_vec[0])>::type;
+        galois::PODResizeableArray<uint8_t>& encoded = syncEncodedOffsets;
+        bool isPacked;
+        galois::runtime::gDeserialize(buf, encoded, isPacked);
+        galois::runtime::decodeOffsets(encoded, bit_set_count, offsets);
+
+        // data is already in its final form here
+        if (isPacked) {
+          galois::runtime::PackedValues<ValTy> packed;
+          galois::runtime::gDeserialize(buf, packed.base, packed.bitWidth,
+                                        packed.words);
+          galois::runtime::unpackValues<ValTy>(packed, bit_set_count,
+                                               val_vec);
+        } else {
+          galois::runtime::gDeserialize(buf, val_vec);
+        }
+        Tdeserialize.stop();
+        return;
       } else if (data_mode == bitsetData) {
         bit_set_comm.resize(num);
         galois::runtime::gDeserialize(buf, bit_set_comm);
@@ -3044,7 +3137,7 @@ private:
             set_subset<decltype(offsets), SyncFnTy, syncType, true, true>(
                 loopName, offsets, bit_set_count, offsets, val_vec,
                 bit_set_compute);
-          } else { // bitsetData or offsetsData
+          } else { // bitsetData, offsetsData, or encodedOffsetsData
             set_subset<decltype(sharedNodes[from_id]), SyncFnTy, syncType,
                        false, true>(loopName, sharedNodes[from_id],
                                     bit_set_count, offsets, val_vec,
@@ -3143,7 +3236,7 @@ private:
             set_subset<decltype(offsets), SyncFnTy, syncType, true, true, true>(
                 loopName, offsets, bit_set_count, offsets, val_vec,
                 bit_set_compute, i);
-          } else { // bitsetData or offsetsData
+          } else { // bitsetData, offsetsData, or encodedOffsetsData
             set_subset<decltype(sharedNodes[from_id]), SyncFnTy, syncType,
                        false, true, true>(loopName, sharedNodes[from_id],
                                           bit_set_count, offsets, val_vec,
@@ -4401,6 +4494,17 @@ public:
     // Serialize partitioning scheme specific data structures.
     boostSerializeLocalGraph(ar);
 
+    // thread ranges (all nodes, masters, nodes with edges) so that a run
+    // with the same thread count can skip recomputing them
+    uint32_t numThreads = galois::runtime::activeThreads;
+    ar << numThreads;
+    for (auto& range : specificRanges) {
+      std::vector<uint32_t> threadRanges(range.thread_ranges(),
+                                         range.thread_ranges() + numThreads +
+                                             1);
+      ar << threadRanges;
+    }
+
     outputStream.close();
     dGraphTimerSaveLocalGraph.stop();
   }
@@ -4418,13 +4522,16 @@ public:
 
     std::string fileName = localGraphFileName + "_" + std::to_string(id);
 
-    std::ifstream inputStream(fileName, std::ios::binary);
-    if (!inputStream.is_open()) {
-      std::cerr << "ERROR: Could not open " << fileName
-                << " to read local graph!!!\n";
+    // map the file instead of reading it through the page cache twice
+    boost::iostreams::stream<boost::iostreams::mapped_file_source> inputStream;
+    try {
+      inputStream.open(boost::iostreams::mapped_file_source(fileName));
+    } catch (const std::exception& e) {
+      GALOIS_DIE("Could not open ", fileName, " to read local graph: ",
+                 e.what());
     }
 
-    galois::gPrint("[", id, "] inside read_local_graph_from_file \n");
+    galois::gDebug("[", id, "] inside read_local_graph_from_file \n");
 
     boost::archive::binary_iarchive ar(inputStream, boost::archive::no_header);
 
@@ -4452,17 +4559,38 @@ public:
     // Serialize partitioning scheme specific data structures.
     boostDeSerializeLocalGraph(ar);
 
+    uint32_t savedThreads;
+    std::vector<uint32_t> savedRanges[3];
+    ar >> savedThreads;
+    for (auto& threadRanges : savedRanges) {
+      ar >> threadRanges;
+    }
+
     allNodesRanges.clear();
     masterRanges.clear();
     withEdgeRanges.clear();
     specificRanges.clear();
 
-    // find ranges again
-    determineThreadRanges();
-    determineThreadRangesMaster();
-    determineThreadRangesWithEdges();
+    if (savedThreads == galois::runtime::activeThreads) {
+      allNodesRanges = std::move(savedRanges[0]);
+      masterRanges   = std::move(savedRanges[1]);
+      withEdgeRanges = std::move(savedRanges[2]);
+    } else {
+      // find ranges again
+      determineThreadRanges();
+      determineThreadRangesMaster();
+      determineThreadRangesWithEdges();
+    }
     initializeSpecificRanges();
 
+    maxSharedSize = 0;
+    for (uint32_t h = 0; h < numHosts; ++h) {
+      if (h == id)
+        continue;
+      maxSharedSize = std::max(maxSharedSize, masterNodes[h].size());
+      maxSharedSize = std::max(maxSharedSize, mirrorNodes[h].size());
+    }
+
     // Exchange information among hosts
     // send_info_to_host();
 
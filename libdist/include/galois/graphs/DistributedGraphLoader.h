@@ -37,6 +37,8 @@
 #include "galois/graphs/Generic.h"
 #include "galois/graphs/GenericPartitioners.h"
 
+#include <typeinfo>
+
 /*******************************************************************************
  * Supported partitioning schemes
  ******************************************************************************/
@@ -60,7 +62,9 @@ enum PARTITIONING_SCHEME {
   CEC,                    //!< custom edge cut
   GCVC,                    //!< generic cvc
   GHIVC,                    //!< generic hivc
-  GOEC                    //!< generic oec
+  GOEC,                    //!< generic oec
+  GHDRF,                   //!< streaming HDRF vertex cut
+  GFENNEL                  //!< streaming Fennel edge cut
 };
 
 /**
@@ -103,6 +107,10 @@ inline const char* EnumToString(PARTITIONING_SCHEME e) {
     return "ghivc";
   case GOEC:
     return "goec";
+  case GHDRF:
+    return "ghdrf";
+  case GFENNEL:
+    return "gfennel";
   default:
     GALOIS_DIE("Unsupported partition");
   }
@@ -136,10 +144,103 @@ extern cll::opt<bool> readFromFile;
 extern cll::opt<std::string> localGraphFileName;
 //! if true, the local graph structure will be saved to disk after partitioning
 extern cll::opt<bool> saveLocalGraph;
+//! directory holding the partition cache; empty disables the cache
+extern cll::opt<std::string> partitionCacheDir;
 
 namespace galois {
 namespace graphs {
 
+/*******************************************************************************
+ * Partition cache
+ ******************************************************************************/
+
+/**
+ * Handle to this host's entry in the on-disk partition cache.
+ *
+ * An entry is the local graph written by save_local_graph_to_file plus a
+ * small meta file written after it. The meta file records a key hashed from
+ * the input files, host count, and partitioning options, so a cache entry is
+ * only used if every host finds a meta file with the current key. A
+ * default-constructed handle falls back to the -readFromFile and
+ * -localGraphFileName options.
+ */
+class PartitionCache {
+  //! prefix of this entry's files; empty if the cache is not used
+  std::string prefix;
+  //! key recorded in the meta file
+  uint64_t key;
+  //! true if all hosts found a valid entry
+  bool hit;
+
+public:
+  PartitionCache() : prefix(), key(0), hit(false) {}
+
+  PartitionCache(const std::string& _prefix, uint64_t _key, bool _hit)
+      : prefix(_prefix), key(_key), hit(_hit) {}
+
+  //! Returns true if the local graph should be read from disk
+  bool readLocal() const { return readFromFile || hit; }
+
+  //! Returns the name of the local graph file to read
+  std::string localName() const {
+    return prefix.empty() ? std::string(localGraphFileName) : prefix;
+  }
+
+  /**
+   * Saves a freshly partitioned graph to the cache if the lookup missed.
+   *
+   * @param graph graph that was just constructed
+   */
+  template <typename GraphTy>
+  void store(GraphTy& graph) const;
+};
+
+/**
+ * Looks up the cache entry for the current command line options.
+ *
+ * Collective: every host must call this.
+ *
+ * @param variant string distinguishing graphs built from the same input and
+ * partitioning scheme (edge direction and edge data type)
+ * @param scaleFactor how nodes are split among hosts
+ * @returns handle to the entry; default handle if the cache is disabled
+ */
+PartitionCache openPartitionCache(const std::string& variant,
+                                  const std::vector<unsigned>& scaleFactor);
+
+/**
+ * Writes the meta file that marks this host's cache entry as complete.
+ *
+ * @param prefix prefix of the entry's files
+ * @param key key to record
+ */
+void commitPartitionCache(const std::string& prefix, uint64_t key);
+
+template <typename GraphTy>
+void PartitionCache::store(GraphTy& graph) const {
+  if (prefix.empty() || hit) {
+    return;
+  }
+  graph.save_local_graph_to_file(prefix);
+  commitPartitionCache(prefix, key);
+}
+
+/**
+ * Looks up the cache entry for a graph with the given edge data.
+ *
+ * @tparam EdgeData edge data stored in the graph
+ * @param direction edges the graph iterates over ("out", "in", or "sym")
+ * @param scaleFactor how nodes are split among hosts
+ * @returns handle to the entry; default handle if the cache is disabled
+ */
+template <typename EdgeData>
+PartitionCache openPartitionCache(const char* direction,
+                                  const std::vector<unsigned>& scaleFactor) {
+  return openPartitionCache(std::string(direction) + "_" +
+                                typeid(EdgeData).name(),
+                            scaleFactor);
+}
+
 /*******************************************************************************
  * Graph-loading functions
  ******************************************************************************/
@@ -258,7 +359,8 @@ constructTwoWayGraph(std::vector<unsigned>& scaleFactor) {
  */
 template <typename NodeData, typename EdgeData>
 DistGraph<NodeData, EdgeData>*
-constructSymmetricGraph(std::vector<unsigned>& scaleFactor) {
+constructSymmetricGraph(std::vector<unsigned>& scaleFactor,
+                        const PartitionCache& cache = PartitionCache()) {
   if (!inputFileSymmetric) {
     GALOIS_DIE("Calling constructSymmetricGraph without inputFileSymmetric "
                "flag");
@@ -279,6 +381,8 @@ constructSymmetricGraph(std::vector<unsigned>& scaleFactor) {
   using GenericCVC = DistGraphGeneric<NodeData, EdgeData, GenericCVC>;
   using GenericHVC = DistGraphGeneric<NodeData, EdgeData, GenericHVC>;
   using GenericEC = DistGraphGeneric<NodeData, EdgeData, NoCommunication>;
+  using GenericHDRF = DistGraphGeneric<NodeData, EdgeData, GenericHDRF>;
+  using GenericFennel = DistGraphGeneric<NodeData, EdgeData, GenericFennel>;
 
   auto& net = galois::runtime::getSystemNetworkInterface();
 
@@ -286,25 +390,25 @@ constructSymmetricGraph(std::vector<unsigned>& scaleFactor) {
   case OEC:
   case IEC:
     return new Graph_edgeCut(inputFile, partFolder, net.ID, net.Num,
-                             scaleFactor, false, readFromFile,
-                             localGraphFileName);
+                             scaleFactor, false, cache.readLocal(),
+                             cache.localName());
   case HOVC:
   case HIVC:
     return new Graph_vertexCut(inputFile, partFolder, net.ID, net.Num,
                                scaleFactor, false, VCutThreshold, false,
-                               readFromFile, localGraphFileName);
+                               cache.readLocal(), cache.localName());
   case BOARD2D_VCUT:
     return new Graph_checkerboardCut(inputFile, partFolder, net.ID, net.Num,
                                      scaleFactor, false);
   case CART_VCUT:
   case CART_VCUT_IEC:
     return new Graph_cartesianCut(inputFile, partFolder, net.ID, net.Num,
-                                  scaleFactor, false, readFromFile,
-                                  localGraphFileName);
+                                  scaleFactor, false, cache.readLocal(),
+                                  cache.localName());
   case CART_VCUT_OLD:
     return new Graph_cartesianCutOld(inputFile, partFolder, net.ID, net.Num,
-                                     scaleFactor, false, readFromFile,
-                                     localGraphFileName);
+                                     scaleFactor, false, cache.readLocal(),
+                                     cache.localName());
   case JAGGED_CYCLIC_VCUT:
     return new Graph_jaggedCut(inputFile, partFolder, net.ID, net.Num,
                                scaleFactor, false);
@@ -322,12 +426,20 @@ constructSymmetricGraph(std::vector<unsigned>& scaleFactor) {
                                    scaleFactor, vertexIDMapFileName, false);
   case GCVC:
     return new GenericCVC(inputFile, net.ID, net.Num, false,
-                          readFromFile, localGraphFileName);
+                          cache.readLocal(), cache.localName());
   case GHIVC:
-    return new GenericHVC(inputFile, net.ID, net.Num, false);
+    return new GenericHVC(inputFile, net.ID, net.Num, false,
+                      cache.readLocal(), cache.localName());
 
   case GOEC:
-    return new GenericEC(inputFile, net.ID, net.Num, false);
+    return new GenericEC(inputFile, net.ID, net.Num, false,
+                     cache.readLocal(), cache.localName());
+  case GHDRF:
+    return new GenericHDRF(inputFile, net.ID, net.Num, false,
+                       cache.readLocal(), cache.localName());
+  case GFENNEL:
+    return new GenericFennel(inputFile, net.ID, net.Num, false,
+                         cache.readLocal(), cache.localName());
 
   default:
     GALOIS_DIE("Error: partition scheme specified is invalid");
@@ -351,7 +463,8 @@ constructSymmetricGraph(std::vector<unsigned>& scaleFactor) {
 template <typename NodeData, typename EdgeData, bool iterateOut = true,
           typename std::enable_if<iterateOut>::type* = nullptr>
 DistGraph<NodeData, EdgeData>*
-constructGraph(std::vector<unsigned>& scaleFactor) {
+constructGraph(std::vector<unsigned>& scaleFactor,
+               const PartitionCache& cache = PartitionCache()) {
   typedef DistGraphEdgeCut<NodeData, EdgeData> Graph_edgeCut;
   typedef DistGraphCustomEdgeCut<NodeData, EdgeData> Graph_customEdgeCut;
   typedef DistGraphHybridCut<NodeData, EdgeData> Graph_vertexCut;
@@ -372,26 +485,28 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
   using GenericCVC = DistGraphGeneric<NodeData, EdgeData, GenericCVC>;
   using GenericHVC = DistGraphGeneric<NodeData, EdgeData, GenericHVC>;
   using GenericEC = DistGraphGeneric<NodeData, EdgeData, NoCommunication>;
+  using GenericHDRF = DistGraphGeneric<NodeData, EdgeData, GenericHDRF>;
+  using GenericFennel = DistGraphGeneric<NodeData, EdgeData, GenericFennel>;
 
   auto& net = galois::runtime::getSystemNetworkInterface();
 
   // 1 host = no concept of cut; just load from edgeCut, no transpose
   if (net.Num == 1) {
     return new Graph_edgeCut(inputFile, partFolder, net.ID, net.Num,
-                             scaleFactor, false, readFromFile,
-                             localGraphFileName);
+                             scaleFactor, false, cache.readLocal(),
+                             cache.localName());
   }
 
   switch (partitionScheme) {
   case OEC:
     return new Graph_edgeCut(inputFile, partFolder, net.ID, net.Num,
-                             scaleFactor, false, readFromFile,
-                             localGraphFileName);
+                             scaleFactor, false, cache.readLocal(),
+                             cache.localName());
   case IEC:
     if (inputFileTranspose.size()) {
       return new Graph_edgeCut(inputFileTranspose, partFolder, net.ID, net.Num,
-                               scaleFactor, true, readFromFile,
-                               localGraphFileName);
+                               scaleFactor, true, cache.readLocal(),
+                               cache.localName());
     } else {
       GALOIS_DIE("Error: attempting incoming edge cut without transpose "
                  "graph");
@@ -400,12 +515,12 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
   case HOVC:
     return new Graph_vertexCut(inputFile, partFolder, net.ID, net.Num,
                                scaleFactor, false, VCutThreshold, false,
-                               readFromFile, localGraphFileName);
+                               cache.readLocal(), cache.localName());
   case HIVC:
     if (inputFileTranspose.size()) {
       return new Graph_vertexCut(inputFileTranspose, partFolder, net.ID,
                                  net.Num, scaleFactor, true, VCutThreshold,
-                                 false, readFromFile, localGraphFileName);
+                                 false, cache.readLocal(), cache.localName());
     } else {
       GALOIS_DIE("Error: attempting incoming hybrid cut without transpose "
                  "graph");
@@ -416,16 +531,16 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
                                      scaleFactor, false);
   case CART_VCUT:
     return new Graph_cartesianCut(inputFile, partFolder, net.ID, net.Num,
-                                  scaleFactor, false, readFromFile,
-                                  localGraphFileName);
+                                  scaleFactor, false, cache.readLocal(),
+                                  cache.localName());
   case CART_VCUT_IEC:
     return new Graph_cartesianCut(inputFileTranspose, partFolder, net.ID, net.Num,
-                                  scaleFactor, true, readFromFile,
-                                  localGraphFileName);
+                                  scaleFactor, true, cache.readLocal(),
+                                  cache.localName());
   case CART_VCUT_OLD:
     return new Graph_cartesianCutOld(inputFile, partFolder, net.ID, net.Num,
-                                     scaleFactor, false, readFromFile,
-                                     localGraphFileName);
+                                     scaleFactor, false, cache.readLocal(),
+                                     cache.localName());
   case JAGGED_CYCLIC_VCUT:
     return new Graph_jaggedCut(inputFile, partFolder, net.ID, net.Num,
                                scaleFactor, false);
@@ -442,11 +557,12 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
     return new Graph_customEdgeCut(inputFile, partFolder, net.ID, net.Num,
                                    scaleFactor, vertexIDMapFileName, false);
   case GCVC:
-    return new GenericCVC(inputFile, net.ID, net.Num, false, readFromFile,
-                          localGraphFileName);
+    return new GenericCVC(inputFile, net.ID, net.Num, false, cache.readLocal(),
+                          cache.localName());
   case GHIVC:
     if (inputFileTranspose.size()) {
-      return new GenericHVC(inputFileTranspose, net.ID, net.Num, true);
+      return new GenericHVC(inputFileTranspose, net.ID, net.Num, true,
+                      cache.readLocal(), cache.localName());
     } else {
       GALOIS_DIE("Error: attempting generic incoming hybrid cut without "
                  "transpose graph");
@@ -454,7 +570,14 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
     }
 
   case GOEC:
-    return new GenericEC(inputFile, net.ID, net.Num, false);
+    return new GenericEC(inputFile, net.ID, net.Num, false,
+                     cache.readLocal(), cache.localName());
+  case GHDRF:
+    return new GenericHDRF(inputFile, net.ID, net.Num, false,
+                       cache.readLocal(), cache.localName());
+  case GFENNEL:
+    return new GenericFennel(inputFile, net.ID, net.Num, false,
+                         cache.readLocal(), cache.localName());
 
 
   default:
@@ -480,7 +603,8 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
 template <typename NodeData, typename EdgeData, bool iterateOut = true,
           typename std::enable_if<!iterateOut>::type* = nullptr>
 DistGraph<NodeData, EdgeData>*
-constructGraph(std::vector<unsigned>& scaleFactor) {
+constructGraph(std::vector<unsigned>& scaleFactor,
+               const PartitionCache& cache = PartitionCache()) {
   typedef DistGraphEdgeCut<NodeData, EdgeData> Graph_edgeCut;
   typedef DistGraphHybridCut<NodeData, EdgeData> Graph_vertexCut;
   typedef DistGraphCartesianCut<NodeData, EdgeData, true>
@@ -504,6 +628,8 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
   using GenericCVC = DistGraphGeneric<NodeData, EdgeData, GenericCVCColumnFlip>;
   using GenericHVC = DistGraphGeneric<NodeData, EdgeData, GenericHVC>;
   using GenericEC = DistGraphGeneric<NodeData, EdgeData, NoCommunication>;
+  using GenericHDRF = DistGraphGeneric<NodeData, EdgeData, GenericHDRF>;
+  using GenericFennel = DistGraphGeneric<NodeData, EdgeData, GenericFennel>;
 
   auto& net = galois::runtime::getSystemNetworkInterface();
 
@@ -511,29 +637,29 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
   if (net.Num == 1) {
     if (inputFileTranspose.size()) {
       return new Graph_edgeCut(inputFileTranspose, partFolder, net.ID, net.Num,
-                               scaleFactor, false, readFromFile,
-                               localGraphFileName);
+                               scaleFactor, false, cache.readLocal(),
+                               cache.localName());
     } else {
       fprintf(stderr, "WARNING: Loading transpose graph through in-memory "
                       "transpose to iterate over in-edges: pass in transpose "
                       "graph with -graphTranspose to avoid unnecessary "
                       "overhead.\n");
       return new Graph_edgeCut(inputFile, partFolder, net.ID, net.Num,
-                               scaleFactor, true, readFromFile,
-                               localGraphFileName);
+                               scaleFactor, true, cache.readLocal(),
+                               cache.localName());
     }
   }
 
   switch (partitionScheme) {
   case OEC:
     return new Graph_edgeCut(inputFile, partFolder, net.ID, net.Num,
-                             scaleFactor, true, readFromFile,
-                             localGraphFileName);
+                             scaleFactor, true, cache.readLocal(),
+                             cache.localName());
   case IEC:
     if (inputFileTranspose.size()) {
       return new Graph_edgeCut(inputFileTranspose, partFolder, net.ID, net.Num,
-                               scaleFactor, false, readFromFile,
-                               localGraphFileName);
+                               scaleFactor, false, cache.readLocal(),
+                               cache.localName());
     } else {
       GALOIS_DIE("Error: attempting incoming edge cut without transpose "
                  "graph");
@@ -542,12 +668,12 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
   case HOVC:
     return new Graph_vertexCut(inputFile, partFolder, net.ID, net.Num,
                                scaleFactor, true, VCutThreshold, false,
-                               readFromFile, localGraphFileName);
+                               cache.readLocal(), cache.localName());
   case HIVC:
     if (inputFileTranspose.size()) {
       return new Graph_vertexCut(inputFileTranspose, partFolder, net.ID,
                                  net.Num, scaleFactor, false, VCutThreshold,
-                                 false, readFromFile, localGraphFileName);
+                                 false, cache.readLocal(), cache.localName());
     } else {
       GALOIS_DIE("Error: (hivc) iterate over in-edges without transpose graph");
       break;
@@ -564,21 +690,21 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
 
   case CART_VCUT:
     return new Graph_cartesianCut(inputFile, partFolder, net.ID,
-                                  net.Num, scaleFactor, true, readFromFile,
-                                  localGraphFileName);
+                                  net.Num, scaleFactor, true, cache.readLocal(),
+                                  cache.localName());
   case CART_VCUT_IEC:
     if (inputFileTranspose.size()) {
       return new Graph_cartesianCut(inputFileTranspose, partFolder, net.ID,
-                                    net.Num, scaleFactor, false, readFromFile,
-                                    localGraphFileName);
+                                    net.Num, scaleFactor, false,
+                                    cache.readLocal(), cache.localName());
     } else {
       GALOIS_DIE("Error: (cvc) iterate over in-edges without transpose graph");
       break;
     }
   case CART_VCUT_OLD:
     return new Graph_cartesianCutOld(inputFile, partFolder, net.ID,
-                                     net.Num, scaleFactor, true, readFromFile,
-                                     localGraphFileName);
+                                     net.Num, scaleFactor, true,
+                                     cache.readLocal(), cache.localName());
   case JAGGED_CYCLIC_VCUT:
     if (inputFileTranspose.size()) {
       return new Graph_jaggedCut(inputFileTranspose, partFolder, net.ID,
@@ -627,12 +753,13 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
 
   case GCVC:
     // read regular partition and then flip it
-    return new GenericCVC(inputFile, net.ID, net.Num, true, readFromFile,
-                          localGraphFileName);
+    return new GenericCVC(inputFile, net.ID, net.Num, true, cache.readLocal(),
+                          cache.localName());
 
   case GHIVC:
     if (inputFileTranspose.size()) {
-      return new GenericHVC(inputFileTranspose, net.ID, net.Num, false);
+      return new GenericHVC(inputFileTranspose, net.ID, net.Num, false,
+                      cache.readLocal(), cache.localName());
     } else {
       GALOIS_DIE("Error: attempting generic incoming hybrid cut without "
                  "transpose graph");
@@ -640,7 +767,14 @@ constructGraph(std::vector<unsigned>& scaleFactor) {
     }
 
   case GOEC:
-    return new GenericEC(inputFile, net.ID, net.Num, true);
+    return new GenericEC(inputFile, net.ID, net.Num, true,
+                     cache.readLocal(), cache.localName());
+  case GHDRF:
+    return new GenericHDRF(inputFile, net.ID, net.Num, true,
+                       cache.readLocal(), cache.localName());
+  case GFENNEL:
+    return new GenericFennel(inputFile, net.ID, net.Num, true,
+                         cache.readLocal(), cache.localName());
 
 
   default:
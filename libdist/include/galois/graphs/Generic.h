@@ -330,6 +330,103 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
   }
 
  private:
+  //! true if the partitioner assigns edges while streaming over them
+  using StreamingTag =
+      std::integral_constant<bool, Partitioner::isStreaming()>;
+
+  /**
+   * Returns the host an edge belongs to. Streaming partitioners return the
+   * decision made for that edge (by edge ID) in the streaming pass.
+   */
+  uint32_t edgeOwner(uint32_t src, uint32_t dst, uint64_t numEdges,
+                     uint64_t edgeID) const {
+    return edgeOwner(src, dst, numEdges, edgeID, StreamingTag());
+  }
+
+  uint32_t edgeOwner(uint32_t src, uint32_t dst, uint64_t numEdges, uint64_t,
+                     std::false_type) const {
+    return graphPartitioner->getEdgeOwner(src, dst, numEdges);
+  }
+
+  uint32_t edgeOwner(uint32_t src, uint32_t dst, uint64_t numEdges,
+                     uint64_t edgeID, std::true_type) const {
+    return graphPartitioner->getEdgeOwner(src, dst, numEdges, edgeID);
+  }
+
+  void streamPartition(galois::graphs::BufferedGraph<EdgeTy>&,
+                       std::false_type) {}
+
+  /**
+   * Single pass over the read edges for streaming partitioners. The read
+   * nodes are streamed in streamSyncRounds blocks; after each block the
+   * partition loads assigned by each host are exchanged so that later
+   * decisions see the global load. Masters decided by the partitioner (if
+   * any) are exchanged at the end.
+   *
+   * @param bufGraph local graph to read
+   */
+  void streamPartition(galois::graphs::BufferedGraph<EdgeTy>& bufGraph,
+                       std::true_type) {
+    auto& net = galois::runtime::getSystemNetworkInterface();
+    uint64_t nodeBegin = base_DistGraph::gid2host[base_DistGraph::id].first;
+    uint64_t nodeEnd   = base_DistGraph::gid2host[base_DistGraph::id].second;
+
+    galois::StatTimer streamTimer("StreamingPartition", GRNAME);
+    streamTimer.start();
+
+    graphPartitioner->streamInit(bufGraph, base_DistGraph::numGlobalEdges);
+
+    unsigned rounds = std::max(1u, (unsigned)streamSyncRounds);
+    for (unsigned r = 0; r < rounds; r++) {
+      uint64_t blockBegin;
+      uint64_t blockEnd;
+      std::tie(blockBegin, blockEnd) =
+          galois::block_range(nodeBegin, nodeEnd, r, rounds);
+      graphPartitioner->streamAssign(bufGraph, blockBegin, blockEnd);
+
+      std::vector<uint64_t> loadDelta = graphPartitioner->takeLoadDelta();
+      for (unsigned h = 0; h < net.Num; h++) {
+        if (h == net.ID) continue;
+        galois::runtime::SendBuffer b;
+        galois::runtime::gSerialize(b, loadDelta);
+        net.sendTagged(h, galois::runtime::evilPhase, b);
+      }
+      net.flush();
+      for (unsigned h = 0; h < net.Num - 1; h++) {
+        decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+        do {
+          p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+        } while (!p);
+        std::vector<uint64_t> remoteDelta;
+        galois::runtime::gDeserialize(p->second, remoteDelta);
+        graphPartitioner->addRemoteLoad(remoteDelta);
+      }
+      base_DistGraph::increment_evilPhase();
+    }
+
+    std::vector<uint32_t> readMasters = graphPartitioner->getReadMasters();
+    for (unsigned h = 0; h < net.Num; h++) {
+      if (h == net.ID) continue;
+      galois::runtime::SendBuffer b;
+      galois::runtime::gSerialize(b, readMasters);
+      net.sendTagged(h, galois::runtime::evilPhase, b);
+    }
+    net.flush();
+    for (unsigned h = 0; h < net.Num - 1; h++) {
+      decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+      do {
+        p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+      } while (!p);
+      std::vector<uint32_t> remoteMasters;
+      galois::runtime::gDeserialize(p->second, remoteMasters);
+      graphPartitioner->setReadMasters(p->first, remoteMasters);
+    }
+    base_DistGraph::increment_evilPhase();
+
+    graphPartitioner->streamFinish();
+    streamTimer.stop();
+  }
+
   void edgeCutInspection(galois::graphs::BufferedGraph<EdgeTy>& bufGraph,
                          galois::StatTimer& inspectionTimer,
                          uint64_t edgeOffset,
@@ -580,6 +677,9 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
     uint32_t numRead = base_DistGraph::gid2host[base_DistGraph::id].second -
                        base_DistGraph::gid2host[base_DistGraph::id].first;
 
+    // streaming partitioners make their decisions in one pass first
+    streamPartition(bufGraph, StreamingTag());
+
     // allocate space for outgoing edges
     for (uint32_t i = 0; i < base_DistGraph::numHosts; ++i) {
       numOutgoingEdges[i].assign(numRead, 0);
@@ -651,7 +751,7 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
           for (; ee != ee_end; ee++) {
             uint32_t dst = bufGraph.edgeDestination(*ee);
             uint32_t hostBelongs = -1;
-            hostBelongs = graphPartitioner->getEdgeOwner(src, dst, numEdgesL);
+            hostBelongs = edgeOwner(src, dst, numEdgesL, *ee);
 
             numOutgoingEdges[hostBelongs][src - globalOffset] += 1;
             hostHasOutgoing.set(hostBelongs);
@@ -1293,8 +1393,7 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
           uint32_t gdst = bufGraph.edgeDestination(*ee);
           auto gdata    = bufGraph.edgeData(*ee);
 
-          uint32_t hostBelongs =
-            graphPartitioner->getEdgeOwner(src, gdst, numEdgesL);
+          uint32_t hostBelongs = edgeOwner(src, gdst, numEdgesL, *ee);
           if (hostBelongs == id) {
             // edge belongs here, construct on self
             assert(this->isLocal(src));
@@ -1428,8 +1527,7 @@ class DistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
 
         for (; ee != ee_end; ++ee) {
           uint32_t gdst = bufGraph.edgeDestination(*ee);
-          uint32_t hostBelongs =
-            graphPartitioner->getEdgeOwner(src, gdst, numEdges);
+          uint32_t hostBelongs = edgeOwner(src, gdst, numEdges, *ee);
 
           if (hostBelongs == id) {
             // edge belongs here, construct on self
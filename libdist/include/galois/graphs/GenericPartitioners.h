@@ -2,7 +2,10 @@
 #define _GALOIS_DIST_GENERICPARTS_H
 
 #include "DistributedGraph.h"
+#include "galois/ParallelSTL.h"
 #include <utility>
+#include <cmath>
+#include <limits>
 
 class NoCommunication {
   std::vector<std::pair<uint64_t, uint64_t>> _gid2host;
@@ -57,6 +60,10 @@ class NoCommunication {
   bool noCommunication() {
     return true;
   }
+
+  constexpr static bool isStreaming() {
+    return false;
+  }
 };
 
 class GenericCVC {
@@ -224,6 +231,10 @@ class GenericCVC {
   bool noCommunication() {
     return false;
   }
+
+  constexpr static bool isStreaming() {
+    return false;
+  }
 };
 
 // same as above, except columns are flipped (changes behavior of vertex cut
@@ -392,6 +403,10 @@ class GenericCVCColumnFlip {
   bool noCommunication() {
     return false;
   }
+
+  constexpr static bool isStreaming() {
+    return false;
+  }
 };
 
 class GenericHVC {
@@ -458,5 +473,433 @@ class GenericHVC {
   bool noCommunication() {
     return false;
   }
+
+  constexpr static bool isStreaming() {
+    return false;
+  }
+};
+
+/**
+ * Streaming vertex cut (HDRF: High Degree Replicated First). Masters are
+ * blocked like the other generic policies; every edge read by this host is
+ * assigned in one pass to the host maximizing
+ *
+ *   g(src, h) + g(dst, h) + lambda * balance(h)
+ *
+ * where g(v, h) = 1 + (1 - theta(v)) if h already holds a replica of v,
+ * theta(v) is v's share of the combined (partial) degree, and balance(h)
+ * favors hosts with a low edge load. Loads of other hosts are only known as
+ * of the last load exchange done by DistGraphGeneric between streaming
+ * blocks. The owner of each edge is recorded so that edge sending replays
+ * the decisions made during inspection.
+ *
+ * Replicas and degrees are not exchanged: each host scores with the
+ * replicas created by its own assignments and the degrees seen in its own
+ * stream, i.e. every host runs HDRF on its share of the edges. State is
+ * kept only for the nodes this host touches (read nodes and destinations
+ * of read edges), so it takes O(touched * (hosts / 8 + 4)) bytes rather
+ * than growing with the global node count.
+ */
+class GenericHDRF {
+  std::vector<std::pair<uint64_t, uint64_t>> _gid2host;
+  uint32_t _hostID;
+  uint32_t _numHosts;
+  double _lambda;
+
+  uint64_t _firstEdge;
+  //! owner of every edge this host reads, indexed by edge ID - _firstEdge
+  std::vector<uint32_t> _edgeOwner;
+  //! local ID of the destination of every edge this host reads; read nodes
+  //! come first, then the other destinations in GID order
+  std::vector<uint32_t> _edgeLocalDst;
+  //! replicas created by this host; bit local ID * _numHosts + host
+  galois::DynamicBitSet _replicas;
+  //! partial degree of every touched node as seen by this host's stream
+  std::vector<galois::CopyableAtomic<uint32_t>> _degree;
+  //! edges this host assigned to each host
+  std::vector<galois::CopyableAtomic<uint64_t>> _localLoad;
+  //! part of _localLoad already sent to other hosts
+  std::vector<uint64_t> _sentLoad;
+  //! edges other hosts assigned to each host (as of the last exchange)
+  std::vector<uint64_t> _remoteLoad;
+
+  uint64_t load(uint32_t h) const { return _localLoad[h] + _remoteLoad[h]; }
+
+  uint32_t pickHost(uint32_t src, uint32_t dst) const {
+    uint64_t maxLoad = 0;
+    uint64_t minLoad = std::numeric_limits<uint64_t>::max();
+    for (uint32_t h = 0; h < _numHosts; ++h) {
+      maxLoad = std::max(maxLoad, load(h));
+      minLoad = std::min(minLoad, load(h));
+    }
+
+    double srcDegree = _degree[src];
+    double dstDegree = _degree[dst];
+    double thetaSrc  = srcDegree / (srcDegree + dstDegree);
+    double thetaDst  = 1.0 - thetaSrc;
+
+    uint32_t bestHost = _hostID;
+    double bestScore  = -1.0;
+    for (uint32_t h = 0; h < _numHosts; ++h) {
+      double score = 0;
+      if (_replicas.test((size_t)src * _numHosts + h)) {
+        score += 2.0 - thetaSrc;
+      }
+      if (_replicas.test((size_t)dst * _numHosts + h)) {
+        score += 2.0 - thetaDst;
+      }
+      score += _lambda * (double)(maxLoad - load(h)) /
+               (1.0 + (double)(maxLoad - minLoad));
+      if (score > bestScore) {
+        bestScore = score;
+        bestHost  = h;
+      }
+    }
+    return bestHost;
+  }
+
+ public:
+  GenericHDRF(uint32_t hostID, uint32_t numHosts) {
+    _hostID   = hostID;
+    _numHosts = numHosts;
+    _lambda   = 1.1; // > 1 trades replication for balance
+  }
+
+  void saveGIDToHost(std::vector<std::pair<uint64_t, uint64_t>>& gid2host) {
+    _gid2host = gid2host;
+  }
+
+  uint32_t getMaster(uint32_t gid) const {
+    for (auto h = 0U; h < _numHosts; ++h) {
+      uint64_t start, end;
+      std::tie(start, end) = _gid2host[h];
+      if (gid >= start && gid < end) {
+        return h;
+      }
+    }
+    assert(false);
+    return _numHosts;
+  }
+
+  uint32_t getEdgeOwner(uint32_t, uint32_t, uint64_t, uint64_t edgeID) const {
+    assert(edgeID - _firstEdge < _edgeOwner.size());
+    return _edgeOwner[edgeID - _firstEdge];
+  }
+
+  bool isVertexCut() const {
+    return true;
+  }
+
+  constexpr static bool isCartCut() {
+    return false;
+  }
+
+  // not used by this
+  bool isNotCommunicationPartner(unsigned, unsigned, WriteLocation,
+                                 ReadLocation, bool) {
+    return false;
+  }
+
+  void serializePartition(boost::archive::binary_oarchive&) {
+    return;
+  }
+
+  void deserializePartition(boost::archive::binary_iarchive&) {
+    return;
+  }
+
+  bool noCommunication() {
+    return false;
+  }
+
+  constexpr static bool isStreaming() {
+    return true;
+  }
+
+  /**
+   * Allocate streaming state for the nodes/edges read by this host and map
+   * the destinations of read edges to local IDs.
+   */
+  template <typename EdgeTy>
+  void streamInit(galois::graphs::BufferedGraph<EdgeTy>& bufGraph, uint64_t) {
+    uint64_t nodeBegin = _gid2host[_hostID].first;
+    uint64_t nodeEnd   = _gid2host[_hostID].second;
+
+    _firstEdge = 0;
+    if (nodeBegin != nodeEnd) {
+      _firstEdge = *bufGraph.edgeBegin(nodeBegin);
+      _edgeOwner.resize(*bufGraph.edgeEnd(nodeEnd - 1) - _firstEdge);
+    }
+
+    // destinations that are not read nodes, sorted and deduplicated
+    std::vector<uint32_t> others(_edgeOwner.size());
+    galois::do_all(
+        galois::iterate(nodeBegin, nodeEnd),
+        [&](uint64_t src) {
+          for (auto ee = bufGraph.edgeBegin(src), ee_end = bufGraph.edgeEnd(src);
+               ee != ee_end; ++ee) {
+            others[*ee - _firstEdge] = bufGraph.edgeDestination(*ee);
+          }
+        },
+        galois::steal(), galois::no_stats());
+    _edgeLocalDst = others;
+    galois::ParallelSTL::sort(others.begin(), others.end());
+    others.erase(std::unique(others.begin(), others.end()), others.end());
+    others.erase(std::lower_bound(others.begin(), others.end(), nodeBegin),
+                 std::lower_bound(others.begin(), others.end(), nodeEnd));
+
+    uint32_t numRead = nodeEnd - nodeBegin;
+    galois::do_all(
+        galois::iterate(_edgeLocalDst.begin(), _edgeLocalDst.end()),
+        [&](uint32_t& dst) {
+          if (dst >= nodeBegin && dst < nodeEnd) {
+            dst -= nodeBegin;
+          } else {
+            dst = numRead + (std::lower_bound(others.begin(), others.end(),
+                                              dst) -
+                             others.begin());
+          }
+        },
+        galois::no_stats());
+
+    size_t numTouched = numRead + others.size();
+    _replicas.resize(numTouched * _numHosts);
+    _degree.resize(numTouched);
+    _localLoad.resize(_numHosts);
+    _sentLoad.assign(_numHosts, 0);
+    _remoteLoad.assign(_numHosts, 0);
+  }
+
+  /**
+   * Assign the edges of read nodes [begin, end).
+   */
+  template <typename EdgeTy>
+  void streamAssign(galois::graphs::BufferedGraph<EdgeTy>& bufGraph,
+                    uint64_t begin, uint64_t end) {
+    uint64_t nodeBegin = _gid2host[_hostID].first;
+    galois::do_all(
+        galois::iterate(begin, end),
+        [&](uint64_t gSrc) {
+          uint32_t src = gSrc - nodeBegin;
+          for (auto ee = bufGraph.edgeBegin(gSrc),
+                    ee_end = bufGraph.edgeEnd(gSrc);
+               ee != ee_end; ++ee) {
+            uint32_t dst = _edgeLocalDst[*ee - _firstEdge];
+            ++_degree[src];
+            ++_degree[dst];
+            uint32_t h = pickHost(src, dst);
+            _edgeOwner[*ee - _firstEdge] = h;
+            _replicas.set((size_t)src * _numHosts + h);
+            _replicas.set((size_t)dst * _numHosts + h);
+            ++_localLoad[h];
+          }
+        },
+        galois::steal(), galois::no_stats());
+  }
+
+  //! edge load assigned since the last call
+  std::vector<uint64_t> takeLoadDelta() {
+    std::vector<uint64_t> delta(_numHosts);
+    for (uint32_t h = 0; h < _numHosts; ++h) {
+      delta[h]     = _localLoad[h] - _sentLoad[h];
+      _sentLoad[h] = _localLoad[h];
+    }
+    return delta;
+  }
+
+  void addRemoteLoad(const std::vector<uint64_t>& delta) {
+    for (uint32_t h = 0; h < _numHosts; ++h) {
+      _remoteLoad[h] += delta[h];
+    }
+  }
+
+  // masters are not streamed
+  std::vector<uint32_t> getReadMasters() {
+    return std::vector<uint32_t>();
+  }
+
+  void setReadMasters(uint32_t, const std::vector<uint32_t>&) {}
+
+  /**
+   * Free everything but the edge owners.
+   */
+  void streamFinish() {
+    std::vector<uint32_t>().swap(_edgeLocalDst);
+    _replicas = galois::DynamicBitSet();
+    std::vector<galois::CopyableAtomic<uint32_t>>().swap(_degree);
+  }
+};
+
+/**
+ * Streaming edge cut (Fennel). Each node read by this host is made a master
+ * of the host maximizing
+ *
+ *   |N(v) in h| - alpha * gamma * |h|^(gamma - 1)
+ *
+ * subject to a capacity of nu * n / k nodes, where N(v) only counts
+ * neighbors whose master is already known to this host. Node loads of other
+ * hosts are exchanged between streaming blocks; all assignments are
+ * exchanged at the end so that every host can answer getMaster. Edges go to
+ * the master of their source.
+ */
+class GenericFennel {
+  std::vector<std::pair<uint64_t, uint64_t>> _gid2host;
+  uint32_t _hostID;
+  uint32_t _numHosts;
+  double _gamma;
+  double _nu;
+  double _alpha;
+  uint64_t _capacity;
+
+  //! master of every global node; _numHosts if not known yet
+  std::vector<galois::CopyableAtomic<uint32_t>> _masters;
+  std::vector<galois::CopyableAtomic<uint64_t>> _localLoad;
+  std::vector<uint64_t> _sentLoad;
+  std::vector<uint64_t> _remoteLoad;
+
+  uint64_t load(uint32_t h) const { return _localLoad[h] + _remoteLoad[h]; }
+
+ public:
+  GenericFennel(uint32_t hostID, uint32_t numHosts) {
+    _hostID   = hostID;
+    _numHosts = numHosts;
+    _gamma    = 1.5;
+    _nu       = 1.1;
+  }
+
+  void saveGIDToHost(std::vector<std::pair<uint64_t, uint64_t>>& gid2host) {
+    _gid2host = gid2host;
+  }
+
+  uint32_t getMaster(uint32_t gid) const {
+    assert(_masters[gid] < _numHosts);
+    return _masters[gid];
+  }
+
+  uint32_t getEdgeOwner(uint32_t src, uint32_t, uint64_t, uint64_t) const {
+    return getMaster(src);
+  }
+
+  bool isVertexCut() const {
+    return false;
+  }
+
+  constexpr static bool isCartCut() {
+    return false;
+  }
+
+  // not used by this
+  bool isNotCommunicationPartner(unsigned, unsigned, WriteLocation,
+                                 ReadLocation, bool) {
+    return false;
+  }
+
+  void serializePartition(boost::archive::binary_oarchive& ar) {
+    std::vector<uint32_t> masters(_masters.begin(), _masters.end());
+    ar << masters;
+  }
+
+  void deserializePartition(boost::archive::binary_iarchive& ar) {
+    std::vector<uint32_t> masters;
+    ar >> masters;
+    _masters.assign(masters.begin(), masters.end());
+  }
+
+  bool noCommunication() {
+    return false;
+  }
+
+  constexpr static bool isStreaming() {
+    return true;
+  }
+
+  template <typename EdgeTy>
+  void streamInit(galois::graphs::BufferedGraph<EdgeTy>&,
+                  uint64_t globalEdges) {
+    uint64_t globalNodes = _gid2host[_numHosts - 1].second;
+
+    _masters.assign(globalNodes, _numHosts);
+    _localLoad.resize(_numHosts);
+    _sentLoad.assign(_numHosts, 0);
+    _remoteLoad.assign(_numHosts, 0);
+
+    // alpha = sqrt(k) * m / n^1.5 (Tsourakakis et al.)
+    _alpha = std::sqrt((double)_numHosts) * (double)globalEdges /
+             std::pow((double)globalNodes, 1.5);
+    _capacity = _nu * (double)globalNodes / _numHosts + 1;
+  }
+
+  template <typename EdgeTy>
+  void streamAssign(galois::graphs::BufferedGraph<EdgeTy>& bufGraph,
+                    uint64_t begin, uint64_t end) {
+    galois::substrate::PerThreadStorage<std::vector<uint64_t>> neighborCount;
+
+    galois::do_all(
+        galois::iterate(begin, end),
+        [&](uint64_t src) {
+          auto& count = *neighborCount.getLocal();
+          count.assign(_numHosts, 0);
+          for (auto ee = bufGraph.edgeBegin(src), ee_end = bufGraph.edgeEnd(src);
+               ee != ee_end; ++ee) {
+            uint32_t m = _masters[bufGraph.edgeDestination(*ee)];
+            if (m < _numHosts) {
+              ++count[m];
+            }
+          }
+
+          uint32_t bestHost = _numHosts;
+          double bestScore  = 0;
+          for (uint32_t h = 0; h < _numHosts; ++h) {
+            uint64_t l = load(h);
+            if (l >= _capacity) {
+              continue;
+            }
+            double score = (double)count[h] -
+                           _alpha * _gamma * std::pow((double)l, _gamma - 1);
+            if (bestHost == _numHosts || score > bestScore) {
+              bestScore = score;
+              bestHost  = h;
+            }
+          }
+          // every host is estimated full; fall back to the reading host
+          if (bestHost == _numHosts) {
+            bestHost = _hostID;
+          }
+          _masters[src] = bestHost;
+          ++_localLoad[bestHost];
+        },
+        galois::steal(), galois::no_stats());
+  }
+
+  //! node load assigned since the last call
+  std::vector<uint64_t> takeLoadDelta() {
+    std::vector<uint64_t> delta(_numHosts);
+    for (uint32_t h = 0; h < _numHosts; ++h) {
+      delta[h]     = _localLoad[h] - _sentLoad[h];
+      _sentLoad[h] = _localLoad[h];
+    }
+    return delta;
+  }
+
+  void addRemoteLoad(const std::vector<uint64_t>& delta) {
+    for (uint32_t h = 0; h < _numHosts; ++h) {
+      _remoteLoad[h] += delta[h];
+    }
+  }
+
+  //! masters assigned to the nodes read by this host
+  std::vector<uint32_t> getReadMasters() {
+    return std::vector<uint32_t>(_masters.begin() + _gid2host[_hostID].first,
+                                 _masters.begin() + _gid2host[_hostID].second);
+  }
+
+  //! save the masters assigned to the nodes read by host
+  void setReadMasters(uint32_t host, const std::vector<uint32_t>& masters) {
+    assert(masters.size() == _gid2host[host].second - _gid2host[host].first);
+    std::copy(masters.begin(), masters.end(),
+              _masters.begin() + _gid2host[host].first);
+  }
+
+  void streamFinish() {}
 };
 #endif
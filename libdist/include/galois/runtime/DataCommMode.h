@@ -38,7 +38,8 @@ enum DataCommMode {
   onlyData,
   dataSplitFirst,
   dataSplit,
-  neverOnlyData
+  neverOnlyData,
+  encodedOffsetsData //!< varint-delta offsets + (packed) data
 };
 
 //! If this is set, then always used the data mode it is set to
@@ -53,11 +54,14 @@ extern DataCommMode enforce_data_mode;
  *
  * @param num_selected number of elements to send out (subset of num_total)
  * @param num_total total number of elements that exist
+ * @param encoded_offsets_size bytes the offsets of the selected elements
+ * take when encoded; 0 if the caller cannot send encoded offsets
  *
  * @returns an appropriate DataCommMode to use for synchronization
  */
 template <typename DataType>
-DataCommMode get_data_mode(size_t num_selected, size_t num_total) {
+DataCommMode get_data_mode(size_t num_selected, size_t num_total,
+                           size_t encoded_offsets_size = 0) {
   DataCommMode data_mode = noData;
   // TODO clean up neverOnlyData path (integrate with main path in some way)
   if (enforce_data_mode == neverOnlyData) {
@@ -78,6 +82,10 @@ DataCommMode get_data_mode(size_t num_selected, size_t num_total) {
         data_mode = offsetsData;
       }
     }
+  } else if (enforce_data_mode == encodedOffsetsData &&
+             encoded_offsets_size == 0) {
+    // caller cannot encode (e.g. GPU extraction); use plain offsets
+    data_mode = (num_selected == 0) ? noData : offsetsData;
   } else if (enforce_data_mode != noData) {
     data_mode = enforce_data_mode;
   } else { // no enforced mode, so find an appropriate mode
@@ -94,17 +102,31 @@ DataCommMode get_data_mode(size_t num_selected, size_t num_total) {
                                (num_selected * sizeof(unsigned int)) +
                                sizeof(size_t) + sizeof(num_selected);
       // find the minimum size one
+      size_t minDataSize;
       if (bitsetDataSize < offsetsDataSize) {
         if (bitsetDataSize < onlyDataSize) {
-          data_mode = bitsetData;
+          data_mode   = bitsetData;
+          minDataSize = bitsetDataSize;
         } else {
-          data_mode = onlyData;
+          data_mode   = onlyData;
+          minDataSize = onlyDataSize;
         }
       } else {
         if (offsetsDataSize < onlyDataSize) {
-          data_mode = offsetsData;
+          data_mode   = offsetsData;
+          minDataSize = offsetsDataSize;
         } else {
-          data_mode = onlyData;
+          data_mode   = onlyData;
+          minDataSize = onlyDataSize;
+        }
+      }
+      // data may pack further, so this is an upper bound on encoded size
+      if (encoded_offsets_size != 0) {
+        size_t encodedDataSize = (num_selected * sizeof(DataType)) +
+                                 encoded_offsets_size + sizeof(size_t) +
+                                 sizeof(num_selected) + sizeof(bool);
+        if (encodedDataSize < minDataSize) {
+          data_mode = encodedOffsetsData;
         }
       }
     }
@@ -0,0 +1,107 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file ShmRing.h
+ *
+ * Contains ShmRing, the single-producer single-consumer byte ring used by
+ * NetworkIOShm to pass messages between hosts on the same machine.
+ */
+
+#ifndef GALOIS_RUNTIME_SHMRING_H
+#define GALOIS_RUNTIME_SHMRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace galois {
+namespace runtime {
+
+/**
+ * View of a single-producer single-consumer byte ring placed in memory that
+ * may be shared between processes. The ring does not own its memory: a
+ * region of sizeof(Header) + capacity bytes is laid out with at(), and the
+ * header is set up once with init() before either side uses it.
+ */
+struct ShmRing {
+  /**
+   * Control block of a ring. Producer and consumer counters live on
+   * separate cache lines; both count bytes and never wrap.
+   */
+  struct Header {
+    alignas(64) std::atomic<uint64_t> head; //!< bytes written by producer
+    alignas(64) std::atomic<uint64_t> tail; //!< bytes read by consumer
+  };
+
+  Header* header;
+  uint8_t* data;
+  size_t capacity; //!< power of 2
+
+  //! Ring over the index-th (Header, capacity bytes) slot of base
+  static ShmRing at(void* base, size_t index, size_t capacity) {
+    uint8_t* slot =
+        static_cast<uint8_t*>(base) + index * (sizeof(Header) + capacity);
+    return ShmRing{reinterpret_cast<Header*>(slot), slot + sizeof(Header),
+                   capacity};
+  }
+
+  //! Construct an empty header; only the owner of the memory may call this
+  void init() {
+    new (&header->head) std::atomic<uint64_t>(0);
+    new (&header->tail) std::atomic<uint64_t>(0);
+  }
+
+  /**
+   * Write up to n bytes; returns how many were written.
+   */
+  size_t write(const uint8_t* src, size_t n) {
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    uint64_t tail = header->tail.load(std::memory_order_acquire);
+    n             = std::min<size_t>(n, capacity - (head - tail));
+    size_t pos    = head & (capacity - 1);
+    size_t first  = std::min(n, capacity - pos);
+    std::memcpy(data + pos, src, first);
+    std::memcpy(data, src + first, n - first);
+    header->head.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+  /**
+   * Read up to n bytes; returns how many were read.
+   */
+  size_t read(uint8_t* dst, size_t n) {
+    uint64_t tail = header->tail.load(std::memory_order_relaxed);
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    n             = std::min<size_t>(n, head - tail);
+    size_t pos    = tail & (capacity - 1);
+    size_t first  = std::min(n, capacity - pos);
+    std::memcpy(dst, data + pos, first);
+    std::memcpy(dst + first, data, n - first);
+    header->tail.store(tail + n, std::memory_order_release);
+    return n;
+  }
+};
+
+} // namespace runtime
+} // namespace galois
+
+#endif
@@ -0,0 +1,261 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file SyncEncoding.h
+ *
+ * Contains the encoders used by the encodedOffsetsData comm mode: sorted
+ * offsets are sent as varint-encoded deltas and integral values are sent
+ * frame-of-reference encoded and bit-packed.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "galois/PODResizeableArray.h"
+
+namespace galois {
+namespace runtime {
+
+/**
+ * Returns the number of bytes the varint delta encoding of the first count
+ * (sorted) offsets takes.
+ *
+ * @param offsets sorted offsets
+ * @param count number of offsets to encode
+ */
+inline size_t
+encodedOffsetsSize(const PODResizeableArray<unsigned int>& offsets,
+                   size_t count) {
+  size_t size       = 0;
+  unsigned int prev = 0;
+  for (size_t i = 0; i < count; ++i) {
+    unsigned int delta = offsets[i] - prev;
+    prev               = offsets[i];
+    do {
+      ++size;
+      delta >>= 7;
+    } while (delta);
+  }
+  return size;
+}
+
+/**
+ * Estimates encodedOffsetsSize for count offsets spread over [0, total)
+ * without looking at them: every delta is taken to be the average gap.
+ * Used to pick a comm mode; the encoding itself uses the exact size.
+ *
+ * @param count number of offsets to encode
+ * @param total number of elements the offsets index into
+ */
+inline size_t estimateEncodedOffsetsSize(size_t count, size_t total) {
+  if (count == 0)
+    return 0;
+  size_t gap   = total / count;
+  size_t bytes = 1;
+  while (gap >>= 7)
+    ++bytes;
+  return count * bytes;
+}
+
+/**
+ * Encodes the first count (sorted) offsets as LEB128 varints of the
+ * difference to the previous offset.
+ *
+ * @param offsets sorted offsets
+ * @param count number of offsets to encode
+ * @param out OUTPUT: encoded bytes
+ */
+inline void encodeOffsets(const PODResizeableArray<unsigned int>& offsets,
+                          size_t count, PODResizeableArray<uint8_t>& out) {
+  out.resize(encodedOffsetsSize(offsets, count));
+  uint8_t* pos      = out.data();
+  unsigned int prev = 0;
+  for (size_t i = 0; i < count; ++i) {
+    unsigned int delta = offsets[i] - prev;
+    prev               = offsets[i];
+    while (delta >= 0x80) {
+      *pos++ = static_cast<uint8_t>(delta | 0x80);
+      delta >>= 7;
+    }
+    *pos++ = static_cast<uint8_t>(delta);
+  }
+}
+
+/**
+ * Decodes offsets encoded with encodeOffsets.
+ *
+ * @param in encoded bytes
+ * @param count number of offsets encoded in in
+ * @param offsets OUTPUT: decoded offsets
+ */
+inline void decodeOffsets(const PODResizeableArray<uint8_t>& in, size_t count,
+                          PODResizeableArray<unsigned int>& offsets) {
+  offsets.resize(count);
+  const uint8_t* pos = in.data();
+  unsigned int prev  = 0;
+  for (size_t i = 0; i < count; ++i) {
+    unsigned int delta = 0;
+    unsigned int shift = 0;
+    while (*pos & 0x80) {
+      delta |= static_cast<unsigned int>(*pos++ & 0x7f) << shift;
+      shift += 7;
+    }
+    delta |= static_cast<unsigned int>(*pos++) << shift;
+    prev += delta;
+    offsets[i] = prev;
+  }
+}
+
+/**
+ * Frame-of-reference encoded values: every value is stored as its
+ * difference to the minimum using bitWidth bits.
+ */
+template <typename ValTy>
+struct PackedValues {
+  ValTy base;       //!< minimum of the encoded values
+  uint8_t bitWidth; //!< bits per value; 0 if all values equal base
+  PODResizeableArray<uint64_t> words; //!< bit-packed differences
+};
+
+/**
+ * Returns true if values of type ValTy can be frame-of-reference encoded.
+ */
+template <typename ValTy>
+constexpr bool isPackable() {
+  return std::is_integral<ValTy>::value && !std::is_same<ValTy, bool>::value &&
+         sizeof(ValTy) <= sizeof(uint64_t);
+}
+
+/**
+ * Returns the number of bits needed to store value.
+ */
+inline uint8_t bitsNeeded(uint64_t value) {
+  uint8_t bits = 0;
+  while (value) {
+    ++bits;
+    value >>= 1;
+  }
+  return bits;
+}
+
+/**
+ * Frame-of-reference encodes the first count values.
+ *
+ * @param values values to encode
+ * @param count number of values to encode
+ * @param out OUTPUT: encoded values
+ * @returns false (leaving out unspecified) if packing would not save space
+ */
+template <typename ValTy, typename VecTy,
+          typename std::enable_if<isPackable<ValTy>()>::type* = nullptr>
+bool packValues(const VecTy& values, size_t count, PackedValues<ValTy>& out) {
+  using UTy = typename std::make_unsigned<ValTy>::type;
+  if (count == 0) {
+    return false;
+  }
+
+  ValTy minVal = values[0];
+  ValTy maxVal = values[0];
+  for (size_t i = 1; i < count; ++i) {
+    minVal = std::min(minVal, static_cast<ValTy>(values[i]));
+    maxVal = std::max(maxVal, static_cast<ValTy>(values[i]));
+  }
+
+  uint8_t width =
+      bitsNeeded(static_cast<UTy>(static_cast<UTy>(maxVal) -
+                                  static_cast<UTy>(minVal)));
+  if (width == sizeof(ValTy) * 8) {
+    return false;
+  }
+
+  out.base     = minVal;
+  out.bitWidth = width;
+  out.words.resize((count * width + 63) / 64);
+  std::memset(out.words.data(), 0, out.words.size() * sizeof(uint64_t));
+  size_t bit = 0;
+  for (size_t i = 0; i < count; ++i, bit += width) {
+    uint64_t diff = static_cast<UTy>(static_cast<UTy>(values[i]) -
+                                     static_cast<UTy>(minVal));
+    if (width == 0) {
+      continue;
+    }
+    out.words[bit / 64] |= diff << (bit % 64);
+    if ((bit % 64) + width > 64) {
+      out.words[bit / 64 + 1] |= diff >> (64 - (bit % 64));
+    }
+  }
+  return true;
+}
+
+/**
+ * Values that cannot be frame-of-reference encoded are always sent raw.
+ */
+template <typename ValTy, typename VecTy,
+          typename std::enable_if<!isPackable<ValTy>()>::type* = nullptr>
+bool packValues(const VecTy&, size_t, PackedValues<ValTy>&) {
+  return false;
+}
+
+/**
+ * Decodes count values encoded by packValues.
+ *
+ * @param in encoded values
+ * @param count number of values to decode
+ * @param values OUTPUT: decoded values
+ */
+template <typename ValTy, typename VecTy,
+          typename std::enable_if<isPackable<ValTy>()>::type* = nullptr>
+void unpackValues(const PackedValues<ValTy>& in, size_t count,
+                  VecTy& values) {
+  using UTy = typename std::make_unsigned<ValTy>::type;
+  values.resize(count);
+  uint8_t width = in.bitWidth;
+  uint64_t mask = (width == 64) ? ~uint64_t(0) : ((uint64_t(1) << width) - 1);
+  size_t bit    = 0;
+  for (size_t i = 0; i < count; ++i, bit += width) {
+    uint64_t diff = 0;
+    if (width) {
+      diff = in.words[bit / 64] >> (bit % 64);
+      if ((bit % 64) + width > 64) {
+        diff |= in.words[bit / 64 + 1] << (64 - (bit % 64));
+      }
+      diff &= mask;
+    }
+    values[i] = static_cast<ValTy>(
+        static_cast<UTy>(static_cast<UTy>(in.base) + static_cast<UTy>(diff)));
+  }
+}
+
+/**
+ * Values that cannot be frame-of-reference encoded are never packed.
+ */
+template <typename ValTy, typename VecTy,
+          typename std::enable_if<!isPackable<ValTy>()>::type* = nullptr>
+void unpackValues(const PackedValues<ValTy>&, size_t, VecTy&) {
+  assert(false && "unpacking values that cannot be packed");
+}
+
+} // namespace runtime
+} // namespace galois
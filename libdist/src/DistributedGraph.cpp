@@ -51,6 +51,9 @@ cll::opt<DataCommMode> enforce_metadata(
                 clEnumValN(offsetsData, "offsets",
                            "Use offsets metadata always"),
                 clEnumValN(gidsData, "gids", "Use global IDs metadata always"),
+                clEnumValN(encodedOffsetsData, "encoded",
+                           "Use delta-encoded offsets metadata (and "
+                           "bit-packed data) always"),
                 clEnumValN(onlyData, "none",
                            "Do not use any metadata (sends "
                            "non-updated values)"),
@@ -120,3 +123,11 @@ cll::opt<unsigned>
                              cll::desc("Buffer size for batching edges to "
                                        "send during partitioning."),
                              cll::init(32000), cll::Hidden);
+
+//! Command line definition for streamSyncRounds
+cll::opt<unsigned>
+    streamSyncRounds("streamSyncRounds",
+                     cll::desc("Number of blocks the read nodes are split "
+                               "into by streaming partitioners; partition "
+                               "loads are exchanged after each block"),
+                     cll::init(16), cll::Hidden);
@@ -25,6 +25,9 @@
  */
 
 #include <galois/graphs/DistributedGraphLoader.h>
+#include <galois/DReducible.h>
+
+#include <sys/stat.h>
 
 using namespace galois::graphs;
 
@@ -64,6 +67,8 @@ cll::opt<PARTITIONING_SCHEME> partitionScheme(
         clEnumValN(GCVC, "gcvc", "CVC (oec) using generic interface"),
         clEnumValN(GHIVC, "ghivc", "HIVC using generic interface"),
         clEnumValN(GOEC, "goec", "oec generic interface"),
+        clEnumValN(GHDRF, "ghdrf", "Streaming HDRF vertex-cut"),
+        clEnumValN(GFENNEL, "gfennel", "Streaming Fennel edge-cut"),
         clEnumValEnd),
     cll::init(OEC));
 cll::opt<unsigned int>
@@ -94,3 +99,195 @@ cll::opt<std::string>
 cll::opt<bool> saveLocalGraph("saveLocalGraph",
                               cll::desc("Set to save the local CSR graph"),
                               cll::init(false), cll::Hidden);
+
+cll::opt<std::string>
+    partitionCacheDir("partitionCache",
+                      cll::desc("Directory in which to cache partitioned "
+                                "local graphs; later runs with the same "
+                                "input, hosts, and partitioning options "
+                                "read the cache instead of partitioning"),
+                      cll::init(""));
+
+/*******************************************************************************
+ * Partition cache
+ ******************************************************************************/
+
+namespace {
+
+//! bumped whenever the layout of a saved local graph or the key changes
+constexpr uint32_t partitionCacheVersion = 2;
+//! identifies partition cache meta files
+constexpr char partitionCacheMagic[] = "GALOISPC";
+//! bytes at the start of an input file that are hashed into the key
+constexpr size_t partitionCacheSampleBytes = 1 << 20;
+
+//! FNV-1a over a byte range
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+template <typename T>
+uint64_t hashValue(uint64_t hash, const T& value) {
+  return hashBytes(hash, &value, sizeof(T));
+}
+
+/**
+ * Hashes an input file by size, modification time, and leading bytes.
+ * Hashing the whole file would cost as much as partitioning it.
+ */
+uint64_t hashInputFile(uint64_t hash, const std::string& fileName) {
+  hash = hashBytes(hash, fileName.data(), fileName.size());
+  if (fileName.empty()) {
+    return hash;
+  }
+
+  struct stat fileStat;
+  if (stat(fileName.c_str(), &fileStat) != 0) {
+    GALOIS_SYS_DIE("stat failed on ", fileName);
+  }
+  hash = hashValue(hash, static_cast<uint64_t>(fileStat.st_size));
+  hash = hashValue(hash, static_cast<int64_t>(fileStat.st_mtime));
+
+  std::ifstream input(fileName, std::ios::binary);
+  std::vector<char> sample(partitionCacheSampleBytes);
+  input.read(sample.data(), sample.size());
+  return hashBytes(hash, sample.data(), input.gcount());
+}
+
+//! Returns true if the scheme's constructor can read a saved local graph
+bool supportsLocalGraphFile(PARTITIONING_SCHEME scheme) {
+  switch (scheme) {
+  case BOARD2D_VCUT:
+  case JAGGED_CYCLIC_VCUT:
+  case JAGGED_BLOCKED_VCUT:
+  case OVER_DECOMPOSE_2_VCUT:
+  case OVER_DECOMPOSE_4_VCUT:
+  case CEC:
+    return false;
+  default:
+    return true;
+  }
+}
+
+//! Meta file of this host's part of a cache entry
+std::string partitionCacheMetaFile(const std::string& prefix) {
+  return prefix + "_" +
+         std::to_string(galois::runtime::getSystemNetworkInterface().ID) +
+         ".meta";
+}
+
+//! Returns true if this host's meta file exists and records key
+bool validPartitionCacheEntry(const std::string& prefix, uint64_t key) {
+  std::ifstream meta(partitionCacheMetaFile(prefix), std::ios::binary);
+  if (!meta.is_open()) {
+    return false;
+  }
+
+  char magic[sizeof(partitionCacheMagic)];
+  uint32_t version = 0;
+  uint64_t savedKey = 0;
+  meta.read(magic, sizeof(magic));
+  meta.read(reinterpret_cast<char*>(&version), sizeof(version));
+  meta.read(reinterpret_cast<char*>(&savedKey), sizeof(savedKey));
+
+  return meta.good() &&
+         std::equal(magic, magic + sizeof(magic), partitionCacheMagic) &&
+         version == partitionCacheVersion && savedKey == key;
+}
+
+} // end anonymous namespace
+
+namespace galois {
+namespace graphs {
+
+PartitionCache openPartitionCache(const std::string& variant,
+                                  const std::vector<unsigned>& scaleFactor) {
+  if (partitionCacheDir.empty() || readFromFile) {
+    return PartitionCache();
+  }
+
+  auto& net = galois::runtime::getSystemNetworkInterface();
+  // single host runs always use the plain edge cut
+  if (net.Num > 1 && !supportsLocalGraphFile(partitionScheme)) {
+    if (net.ID == 0) {
+      galois::gWarn("partition scheme ", EnumToString(partitionScheme),
+                    " cannot be read back from disk; not using the "
+                    "partition cache");
+    }
+    return PartitionCache();
+  }
+
+  uint64_t key = 14695981039346656037ull;
+  key = hashValue(key, partitionCacheVersion);
+  key = hashInputFile(key, inputFile);
+  key = hashInputFile(key, inputFileTranspose);
+  key = hashValue(key, net.Num);
+  key = hashValue(key, static_cast<uint32_t>(partitionScheme));
+  key = hashValue(key, static_cast<unsigned>(VCutThreshold));
+  // options that change where masters and edges go
+  key = hashValue(key, static_cast<uint32_t>(masters_distribution));
+  key = hashValue(key, static_cast<uint32_t>(nodeWeightOfMaster));
+  key = hashValue(key, static_cast<uint32_t>(edgeWeightOfMaster));
+  key = hashValue(key, static_cast<unsigned>(streamSyncRounds));
+  key = hashInputFile(key, vertexIDMapFileName);
+  key = hashBytes(key, variant.data(), variant.size());
+  if (!scaleFactor.empty()) {
+    key = hashBytes(key, scaleFactor.data(),
+                    scaleFactor.size() * sizeof(unsigned));
+  }
+
+  std::string baseName = inputFile;
+  size_t slash = baseName.find_last_of('/');
+  if (slash != std::string::npos) {
+    baseName = baseName.substr(slash + 1);
+  }
+
+  char keyString[17];
+  snprintf(keyString, sizeof(keyString), "%016lx",
+           static_cast<unsigned long>(key));
+  std::string prefix = partitionCacheDir + "/" + baseName + "_" +
+                       EnumToString(partitionScheme) + "_" +
+                       std::to_string(net.Num) + "_" + keyString;
+
+  // every host has to agree: one host reading from the cache while another
+  // partitions would deadlock construction
+  galois::DGAccumulator<unsigned> misses;
+  misses.reset();
+  if (!validPartitionCacheEntry(prefix, key)) {
+    misses += 1;
+  }
+  bool hit = (misses.reduce() == 0);
+  if (!hit) {
+    // this host's part gets rewritten; drop its meta file first so a crash
+    // during the rewrite cannot leave a valid-looking entry behind
+    std::remove(partitionCacheMetaFile(prefix).c_str());
+  }
+
+  if (net.ID == 0) {
+    galois::gPrint("Partition cache ", hit ? "hit" : "miss", " (", keyString,
+                   ")\n");
+  }
+  galois::runtime::reportParam("dGraph", "PartitionCacheHit", hit);
+
+  return PartitionCache(prefix, key, hit);
+}
+
+void commitPartitionCache(const std::string& prefix, uint64_t key) {
+  std::string metaFile = partitionCacheMetaFile(prefix);
+  std::ofstream meta(metaFile, std::ios::binary | std::ios::trunc);
+  uint32_t version = partitionCacheVersion;
+  meta.write(partitionCacheMagic, sizeof(partitionCacheMagic));
+  meta.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  meta.write(reinterpret_cast<const char*>(&key), sizeof(key));
+  if (!meta.good()) {
+    galois::gWarn("could not write partition cache entry ", metaFile);
+  }
+}
+
+} // end namespace graphs
+} // end namespace galois
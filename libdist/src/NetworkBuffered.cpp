@@ -29,6 +29,7 @@
 #include "galois/runtime/Network.h"
 #include "galois/runtime/NetworkIO.h"
 #include "galois/runtime/Tracer.h"
+#include "galois/substrate/EnvCheck.h"
 
 #ifdef GALOIS_USE_LWCI
 #define NO_AGG
@@ -392,7 +393,13 @@ class NetworkInterfaceBuffered : public NetworkInterface {
     }
 
     galois::gDebug("[", NetworkInterface::ID, "] MPI initialized");
-    std::tie(netio, ID, Num) = makeNetworkIOMPI(memUsageTracker, inflightSends, inflightRecvs);
+    if (galois::substrate::EnvCheck("GALOIS_SHM_COMM")) {
+      std::tie(netio, ID, Num) = makeNetworkIOShm(memUsageTracker, inflightSends, inflightRecvs);
+      if (ID == 0)
+        fprintf(stderr, "**Using shared memory + MPI Communication layer**\n");
+    } else {
+      std::tie(netio, ID, Num) = makeNetworkIOMPI(memUsageTracker, inflightSends, inflightRecvs);
+    }
 #endif
 
     assert(ID == (unsigned)rank);
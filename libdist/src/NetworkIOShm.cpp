@@ -0,0 +1,319 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file NetworkIOShm.cpp
+ *
+ * Contains an implementation of network IO that uses shared memory ring
+ * buffers for hosts on the same machine and MPI for everything else.
+ */
+
+#include "galois/runtime/NetworkIO.h"
+#include "galois/runtime/ShmRing.h"
+#include "galois/runtime/Tracer.h"
+#include "galois/substrate/EnvCheck.h"
+#include "galois/gIO.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Shared memory implementation of network IO. Hosts that share a machine
+ * (as reported by MPI_Comm_split_type) talk through single-producer
+ * single-consumer byte rings in POSIX shared memory; all other messages go
+ * through an MPI network IO layer. ASSUMES THAT MPI IS INITIALIZED UPON
+ * CREATION OF THIS OBJECT.
+ *
+ * Every host owns one shared memory segment holding one ring per local
+ * sender. A message is streamed through its ring as an 8 byte header (tag,
+ * length) followed by the payload, so messages larger than the ring are
+ * fine: the sender writes as much as fits on each progress call and the
+ * receiver reassembles the message before handing it up.
+ */
+class NetworkIOShm : public galois::runtime::NetworkIO {
+private:
+  //! Default ring size in bytes; can be changed with GALOIS_SHM_RING_MB
+  static constexpr size_t defaultRingBytes = 4 << 20;
+
+  using Ring = galois::runtime::ShmRing;
+
+  //! Bytes in the header (tag, length) that precedes every message in a
+  //! ring; the length is 64 bits so messages of 4 GB and more are framed
+  //! correctly
+  static constexpr size_t frameBytes = 2 * sizeof(uint64_t);
+
+  /**
+   * Outgoing messages to one local host.
+   */
+  struct sendQueueTy {
+    Ring ring;
+    std::deque<message> pending;
+    //! bytes of the front message (header included) already written
+    size_t offset = 0;
+
+    /**
+     * Write as much of the pending messages as the ring has room for.
+     *
+     * @returns number of messages completely written
+     */
+    size_t push(galois::runtime::MemUsageTracker& tracker) {
+      size_t completed = 0;
+      while (!pending.empty()) {
+        auto& m = pending.front();
+        if (offset < frameBytes) {
+          uint64_t frame[2] = {m.tag, m.data.size()};
+          offset += ring.write(reinterpret_cast<uint8_t*>(frame) + offset,
+                               frameBytes - offset);
+          if (offset < frameBytes)
+            break;
+        }
+        size_t sent = offset - frameBytes;
+        offset += ring.write(m.data.data() + sent, m.data.size() - sent);
+        if (offset - frameBytes < m.data.size())
+          break;
+        tracker.decrementMemUsage(m.data.size());
+        pending.pop_front();
+        offset = 0;
+        ++completed;
+      }
+      return completed;
+    }
+  };
+
+  /**
+   * Incoming messages from one local host.
+   */
+  struct recvQueueTy {
+    Ring ring;
+    uint32_t host;
+    uint64_t frame[2];
+    //! bytes of the current message (header included) already read
+    size_t offset = 0;
+    vTy data;
+
+    /**
+     * Read as much as is available; completed messages go to done.
+     */
+    void pull(std::deque<message>& done,
+              galois::runtime::MemUsageTracker& tracker,
+              std::atomic<size_t>& inflightRecvs) {
+      while (true) {
+        if (offset < frameBytes) {
+          offset += ring.read(reinterpret_cast<uint8_t*>(frame) + offset,
+                              frameBytes - offset);
+          if (offset < frameBytes)
+            return;
+          ++inflightRecvs;
+          data.resize(frame[1]);
+          tracker.incrementMemUsage(frame[1]);
+        }
+        size_t received = offset - frameBytes;
+        offset += ring.read(data.data() + received, data.size() - received);
+        if (offset - frameBytes < data.size())
+          return;
+        uint32_t tag = static_cast<uint32_t>(frame[0]);
+        galois::runtime::trace("SHM RECV", host, tag, data.size());
+        done.emplace_back(host, tag, std::move(data));
+        data   = vTy();
+        offset = 0;
+      }
+    }
+  };
+
+  //! remote (MPI) network IO layer
+  std::unique_ptr<galois::runtime::NetworkIO> remote;
+  //! global host id -> index into sendQueues; only has local hosts
+  std::unordered_map<uint32_t, size_t> localIndex;
+  std::vector<sendQueueTy> sendQueues;
+  std::vector<recvQueueTy> recvQueues;
+  std::deque<message> done;
+  //! mapped segments (address, length) to unmap on destruction
+  std::vector<std::pair<void*, size_t>> segments;
+
+  static std::string segmentName(const std::string& job, int host) {
+    return "/galois_" + job + "_" + std::to_string(host);
+  }
+
+  static void* mapSegment(const std::string& name, size_t length,
+                          bool create) {
+    int flags = create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR;
+    int fd    = shm_open(name.c_str(), flags, S_IRUSR | S_IWUSR);
+    if (fd == -1 && create && errno == EEXIST) {
+      // stale segment left behind by a crashed run with the same name
+      shm_unlink(name.c_str());
+      fd = shm_open(name.c_str(), flags, S_IRUSR | S_IWUSR);
+    }
+    if (fd == -1) {
+      GALOIS_SYS_DIE("shm_open failed on ", name);
+    }
+    if (create && ftruncate(fd, length) != 0) {
+      GALOIS_SYS_DIE("ftruncate failed on ", name);
+    }
+    void* addr =
+        mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      GALOIS_SYS_DIE("mmap failed on ", name);
+    }
+    return addr;
+  }
+
+public:
+  /**
+   * Constructor.
+   *
+   * @param tracker memory usage tracker
+   * @param sends number of inflight sends
+   * @param recvs number of inflight receives
+   * @param [out] ID this machine's host id
+   * @param [out] NUM total number of hosts in the system
+   */
+  NetworkIOShm(galois::runtime::MemUsageTracker& tracker,
+               std::atomic<size_t>& sends, std::atomic<size_t>& recvs,
+               uint32_t& ID, uint32_t& NUM)
+      : NetworkIO(tracker, sends, recvs) {
+    std::tie(remote, ID, NUM) =
+        galois::runtime::makeNetworkIOMPI(tracker, sends, recvs);
+
+    MPI_Comm nodeComm;
+    handleError(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, ID,
+                                    MPI_INFO_NULL, &nodeComm));
+    int localID, localNum;
+    handleError(MPI_Comm_rank(nodeComm, &localID));
+    handleError(MPI_Comm_size(nodeComm, &localNum));
+
+    std::vector<int> localHosts(localNum);
+    int myID = ID;
+    handleError(MPI_Allgather(&myID, 1, MPI_INT, localHosts.data(), 1,
+                              MPI_INT, nodeComm));
+
+    int ringMB = 0;
+    size_t ringBytes = defaultRingBytes;
+    if (galois::substrate::EnvCheck("GALOIS_SHM_RING_MB", ringMB) &&
+        ringMB > 0) {
+      ringBytes = size_t(1) << 20;
+      while (ringBytes < (size_t(ringMB) << 20))
+        ringBytes <<= 1;
+    }
+    size_t segmentBytes = localNum * (sizeof(Ring::Header) + ringBytes);
+
+    // segment names have to be unique per job; use the pid of the first
+    // local host
+    long job = getpid();
+    handleError(MPI_Bcast(&job, 1, MPI_LONG, 0, nodeComm));
+    std::string jobName = std::to_string(job);
+
+    // create own (incoming) segment, then map everyone else's
+    void* mine = mapSegment(segmentName(jobName, ID), segmentBytes, true);
+    for (int i = 0; i < localNum; ++i) {
+      Ring::at(mine, i, ringBytes).init();
+    }
+    handleError(MPI_Barrier(nodeComm));
+
+    // queues hold move-only messages, so construct them in place
+    sendQueues = decltype(sendQueues)(localNum);
+    recvQueues = decltype(recvQueues)(localNum);
+    for (int i = 0; i < localNum; ++i) {
+      uint32_t host = localHosts[i];
+      void* theirs =
+          (host == ID) ? mine
+                       : mapSegment(segmentName(jobName, host), segmentBytes,
+                                    false);
+      if (host != ID)
+        segments.emplace_back(theirs, segmentBytes);
+      localIndex[host]   = i;
+      sendQueues[i].ring = Ring::at(theirs, localID, ringBytes);
+      recvQueues[i].ring = Ring::at(mine, i, ringBytes);
+      recvQueues[i].host = host;
+    }
+    segments.emplace_back(mine, segmentBytes);
+
+    // everyone has mapped everything; names are no longer needed
+    handleError(MPI_Barrier(nodeComm));
+    shm_unlink(segmentName(jobName, ID).c_str());
+    handleError(MPI_Comm_free(&nodeComm));
+
+    galois::gDebug("[", ID, "] shared memory IO with ", localNum,
+                   " local hosts, ", ringBytes, " byte rings");
+  }
+
+  virtual ~NetworkIOShm() {
+    for (auto& s : segments) {
+      munmap(s.first, s.second);
+    }
+  }
+
+  /**
+   * Adds a message to the send queue of its host; remote hosts go to MPI
+   */
+  virtual void enqueue(message m) {
+    auto local = localIndex.find(m.host);
+    if (local == localIndex.end()) {
+      remote->enqueue(std::move(m));
+      return;
+    }
+    memUsageTracker.incrementMemUsage(m.data.size());
+    galois::runtime::trace("SHM SEND", m.host, m.tag, m.data.size());
+    auto& sq = sendQueues[local->second];
+    sq.pending.emplace_back(std::move(m));
+    inflightSends -= sq.push(memUsageTracker);
+  }
+
+  /**
+   * Attempts to get a message from the local hosts, then from MPI.
+   */
+  virtual message dequeue() {
+    if (!done.empty()) {
+      auto msg = std::move(done.front());
+      done.pop_front();
+      return msg;
+    }
+    return remote->dequeue();
+  }
+
+  /**
+   * Push progress forward in the system.
+   */
+  virtual void progress() {
+    remote->progress();
+    for (auto& sq : sendQueues) {
+      if (!sq.pending.empty()) {
+        inflightSends -= sq.push(memUsageTracker);
+      }
+    }
+    for (auto& rq : recvQueues) {
+      rq.pull(done, memUsageTracker, inflightRecvs);
+    }
+  }
+}; // end NetworkIOShm class
+
+std::tuple<std::unique_ptr<galois::runtime::NetworkIO>, uint32_t, uint32_t>
+galois::runtime::makeNetworkIOShm(galois::runtime::MemUsageTracker& tracker,
+                                  std::atomic<size_t>& sends,
+                                  std::atomic<size_t>& recvs) {
+  uint32_t ID, NUM;
+  std::unique_ptr<galois::runtime::NetworkIO> n{
+      new NetworkIOShm(tracker, sends, recvs, ID, NUM)};
+  return std::make_tuple(std::move(n), ID, NUM);
+}
@@ -29,12 +29,25 @@
 #include <boost/iterator/iterator_facade.hpp>
 #include <stdexcept>
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
 
 namespace galois {
 
 /**
  * Unordered collection of elements. This data structure supports scalable
  * concurrent pushes but reading the bag can only be done serially.
+ *
+ * Each thread appends to its own list of pages, which come from that
+ * thread's page pool (or FixedSizeHeap) and are first touched by it, so they
+ * are local to its NUMA node. Parallel loops over a bag (e.g.,
+ * do_all(iterate(bag))) start every thread on the pages it pushed; with
+ * galois::steal(), idle threads then take work from threads in the same
+ * socket before threads in other sockets. Iterators count and skip whole
+ * pages at a time, so splitting the remaining work of a thread costs
+ * O(pages) rather than O(elements).
  */
 template <typename T, unsigned int BlockSize = 0>
 class InsertBag {
@@ -97,6 +110,12 @@ public:
       advance_thread();
     }
 
+    void skip_chunk() {
+      if (advance_chunk())
+        return;
+      advance_thread();
+    }
+
     template <typename OtherTy>
     bool equal(const Iterator<OtherTy>& o) const {
       return hd == o.hd && thr == o.thr && p == o.p && v == o.v;
@@ -119,6 +138,36 @@ public:
       if (!init_thread())
         advance_thread();
     }
+
+    // distance and advance are found through ADL (see DoAllStealingExec) and
+    // walk the pages instead of the elements
+
+    //! Number of elements in [b, e); e must be reachable from b
+    friend std::ptrdiff_t distance(Iterator b, const Iterator& e) {
+      std::ptrdiff_t n = 0;
+      while (!b.equal(e)) {
+        if (b.p == e.p) {
+          return n + (e.v - b.v);
+        }
+        n += b.p->dend - b.v;
+        b.skip_chunk();
+      }
+      return n;
+    }
+
+    //! Moves it forward by n >= 0 elements
+    friend void advance(Iterator& it, std::ptrdiff_t n) {
+      assert(n >= 0);
+      while (n > 0 && it.p) {
+        std::ptrdiff_t rest = it.p->dend - it.v;
+        if (n < rest) {
+          it.v += n;
+          return;
+        }
+        n -= rest;
+        it.skip_chunk();
+      }
+    }
   };
 
 private:
@@ -296,6 +345,32 @@ public:
   reference push_back(ItemTy&& val) {
     return emplace(std::forward<ItemTy>(val));
   }
+
+  /**
+   * Thread safe bulk insertion of [b, e). Fills the pages of this thread a
+   * block at a time with std::uninitialized_copy, which becomes a memcpy for
+   * trivially copyable types, instead of checking for space per element.
+   *
+   * @param b start of range; must be at least a forward iterator
+   * @param e end of range
+   */
+  template <typename Iter>
+  void push_range(Iter b, Iter e) {
+    std::ptrdiff_t n = std::distance(b, e);
+    header* H        = heads.getLocal()->second;
+    while (n > 0) {
+      if (!H || H->dend == H->dlast) {
+        H = newHeader();
+        insHeader(H);
+      }
+      std::ptrdiff_t k = std::min<std::ptrdiff_t>(n, H->dlast - H->dend);
+      Iter m           = b;
+      std::advance(m, k);
+      H->dend = std::uninitialized_copy(b, m, H->dend);
+      b       = m;
+      n -= k;
+    }
+  }
 };
 
 } // namespace galois
@@ -39,6 +39,10 @@ class SharedMemSys : public runtime::SharedMemRuntime<runtime::StatManager> {
 public:
   explicit SharedMemSys(void);
 
+  //! Backs memory with pages according to policy, overriding
+  //! GALOIS_PAGE_POLICY
+  explicit SharedMemSys(substrate::PagePolicy policy);
+
   ~SharedMemSys(void);
 };
 
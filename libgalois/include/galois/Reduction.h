@@ -23,10 +23,47 @@
 #include "galois/gstl.h"
 #include "galois/substrate/PerThreadStorage.h"
 
+#include <algorithm>
 #include <limits>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace galois {
 
+namespace internal {
+
+/**
+ * Runs fn(leader) on the leader of each socket, in parallel through the
+ * thread pool. The threads of the socket are given by
+ * ThreadPool::getSocketThreads. Only valid outside parallel regions.
+ */
+template <typename F>
+void onSocketLeaders(unsigned numThreads, const F& fn) {
+  auto& tp        = substrate::getThreadPool();
+  unsigned usable = std::min(numThreads, tp.getMaxUsableThreads());
+  tp.run(usable, [&]() {
+    if (substrate::ThreadPool::isLeader())
+      fn(substrate::ThreadPool::getTID());
+  });
+  // sockets whose leader is reserved are handled by the caller
+  for (unsigned leader = usable; leader < numThreads; ++leader)
+    if (tp.isLeader(leader))
+      fn(leader);
+}
+
+/**
+ * Makes hierarchical reductions take the per socket path even on a single
+ * socket, where they otherwise fall back to the flat reduction. For testing.
+ */
+inline bool& forceHierarchicalReduce() {
+  static bool force = false;
+  return force;
+}
+
+} // end namespace internal
+
 /**
  * GSimpleReducible stores per thread values of a variable of type T, suitable
  * for small, cheap to copy, plain T types, where T is not a container, is small
@@ -103,6 +140,52 @@ public:
     return res;
   }
 
+  /**
+   * Returns the final reduction value and resets the per thread values in the
+   * same pass. Only valid outside the parallel region.
+   */
+  T reduceAndReset() {
+    T res = m_identity;
+    for (unsigned int i = 0; i < m_data.size(); ++i) {
+      T& d = *m_data.getRemote(i);
+      res  = m_func(res, d);
+      d    = m_identity;
+    }
+    return res;
+  }
+
+  /**
+   * Returns the final reduction value. The values of each socket are first
+   * combined by the socket leader, all sockets in parallel, and then the per
+   * socket results by the calling thread, so only a few remote lines cross
+   * sockets. Resets the per thread values if reset is true. Only valid
+   * outside the parallel region.
+   */
+  T reduceHierarchical(bool reset = false) {
+    auto& tp            = substrate::getThreadPool();
+    unsigned numSockets = tp.getMaxSockets();
+    if (numSockets == 1 && !internal::forceHierarchicalReduce())
+      return reset ? reduceAndReset() : reduce();
+
+    // sockets without a leader callback contribute the identity
+    std::vector<T> partial(numSockets, m_identity);
+    internal::onSocketLeaders(m_data.size(), [&](unsigned leader) {
+      T res = m_identity;
+      for (unsigned i : tp.getSocketThreads(tp.getSocket(leader))) {
+        T& d = *m_data.getRemote(i);
+        res  = m_func(res, d);
+        if (reset)
+          d = m_identity;
+      }
+      partial[tp.getSocket(leader)] = res;
+    });
+
+    T res = m_identity;
+    for (unsigned s = 0; s < numSockets; ++s)
+      res = m_func(res, partial[s]);
+    return res;
+  }
+
   /**
    * reset value
    */
@@ -197,6 +280,138 @@ public:
   GReduceLogicalOR(void) : base_type(std::logical_or<bool>(), false) {}
 };
 
+/**
+ * One field of a GReduceTuple: the reduction operator, conforming to
+ * T operator()(const T& lhs, const T& rhs), and its identity
+ */
+template <typename BinFunc, typename T>
+struct ReduceField {
+  using value_type = T;
+
+  BinFunc func;
+  T identity;
+
+  explicit ReduceField(const BinFunc& f = BinFunc(), const T& id = T())
+      : func(f), identity(id) {}
+};
+
+//! Field of a GReduceTuple reduced by sum
+template <typename T>
+struct ReduceSum : public ReduceField<std::plus<T>, T> {};
+
+//! Field of a GReduceTuple reduced by max
+template <typename T>
+struct ReduceMax : public ReduceField<gmax<T>, T> {
+  ReduceMax()
+      : ReduceField<gmax<T>, T>(gmax<T>(), std::numeric_limits<T>::lowest()) {}
+};
+
+//! Field of a GReduceTuple reduced by min
+template <typename T>
+struct ReduceMin : public ReduceField<gmin<T>, T> {
+  ReduceMin()
+      : ReduceField<gmin<T>, T>(gmin<T>(), std::numeric_limits<T>::max()) {}
+};
+
+/**
+ * GReduceTuple reduces several small values, each with its own operator, in
+ * one sweep over the threads. The fields of a thread share its per thread
+ * slot, so reducing k values costs one pass instead of the k passes of k
+ * separate reducibles.
+ *
+ * Fields are described by ReduceField (or ReduceSum, ReduceMax, ReduceMin):
+ *
+ *  GReduceTuple<ReduceSum<size_t>, ReduceMax<double>> r;
+ *  r.update<0>(1);
+ *  r.update<1>(delta);
+ *  std::tie(work, maxDelta) = r.reduceAndReset();
+ */
+template <typename... Fields>
+class GReduceTuple {
+  static_assert(sizeof...(Fields) > 0, "GReduceTuple needs a field");
+
+public:
+  using value_type = std::tuple<typename Fields::value_type...>;
+
+protected:
+  using Indices = std::index_sequence_for<Fields...>;
+
+  std::tuple<Fields...> m_fields;
+  galois::substrate::PerThreadStorage<value_type> m_data;
+
+  template <size_t... Is>
+  value_type identity(std::index_sequence<Is...>) const {
+    return value_type(std::get<Is>(m_fields).identity...);
+  }
+
+  template <size_t... Is>
+  void combine(value_type& lhs, const value_type& rhs,
+               std::index_sequence<Is...>) const {
+    int expand[] = {(std::get<Is>(lhs) = std::get<Is>(m_fields).func(
+                         std::get<Is>(lhs), std::get<Is>(rhs)),
+                     0)...};
+    (void)expand;
+  }
+
+public:
+  GReduceTuple() { reset(); }
+
+  explicit GReduceTuple(const Fields&... fields) : m_fields(fields...) {
+    reset();
+  }
+
+  /**
+   * Updates field I of the thread local value by applying the field's
+   * reduction operator to its current and newly provided value
+   */
+  template <size_t I, typename T2>
+  void update(const T2& rhs) {
+    auto& lhs = std::get<I>(*m_data.getLocal());
+    lhs       = std::get<I>(m_fields).func(lhs, rhs);
+  }
+
+  /**
+   * Returns the final values of all fields. Only valid outside the parallel
+   * region.
+   */
+  value_type reduce() const {
+    value_type res = identity(Indices());
+    for (unsigned i = 0; i < m_data.size(); ++i)
+      combine(res, *m_data.getRemote(i), Indices());
+    return res;
+  }
+
+  /**
+   * Returns the final values of all fields and resets the per thread values
+   * in the same pass. Only valid outside the parallel region.
+   */
+  value_type reduceAndReset() {
+    const value_type id = identity(Indices());
+    value_type res      = id;
+    for (unsigned i = 0; i < m_data.size(); ++i) {
+      value_type& d = *m_data.getRemote(i);
+      combine(res, d, Indices());
+      d = id;
+    }
+    return res;
+  }
+
+  /**
+   * reset value
+   */
+  void reset() {
+    const value_type id = identity(Indices());
+    for (unsigned i = 0; i < m_data.size(); ++i)
+      *m_data.getRemote(i) = id;
+  }
+
+  //! @return the current local value of field I for this thread
+  template <size_t I>
+  typename std::tuple_element<I, value_type>::type peekLocal() const {
+    return std::get<I>(*m_data.getLocal());
+  }
+};
+
 /**
  * GBigReducible stores per thread values of a variable of type T. Suitable
  * for large objects, objects that are not trivially copyable or are inefficient
@@ -273,6 +488,52 @@ public:
     return d0;
   }
 
+  /**
+   * Returns the final reduction value, moving it out so that all per thread
+   * values are left at the identity. Only valid outside the parallel region.
+   */
+  T reduceAndReset() {
+    T res = std::move(reduce());
+    *m_data.getLocal() = m_identity;
+    return res;
+  }
+
+  /**
+   * Returns the final reduction value. The values of each socket are first
+   * combined into the socket leader's value, all sockets in parallel, and
+   * then the leaders' values into the calling thread's. Like reduce(), leaves
+   * the other values at the identity. Only valid outside the parallel region.
+   */
+  T& reduceHierarchical() {
+    auto& tp = substrate::getThreadPool();
+    if (tp.getMaxSockets() == 1 && !internal::forceHierarchicalReduce())
+      return reduce();
+
+    internal::onSocketLeaders(m_data.size(), [this, &tp](unsigned leader) {
+      T& dl = *m_data.getRemote(leader);
+      for (unsigned i : tp.getSocketThreads(tp.getSocket(leader))) {
+        if (i == leader)
+          continue;
+        T& d = *m_data.getRemote(i);
+        m_func(dl, d);
+        d = m_identity;
+      }
+    });
+
+    T& d0 = *m_data.getLocal();
+    unsigned self = substrate::ThreadPool::getTID();
+    for (unsigned s = 0; s < tp.getMaxSockets(); ++s) {
+      auto& threads = tp.getSocketThreads(s);
+      if (threads.empty() || threads.front() == self)
+        continue;
+      unsigned leader = threads.front();
+      T& d = *m_data.getRemote(leader);
+      m_func(d0, d);
+      d = m_identity;
+    }
+    return d0;
+  }
+
   /**
    * reset value
    */
@@ -24,6 +24,7 @@
 #include "galois/graphs/Details.h"
 #include "galois/graphs/FileGraph.h"
 #include "galois/graphs/GraphHelpers.h"
+#include "galois/substrate/CompilerSpecific.h"
 
 #include <type_traits>
 
@@ -157,6 +158,37 @@ public:
   typedef iterator local_iterator;
   typedef iterator const_local_iterator;
 
+  /**
+   * Edge iterator that, when incremented, prefetches the node data of the
+   * destination a fixed number of edges ahead. Dereferences to an
+   * edge_iterator like the iterators of edges().
+   */
+  class prefetch_edge_iterator
+      : public boost::iterator_adaptor<prefetch_edge_iterator, edge_iterator,
+                                       edge_iterator, boost::use_default,
+                                       const edge_iterator&> {
+    friend class boost::iterator_core_access;
+
+    LC_CSR_Graph* graph;
+    uint64_t stop;
+    unsigned distance;
+
+    const edge_iterator& dereference() const { return this->base_reference(); }
+
+    void increment() {
+      uint64_t ahead = *++this->base_reference() + distance;
+      if (ahead < stop)
+        graph->prefetchData(graph->edgeDst[ahead]);
+    }
+
+  public:
+    prefetch_edge_iterator() : graph(nullptr), stop(0), distance(0) {}
+    prefetch_edge_iterator(edge_iterator it, LC_CSR_Graph* g, uint64_t s,
+                           unsigned d)
+        : prefetch_edge_iterator::iterator_adaptor_(it), graph(g), stop(s),
+          distance(d) {}
+  };
+
 protected:
   NodeData nodeData;
   EdgeIndData edgeIndData;
@@ -467,6 +499,67 @@ public:
     return edges(N, mflag);
   }
 
+  //! Prefetches the data of node N
+  void prefetchData(GraphNode N) { substrate::prefetch(&nodeData[N]); }
+
+  /**
+   * Like edges(ii, ee) but hides the latency of accessing destination node
+   * data by prefetching the destination distance edges ahead of the
+   * iteration. A distance of 0 disables prefetching. There is no default
+   * distance: the best one depends on the machine, so callers pass it from
+   * their own option. Does not acquire any locks.
+   */
+  runtime::iterable<prefetch_edge_iterator>
+  prefetched_edges(edge_iterator ii, edge_iterator ee, unsigned distance) {
+    uint64_t stop = distance ? *ee : 0;
+    // warm up the first distance destinations
+    for (uint64_t e = *ii, w = std::min(*ii + distance, stop); e < w; ++e)
+      prefetchData(edgeDst[e]);
+    return runtime::make_iterable(
+        prefetch_edge_iterator(ii, this, stop, distance),
+        prefetch_edge_iterator(ee, this, stop, distance));
+  }
+
+  runtime::iterable<prefetch_edge_iterator>
+  prefetched_edges(GraphNode N, MethodFlag mflag, unsigned distance) {
+    return prefetched_edges(edge_begin(N, mflag), edge_end(N, mflag),
+                            distance);
+  }
+
+  /**
+   * Applies fn to the edges in [ii, ee) in batches of batchSize edges. Each
+   * batch runs in two phases: first prefetch(dst) is called for the
+   * destination of every edge in the batch, then fn(edge) for every edge, so
+   * that the cache misses of a batch overlap instead of being serialized.
+   * A batchSize of 0 applies fn without prefetching.
+   */
+  template <typename P, typename F>
+  void forEachEdgeBatched(edge_iterator ii, edge_iterator ee,
+                          unsigned batchSize, const P& prefetch, const F& fn) {
+    if (!batchSize) {
+      for (; ii != ee; ++ii)
+        fn(ii);
+      return;
+    }
+    while (ii != ee) {
+      edge_iterator be = ee;
+      if (*ee - *ii > batchSize)
+        be = ii + batchSize;
+      for (edge_iterator jj = ii; jj != be; ++jj)
+        prefetch(getEdgeDst(jj));
+      for (; ii != be; ++ii)
+        fn(ii);
+    }
+  }
+
+  //! forEachEdgeBatched() prefetching destination node data
+  template <typename F>
+  void forEachEdgeBatched(edge_iterator ii, edge_iterator ee,
+                          unsigned batchSize, const F& fn) {
+    forEachEdgeBatched(ii, ee, batchSize,
+                       [this](GraphNode dst) { prefetchData(dst); }, fn);
+  }
+
   /**
    * Sorts outgoing edges of a node. Comparison function is over EdgeTy.
    */
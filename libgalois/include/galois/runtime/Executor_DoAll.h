@@ -32,11 +32,29 @@
 #include "galois/substrate/PaddedLock.h"
 #include "galois/substrate/CompilerSpecific.h"
 
+#include <iterator>
+
 namespace galois {
 namespace runtime {
 
 namespace internal {
 
+//! std::distance unless Iter provides a cheaper one found by ADL (e.g.,
+//! InsertBag iterators, which skip whole pages)
+template <typename Iter>
+auto iterDistance(const Iter& b, const Iter& e) {
+  using std::distance;
+  return distance(b, e);
+}
+
+//! std::advance unless Iter provides a cheaper one found by ADL
+template <typename Iter>
+void iterAdvance(Iter& it,
+                 typename std::iterator_traits<Iter>::difference_type n) {
+  using std::advance;
+  advance(it, n);
+}
+
 template <typename R, typename F, typename ArgsTuple>
 class DoAllStealingExec {
 
@@ -72,7 +90,7 @@ class DoAllStealingExec {
 
     ThreadContext(unsigned id, Iter beg, Iter end)
         : work_mutex(), id(id), shared_beg(beg), shared_end(end),
-          m_size(std::distance(beg, end)), num_iter(0) {}
+          m_size(iterDistance(beg, end)), num_iter(0) {}
 
     bool doWork(F& func, const unsigned chunk_size) {
       Iter beg(shared_beg);
@@ -128,7 +146,7 @@ class DoAllStealingExec {
             m_size = 0;
 
           } else {
-            std::advance(nbeg, chunk_size);
+            iterAdvance(nbeg, chunk_size);
             m_size -= chunk_size;
             assert(m_size > 0);
           }
@@ -148,7 +166,7 @@ class DoAllStealingExec {
 
       // steal from front for forward_iterator_tag
       steal_beg = shared_beg;
-      std::advance(shared_beg, sz);
+      iterAdvance(shared_beg, sz);
       steal_end = shared_beg;
     }
 
@@ -156,7 +174,7 @@ class DoAllStealingExec {
                              std::bidirectional_iterator_tag) {
 
       steal_end = shared_end;
-      std::advance(shared_end, -sz);
+      iterAdvance(shared_end, -sz);
       steal_beg = shared_end;
     }
 
@@ -170,7 +188,7 @@ class DoAllStealingExec {
     void steal_from_beg(Iter& steal_beg, Iter& steal_end, const Diff_ty sz) {
       assert(sz > 0);
       steal_beg = shared_beg;
-      std::advance(shared_beg, sz);
+      iterAdvance(shared_beg, sz);
       steal_end = shared_beg;
     }
 
@@ -218,7 +236,7 @@ class DoAllStealingExec {
       {
         assert(!hasWorkWeak());
         assert(beg != end);
-        assert(std::distance(beg, end) == sz);
+        assert(iterDistance(beg, end) == sz);
 
         shared_beg = beg;
         shared_end = end;
@@ -247,7 +265,7 @@ private:
 
     if (succ) {
       assert(steal_beg != steal_end);
-      assert(std::distance(steal_beg, steal_end) == steal_size);
+      assert(iterDistance(steal_beg, steal_end) == steal_size);
 
       poor.assignWork(steal_beg, steal_end, steal_size);
     }
@@ -255,35 +273,25 @@ private:
     return succ;
   }
 
-  GALOIS_ATTRIBUTE_NOINLINE bool stealWithinSocket(ThreadContext& poor) {
+  //! Steals half the work of the first active thread in peers that has work
+  bool stealFromPeers(ThreadContext& poor, const std::vector<unsigned>& peers) {
 
     bool sawWork   = false;
     bool stoleWork = false;
 
-    auto& tp = substrate::getThreadPool();
-
-    const unsigned maxT     = galois::getActiveThreads();
-    const unsigned my_pack  = substrate::ThreadPool::getSocket();
-    const unsigned per_pack = tp.getMaxThreads() / tp.getMaxSockets();
-
-    const unsigned pack_beg = my_pack * per_pack;
-    const unsigned pack_end = (my_pack + 1) * per_pack;
+    const unsigned maxT = galois::getActiveThreads();
 
-    for (unsigned i = 1; i < pack_end; ++i) {
-
-      // go around the socket in circle starting from the next thread
-      unsigned t = (poor.id + i) % per_pack + pack_beg;
-      assert((t >= pack_beg) && (t < pack_end));
+    for (unsigned t : peers) {
+      if (t >= maxT)
+        continue;
 
-      if (t < maxT) {
-        if (workers.getRemote(t)->hasWorkWeak()) {
-          sawWork = true;
+      if (workers.getRemote(t)->hasWorkWeak()) {
+        sawWork = true;
 
-          stoleWork = transferWork(*workers.getRemote(t), poor, HALF);
+        stoleWork = transferWork(*workers.getRemote(t), poor, HALF);
 
-          if (stoleWork) {
-            break;
-          }
+        if (stoleWork) {
+          break;
         }
       }
     }
@@ -291,6 +299,16 @@ private:
     return sawWork || stoleWork;
   }
 
+  GALOIS_ATTRIBUTE_NOINLINE bool stealWithinL3(ThreadContext& poor) {
+    return stealFromPeers(poor, substrate::getThreadPool().getL3Peers(poor.id));
+  }
+
+  //! Steals from the threads of this socket outside this thread's L3 domain
+  GALOIS_ATTRIBUTE_NOINLINE bool stealWithinSocket(ThreadContext& poor) {
+    return stealFromPeers(poor,
+                          substrate::getThreadPool().getSocketPeers(poor.id));
+  }
+
   GALOIS_ATTRIBUTE_NOINLINE bool stealOutsideSocket(ThreadContext& poor,
                                                     const StealAmt& amt) {
     bool sawWork   = false;
@@ -369,6 +387,14 @@ private:
   GALOIS_ATTRIBUTE_NOINLINE bool trySteal(ThreadContext& poor) {
     bool ret = false;
 
+    ret = stealWithinL3(poor);
+
+    if (ret) {
+      return true;
+    }
+
+    substrate::asmPause();
+
     ret = stealWithinSocket(poor);
 
     if (ret) {
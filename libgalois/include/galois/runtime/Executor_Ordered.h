@@ -20,35 +20,363 @@
 #ifndef GALOIS_RUNTIME_EXECUTOR_ORDERED_H
 #define GALOIS_RUNTIME_EXECUTOR_ORDERED_H
 
+#include "galois/Threads.h"
+#include "galois/Traits.h"
+#include "galois/gIO.h"
+#include "galois/runtime/Context.h"
+#include "galois/runtime/Executor_DoAll.h"
+#include "galois/runtime/Executor_OnEach.h"
+#include "galois/runtime/Range.h"
+#include "galois/runtime/Statistics.h"
+#include "galois/runtime/UserContextAccess.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <vector>
+
 namespace galois {
 namespace runtime {
 
-// TODO(ddn): Pull in and integrate in executors from exp
+//! Implementation of the ordered executor
+namespace internal {
+
+/**
+ * Context of an item in the current window. Locks requested by the
+ * neighborhood function are resolved in priority order: an item steals a
+ * lock from a later item (which then cannot execute this round) and gives
+ * up when the owner is earlier. Ties in the user's comparison are broken by
+ * address so that some item always wins all of its locks.
+ */
+template <typename T, typename Cmp>
+class OrderedContext : public SimpleRuntimeContext {
+  const Cmp& cmp;
+  bool notReady;
+
+public:
+  T item;
+
+  OrderedContext(const T& _item, const Cmp& _cmp)
+      : SimpleRuntimeContext(true), cmp(_cmp), notReady(false), item(_item) {}
+
+  bool isReady() const { return !notReady; }
+
+  void disable() { notReady = true; }
 
-#if 0
-template <typename NhFunc, typename OpFunc>
-struct OrderedTraits {
-  static const bool NeedsPush = !galois::DEPRECATED::does_not_need_push<OpFunc>::value;
-  static const bool HasFixedNeighborhood = galois::DEPRECATED::has_fixed_neighborhood<NhFunc>::value;
+  //! Strict total order over the contexts of a window. The user's comparison
+  //! may be "less than" or "less than or equal", so items are only ordered by
+  //! it when it holds one way and not the other
+  bool precedes(const OrderedContext& other) const {
+    bool before = cmp(item, other.item);
+    bool after  = cmp(other.item, item);
+    if (before != after) {
+      return before;
+    }
+    return this < &other;
+  }
+
+  virtual void subAcquire(Lockable* lockable, galois::MethodFlag) {
+    if (this->tryLock(lockable))
+      this->addToNhood(lockable);
+
+    OrderedContext* other;
+    do {
+      other = static_cast<OrderedContext*>(this->getOwner(lockable));
+      if (other == this)
+        return;
+      if (other && other->precedes(*this)) {
+        // A lock that I want but can't get
+        notReady = true;
+        return;
+      }
+    } while (!this->stealByCAS(lockable, other));
+
+    // Disable loser
+    if (other) {
+      other->notReady = true;
+    }
+  }
 };
-#endif
+
+/**
+ * Windowed two-phase executor for ordered algorithms.
+ *
+ * Pending items are kept in per-thread min-heaps. Each round takes the
+ * earliest items of all heaps as the window, runs the neighborhood function
+ * of every window item to claim its locks, and then runs the operator on
+ * the items that won all of their locks; the rest are retried in a later
+ * round. The window grows while most of it commits and shrinks with the
+ * abort rate otherwise.
+ *
+ * For unstable-source algorithms, winners must also pass the stability test
+ * before they execute. The earliest pending item can always execute, which
+ * guarantees progress.
+ */
+template <typename T, typename Cmp, typename NhFunc, typename OpFunc,
+          typename StableTest, bool HasStableTest>
+class OrderedExecutor {
+  using Ctx    = OrderedContext<T, Cmp>;
+  using HeapTy = std::vector<T>;
+
+  //! min-heap adaptor of the user's comparison
+  struct HeapCmp {
+    const Cmp& cmp;
+    bool operator()(const T& a, const T& b) const {
+      return cmp(b, a) && !cmp(a, b);
+    }
+  };
+
+  struct ThreadLocalData {
+    HeapTy heap;
+    std::vector<T> staged;
+    std::deque<Ctx> window;
+    Ctx* windowMin = nullptr;
+    UserContextAccess<T> facing;
+    size_t commits = 0;
+    size_t aborts  = 0;
+  };
+
+  //! Target fraction of the window that should commit
+  static constexpr double TARGET_COMMIT_RATIO = 0.80;
+  //! Minimum number of window items per thread
+  static constexpr size_t MIN_WIN_PER_THREAD = 16;
+  //! Initial window size is this many times the minimum
+  static constexpr size_t INIT_WIN_MULT = 4;
+
+  Cmp cmp;
+  NhFunc nhFunc;
+  OpFunc opFunc;
+  StableTest stabilityTest;
+  const char* loopname;
+
+  HeapCmp heapCmp;
+  substrate::PerThreadStorage<ThreadLocalData> tlds;
+  std::vector<Ctx*> windowItems;
+  Ctx* windowMin;
+
+  //! a strictly before b, for "less than" and "less than or equal" alike
+  bool earlier(const T& a, const T& b) const {
+    return cmp(a, b) && !cmp(b, a);
+  }
+
+  void pushPending(ThreadLocalData& tld, const T& item) {
+    tld.heap.push_back(item);
+    std::push_heap(tld.heap.begin(), tld.heap.end(), heapCmp);
+  }
+
+  /**
+   * Moves the earliest pending items into the per-thread windows.
+   *
+   * Each thread takes its earliest pending items up to its share of
+   * windowSize; the window then keeps only the items no later than the
+   * earliest last-taken item of a thread that still has pending items, so
+   * that every item left pending is at least as late as every item in the
+   * window.
+   *
+   * @returns number of items in the window
+   */
+  size_t fillWindow(size_t windowSize) {
+    const unsigned numT    = getActiveThreads();
+    const size_t perThread = (windowSize + numT - 1) / numT;
+
+    substrate::PerThreadStorage<const T*> candidates;
+
+    on_each_gen(
+        [&](const unsigned, const unsigned) {
+          ThreadLocalData& tld = *tlds.getLocal();
+          tld.staged.clear();
+          for (size_t i = 0; i < perThread && !tld.heap.empty(); ++i) {
+            std::pop_heap(tld.heap.begin(), tld.heap.end(), heapCmp);
+            tld.staged.push_back(tld.heap.back());
+            tld.heap.pop_back();
+          }
+          *candidates.getLocal() =
+              tld.heap.empty() ? nullptr : &tld.staged.back();
+        },
+        std::make_tuple(galois::no_stats()));
+
+    const T* limit = nullptr;
+    for (unsigned i = 0; i < numT; ++i) {
+      const T* c = *candidates.getRemote(i);
+      if (c && (!limit || earlier(*c, *limit))) {
+        limit = c;
+      }
+    }
+
+    on_each_gen(
+        [&](const unsigned, const unsigned) {
+          ThreadLocalData& tld = *tlds.getLocal();
+          tld.window.clear();
+          tld.windowMin = nullptr;
+          for (const T& item : tld.staged) {
+            if (limit && earlier(*limit, item)) {
+              pushPending(tld, item);
+            } else {
+              tld.window.emplace_back(item, cmp);
+              Ctx& c = tld.window.back();
+              if (!tld.windowMin || c.precedes(*tld.windowMin)) {
+                tld.windowMin = &c;
+              }
+            }
+          }
+        },
+        std::make_tuple(galois::no_stats()));
+
+    windowItems.clear();
+    windowMin = nullptr;
+    for (unsigned i = 0; i < numT; ++i) {
+      ThreadLocalData& tld = *tlds.getRemote(i);
+      for (Ctx& c : tld.window) {
+        windowItems.push_back(&c);
+      }
+      if (tld.windowMin &&
+          (!windowMin || tld.windowMin->precedes(*windowMin))) {
+        windowMin = tld.windowMin;
+      }
+    }
+
+    return windowItems.size();
+  }
+
+  //! Runs the neighborhood function of every window item
+  void expandNhood() {
+    do_all_gen(makeStandardRange(windowItems.begin(), windowItems.end()),
+               [&](Ctx* c) {
+                 setThreadContext(c);
+                 c->startIteration();
+                 nhFunc(c->item);
+                 setThreadContext(nullptr);
+               },
+               std::make_tuple(galois::steal(), galois::no_stats()));
+  }
+
+  template <bool B = HasStableTest>
+  std::enable_if_t<B> applyStabilityTest() {
+    do_all_gen(makeStandardRange(windowItems.begin(), windowItems.end()),
+               [&](Ctx* c) {
+                 if (c->isReady() && c != windowMin &&
+                     !stabilityTest(c->item)) {
+                   c->disable();
+                 }
+               },
+               std::make_tuple(galois::steal(), galois::no_stats()));
+  }
+
+  template <bool B = HasStableTest>
+  std::enable_if_t<!B> applyStabilityTest() {}
+
+  //! Runs the operator on the winners and returns the losers to the heaps
+  void executeSources() {
+    do_all_gen(makeStandardRange(windowItems.begin(), windowItems.end()),
+               [&](Ctx* c) {
+                 ThreadLocalData& tld = *tlds.getLocal();
+                 if (c->isReady()) {
+                   opFunc(c->item, tld.facing.data());
+                   auto& pb = tld.facing.getPushBuffer();
+                   for (auto& item : pb) {
+                     pushPending(tld, item);
+                   }
+                   pb.clear();
+                   tld.facing.resetAlloc();
+                   ++tld.commits;
+                 } else {
+                   pushPending(tld, c->item);
+                   ++tld.aborts;
+                 }
+                 c->commitIteration();
+               },
+               std::make_tuple(galois::steal(), galois::no_stats()));
+  }
+
+  size_t totalCommits() {
+    size_t commits = 0;
+    for (unsigned i = 0; i < getActiveThreads(); ++i) {
+      commits += tlds.getRemote(i)->commits;
+    }
+    return commits;
+  }
+
+  size_t numPending() {
+    size_t pending = 0;
+    for (unsigned i = 0; i < getActiveThreads(); ++i) {
+      pending += tlds.getRemote(i)->heap.size();
+    }
+    return pending;
+  }
+
+public:
+  OrderedExecutor(const Cmp& cmp, const NhFunc& nhFunc, const OpFunc& opFunc,
+                  const StableTest& stabilityTest, const char* loopname)
+      : cmp(cmp), nhFunc(nhFunc), opFunc(opFunc), stabilityTest(stabilityTest),
+        loopname(loopname ? loopname : "for_each_ordered"),
+        heapCmp{this->cmp}, windowMin(nullptr) {}
+
+  template <typename Iter>
+  void execute(Iter beg, Iter end) {
+    do_all_gen(makeStandardRange(beg, end),
+               [&](const T& item) { tlds.getLocal()->heap.push_back(item); },
+               std::make_tuple(galois::no_stats()));
+    on_each_gen(
+        [&](const unsigned, const unsigned) {
+          HeapTy& heap = tlds.getLocal()->heap;
+          std::make_heap(heap.begin(), heap.end(), heapCmp);
+        },
+        std::make_tuple(galois::no_stats()));
+
+    const size_t minWindow = MIN_WIN_PER_THREAD * getActiveThreads();
+    size_t windowSize =
+        std::max(minWindow, std::min(numPending(), INIT_WIN_MULT * minWindow));
+    size_t rounds      = 0;
+    size_t prevCommits = 0;
+
+    while (fillWindow(windowSize) != 0) {
+      size_t currWindow = windowItems.size();
+      ++rounds;
+
+      expandNhood();
+      applyStabilityTest();
+      executeSources();
+
+      size_t commits = totalCommits();
+      double commitRatio =
+          double(commits - prevCommits) / double(currWindow);
+      prevCommits = commits;
+
+      if (commitRatio >= TARGET_COMMIT_RATIO) {
+        windowSize = 2 * currWindow;
+      } else {
+        windowSize = size_t(currWindow * commitRatio / TARGET_COMMIT_RATIO);
+      }
+      windowSize = std::max(windowSize, minWindow);
+    }
+
+    size_t aborts = 0;
+    for (unsigned i = 0; i < getActiveThreads(); ++i) {
+      aborts += tlds.getRemote(i)->aborts;
+    }
+    reportStat_Single(loopname, "Iterations", prevCommits);
+    reportStat_Single(loopname, "Conflicts", aborts);
+    reportStat_Single(loopname, "Rounds", rounds);
+  }
+};
+
+template <typename T>
+struct AlwaysStable {
+  bool operator()(const T&) const { return true; }
+};
+
+} // end namespace internal
 
 template <typename Iter, typename Cmp, typename NhFunc, typename OpFunc>
 void for_each_ordered_impl(Iter beg, Iter end, const Cmp& cmp,
                            const NhFunc& nhFunc, const OpFunc& opFunc,
                            const char* loopname) {
-#if 0
-  if (!OrderedTraits<NhFunc, OpFunc>::NeedsPush && OrderedTraits<NhFunc, OpFunc>::HasFixedNeighborhood) {
-    // TODO: Remove-only/DAG executor
-    GALOIS_DIE("Remove-only executor not implemented yet");
-  } else if (OrderedTraits<NhFunc, OpFunc>::HasFixedNeighborhood) {
-    for_each_ordered_lc (beg, end, cmp, nhFunc, opFunc, loopname);
-  } else {
-    for_each_ordered_2p (beg, end, cmp, nhFunc, opFunc, loopname);
-  }
-#else
-  GALOIS_DIE("not yet implemented");
-#endif
+  using T = typename std::iterator_traits<Iter>::value_type;
+  internal::OrderedExecutor<T, Cmp, NhFunc, OpFunc, internal::AlwaysStable<T>,
+                            false>
+      exec(cmp, nhFunc, opFunc, internal::AlwaysStable<T>(), loopname);
+  exec.execute(beg, end);
 }
 
 template <typename Iter, typename Cmp, typename NhFunc, typename OpFunc,
@@ -57,19 +385,10 @@ void for_each_ordered_impl(Iter beg, Iter end, const Cmp& cmp,
                            const NhFunc& nhFunc, const OpFunc& opFunc,
                            const StableTest& stabilityTest,
                            const char* loopname) {
-#if 0
-  if (!OrderedTraits<NhFunc, OpFunc>::NeedsPush && OrderedTraits<NhFunc, OpFunc>::HasFixedNeighborhood) {
-    GALOIS_DIE("no-adds + fixed-neighborhood == stable-source");
-  } else if (OrderedTraits<NhFunc, OpFunc>::HasFixedNeighborhood) {
-    for_each_ordered_lc (beg, end, cmp, nhFunc, opFunc, stabilityTest, loopname);
-  } else {
-    GALOIS_DIE("two-phase executor for unstable-source algorithms not implemented yet");
-    // TODO: implement following
-    // for_each_ordered_2p (beg, end, cmp, nhFunc, opFunc, stabilityTest, loopname); 
-  }
-#else
-  GALOIS_DIE("not yet implemented");
-#endif
+  using T = typename std::iterator_traits<Iter>::value_type;
+  internal::OrderedExecutor<T, Cmp, NhFunc, OpFunc, StableTest, true> exec(
+      cmp, nhFunc, opFunc, stabilityTest, loopname);
+  exec.execute(beg, end);
 }
 
 } // end namespace runtime
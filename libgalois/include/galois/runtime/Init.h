@@ -22,6 +22,7 @@
 
 #include "galois/runtime/Statistics.h"
 #include "galois/runtime/PagePool.h"
+#include "galois/runtime/Mem.h"
 #include "galois/substrate/Init.h"
 
 #include <string>
@@ -41,10 +42,19 @@ public:
   explicit SharedMemRuntime(void) : Base(), m_pa(), m_sm() {
     internal::setPagePoolState(&m_pa);
     internal::setSysStatManager(&m_sm);
+    substrate::getThreadPool().setEndOfRunHook(&SlabHeap::flushReturns);
+  }
+
+  explicit SharedMemRuntime(galois::substrate::PagePolicy policy)
+      : Base(policy), m_pa(), m_sm() {
+    internal::setPagePoolState(&m_pa);
+    internal::setSysStatManager(&m_sm);
+    substrate::getThreadPool().setEndOfRunHook(&SlabHeap::flushReturns);
   }
 
   ~SharedMemRuntime(void) {
     m_sm.print();
+    substrate::getThreadPool().setEndOfRunHook(nullptr);
     internal::setSysStatManager(nullptr);
     internal::setPagePoolState(nullptr);
   }
@@ -28,6 +28,7 @@
 #include "galois/gIO.h"
 #include "galois/runtime/PagePool.h"
 
+#include <atomic>
 #include <memory>
 #include <boost/utility.hpp>
 #include <cstdlib>
@@ -36,6 +37,7 @@
 #include <list>
 #include <cstddef>
 #include <cstdio>
+#include <vector>
 
 namespace galois {
 namespace runtime {
@@ -587,6 +589,181 @@ public:
   }
 };
 
+/**
+ * Fixed-size heap that hands freed objects back to the thread that carved
+ * them out.
+ *
+ * Objects are cut from pages of SystemHeap (slabs), which are aligned to
+ * their size so the slab of an object is found by masking its address. A
+ * slab belongs to the thread that took it and only that thread allocates from
+ * it. Objects freed by other threads are collected in per-owner batches and
+ * pushed as one chain onto the owner's return stack; the owner drains it
+ * before taking a new slab. Every thread also flushes its batches when it
+ * finishes its part of a thread pool run (see SlabHeap::flushReturns),
+ * so nothing freed in one parallel region, whatever the executor, is stranded
+ * on another thread's list.
+ *
+ * The end of a run doubles as the reclamation epoch. Operators only free
+ * objects they hold exclusively (under the loop's abstract locks, or after
+ * unlinking them), so no other thread can still be reading a freed object
+ * and no per-object grace period is needed before reuse.
+ *
+ * Once all objects of a slab are free and the owner holds more than
+ * ReclaimThreshold free bytes of this size, the slab is given back to the
+ * page pool, which returns it to the pool of the thread (and hence NUMA node)
+ * that allocated it.
+ */
+class SlabHeap : private boost::noncopyable {
+  friend class SizedHeapFactory;
+
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  struct Slab {
+    Slab* next; //!< next slab of owner with free objects
+    Slab* prev;
+    Slab* nextAll; //!< next slab of owner
+    Slab* prevAll;
+    FreeNode* free; //!< objects given back to this slab
+    char* bump;     //!< start of never allocated objects
+    unsigned owner;
+    unsigned live; //!< objects not given back to this slab
+    bool listed;   //!< on the list of slabs with free objects
+  };
+
+  struct Batch {
+    FreeNode* head;
+    FreeNode* tail;
+    unsigned count;
+  };
+
+  struct ThreadState {
+    //! Chains of objects returned by other threads
+    std::atomic<FreeNode*> returned;
+    char pad[64 - sizeof(std::atomic<FreeNode*>)];
+    Slab* partial; //!< slabs with free objects
+    Slab* all;
+    size_t freeBytes; //!< free bytes in the slabs of this thread
+    //! Objects freed by this thread waiting to be returned to their owners,
+    //! indexed by owner
+    std::vector<Batch> batches;
+    unsigned pending; //!< number of non-empty batches
+    bool dirty;       //!< registered for flushing at the end of the loop
+
+    ThreadState()
+        : returned(nullptr), partial(nullptr), all(nullptr), freeBytes(0),
+          pending(0), dirty(false) {}
+  };
+
+  enum { SlabSize = SystemHeap::AllocSize, HeaderSize = 64, BatchSize = 64 };
+
+  substrate::PerThreadStorage<ThreadState> states;
+  size_t objSize;
+  size_t slabBytes; //!< header and objects of a slab
+
+  char* slabEnd(Slab* s) const { return (char*)s + slabBytes; }
+
+  static Slab* slabOf(void* ptr) {
+    return (Slab*)((uintptr_t)ptr & ~(uintptr_t)(SlabSize - 1));
+  }
+
+  static void linkPartial(ThreadState& st, Slab* s) {
+    s->prev = nullptr;
+    s->next = st.partial;
+    if (st.partial)
+      st.partial->prev = s;
+    st.partial = s;
+    s->listed  = true;
+  }
+
+  static void unlinkPartial(ThreadState& st, Slab* s) {
+    if (s->prev)
+      s->prev->next = s->next;
+    else
+      st.partial = s->next;
+    if (s->next)
+      s->next->prev = s->prev;
+    s->listed = false;
+  }
+
+  void refill(ThreadState& st);
+  bool drainReturned(ThreadState& st);
+  void releaseSlab(ThreadState& st, Slab* s);
+  void returnRemote(ThreadState& st, unsigned owner, FreeNode* n);
+  void flushBatches(ThreadState& st);
+
+  //! Gives an object back to its slab; called by the owner only
+  inline void release(ThreadState& st, Slab* s, void* ptr) {
+    FreeNode* n = (FreeNode*)ptr;
+    n->next     = s->free;
+    s->free     = n;
+    st.freeBytes += objSize;
+    if (!s->listed)
+      linkPartial(st, s);
+    if (--s->live == 0 && st.freeBytes > ReclaimThreshold)
+      releaseSlab(st, s);
+  }
+
+public:
+  enum { AllocSize = 0 };
+
+  //! Free bytes a thread keeps before giving empty slabs back to the page pool
+  static const size_t ReclaimThreshold = 2 * SlabSize;
+
+  explicit SlabHeap(size_t size);
+  ~SlabHeap() { clear(); }
+
+  inline void* allocate(size_t) {
+    ThreadState& st = *states.getLocal();
+    for (;;) {
+      Slab* s = st.partial;
+      if (!s) {
+        if (!drainReturned(st))
+          refill(st);
+        continue;
+      }
+      void* ptr;
+      if (s->free) {
+        ptr     = s->free;
+        s->free = s->free->next;
+      } else if (s->bump != slabEnd(s)) {
+        ptr = s->bump;
+        s->bump += objSize;
+      } else {
+        unlinkPartial(st, s);
+        continue;
+      }
+      ++s->live;
+      st.freeBytes -= objSize;
+      return ptr;
+    }
+  }
+
+  inline void deallocate(void* ptr) {
+    if (!ptr)
+      return;
+    Slab* s         = slabOf(ptr);
+    ThreadState& st = *states.getLocal();
+    unsigned tid    = substrate::ThreadPool::getTID();
+    if (s->owner == tid)
+      release(st, s, ptr);
+    else
+      returnRemote(st, s->owner, (FreeNode*)ptr);
+  }
+
+  //! Number of objects carved from one slab
+  size_t objectsPerSlab() const { return (slabBytes - HeaderSize) / objSize; }
+
+  //! Frees all slabs; not thread safe
+  void clear();
+
+  //! Returns objects the calling thread freed for other threads, in any
+  //! SlabHeap, to their owners; SharedMemRuntime installs this as the thread
+  //! pool's end-of-run hook
+  static void flushReturns();
+};
+
 #ifdef GALOIS_FORCE_STANDALONE
 class SizedHeapFactory : private boost::noncopyable {
 public:
@@ -604,7 +781,7 @@ class SizedHeapFactory : public StaticSingleInstance<SizedHeapFactory> {
 
 public:
   //! [FixedSizeAllocator example]
-  typedef ThreadPrivateHeap<FreeListHeap<BumpHeap<SystemHeap>>> SizedHeap;
+  typedef SlabHeap SizedHeap;
   //! [FixedSizeAllocator example]
 
   static SizedHeap* getHeapForSize(const size_t);
@@ -202,6 +202,9 @@ public:
 
   block_iterator block_begin() const { return block_pair().first; }
   block_iterator block_end() const { return block_pair().second; }
+
+  //! Returns the per-thread begin points this range was built with
+  const uint32_t* thread_ranges() const { return thread_beginnings; }
 };
 
 /**
@@ -757,7 +757,8 @@ void reportParam(const S1& region, const S2& category, const V& value) {
 void setStatFile(const std::string& f);
 
 // TODO: switch to gstl::Str in here
-//! Reports Galois system memory stats for all threads
+//! Reports Galois system memory stats for all threads and the sizes of the
+//! pages obtained from the OS
 void reportPageAlloc(const char* category);
 //! Reports NUMA memory stats for all NUMA nodes
 void reportNumaAlloc(const char* category);
@@ -32,6 +32,13 @@ inline static void asmPause() {
 
 inline static void compilerBarrier() { asm volatile("" ::: "memory"); }
 
+//! Hint to bring the cache line holding p into the cache for reading
+inline static void prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__INTEL_COMPILER)
+  __builtin_prefetch(p);
+#endif
+}
+
 inline static void flushInstructionPipeline() {
 #if defined(__i386__) || defined(__amd64__)
   asm volatile("xor %%eax, %%eax;"
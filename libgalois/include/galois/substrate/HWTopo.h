@@ -33,6 +33,9 @@ struct threadTopoInfo {
   unsigned cumulativeMaxSocket; // max socket id seen from [0, tid]
   unsigned osContext;           // OS ID to use for thread binding
   unsigned osNumaNode;          // OS ID for numa node
+  unsigned coreLeader;          // first thread id on tid's physical core
+  unsigned l3Domain;            // L3 cache domain of thread (socket if unknown)
+  unsigned l3Leader;            // first thread id in tid's L3 domain
 };
 
 struct machineTopoInfo {
@@ -40,6 +43,7 @@ struct machineTopoInfo {
   unsigned maxCores;
   unsigned maxSockets;
   unsigned maxNumaNodes;
+  unsigned maxL3Domains;
 };
 
 // parse machine topology
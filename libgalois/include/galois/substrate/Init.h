@@ -24,16 +24,23 @@
 #include "galois/substrate/ThreadPool.h"
 #include "galois/substrate/Barrier.h"
 #include "galois/substrate/Termination.h"
+#include "galois/substrate/PageAlloc.h"
 
 namespace galois {
 namespace substrate {
 
 class SharedMemSubstrate {
 
-  // Order is critical here
+  struct PagePolicyInit {
+    explicit PagePolicyInit(PagePolicy p) { setPagePolicy(p); }
+  };
+
+  // Order is critical here: the page policy must be set before the thread
+  // pool allocates per-thread storage
+  PagePolicyInit m_pagePolicy;
   ThreadPool m_tpool;
 
-  internal::LocalTerminationDetection<>* m_termPtr;
+  TerminationDetection* m_termPtr;
   internal::BarrierInstance<>* m_biPtr;
 
 public:
@@ -42,6 +49,12 @@ public:
    */
   SharedMemSubstrate();
 
+  /**
+   * Initializes the Substrate library components, backing memory according
+   * to the given page policy instead of GALOIS_PAGE_POLICY
+   */
+  explicit SharedMemSubstrate(PagePolicy policy);
+
   /**
    * Destroys the Substrate library components
    */
@@ -25,15 +25,54 @@
 namespace galois {
 namespace substrate {
 
+//! How allocPages backs memory with pages of the OS
+enum class PagePolicy {
+  DEFAULT, //!< 2 MB hugetlbfs pages, falling back to regular pages
+  NORMAL,  //!< regular pages only (transparent huge pages disabled)
+  THP,     //!< regular pages advised for transparent huge pages
+  HUGE_2M, //!< 2 MB hugetlbfs pages, falling back to THP
+  HUGE_1G  //!< 1 GB hugetlbfs pages for large allocations, then as HUGE_2M
+};
+
+//! Kinds of pages allocPages may obtain from the OS
+enum PageKind {
+  PAGE_NORMAL,
+  PAGE_THP,
+  PAGE_HUGE_2M,
+  PAGE_HUGE_1G,
+  NUM_PAGE_KINDS
+};
+
+/**
+ * Sets the page policy for subsequent allocations. The initial policy is read
+ * from the GALOIS_PAGE_POLICY environment variable (default, normal, thp, 2m
+ * or 1g) and is DEFAULT if it is not set.
+ */
+void setPagePolicy(PagePolicy p);
+PagePolicy getPagePolicy();
+
+//! Parses a policy name as accepted in GALOIS_PAGE_POLICY
+bool parsePagePolicy(const char* name, PagePolicy& p);
+
 // size of pages
 size_t allocSize();
 
+//! Granularity an allocation of bytes should be rounded up to under the
+//! current policy; always a multiple of allocSize()
+size_t allocSizeFor(size_t bytes);
+
 // allocate contiguous pages, optionally faulting them in
 void* allocPages(unsigned num, bool preFault);
 
 // free page range
 void freePages(void* ptr, unsigned num);
 
+//! Bytes obtained from the OS so far backed by pages of kind k
+size_t numPageBytes(PageKind k);
+//! Number of allocations that did not get the pages the policy asked for
+size_t numPageFallbacks();
+const char* pageKindName(PageKind k);
+
 } // namespace substrate
 } // namespace galois
 
@@ -24,6 +24,8 @@
 #include "galois/substrate/CacheLineStorage.h"
 
 #include <atomic>
+#include <cstdlib>
+#include <new>
 
 namespace galois {
 namespace substrate {
@@ -49,6 +51,19 @@ protected:
 
 public:
   virtual ~TerminationDetection(void);
+
+  //! Detectors hold cache line aligned members, which the global operator new
+  //! does not honour before C++17
+  static void* operator new(size_t size) {
+    size = (size + GALOIS_CACHE_LINE_SIZE - 1) &
+           ~size_t(GALOIS_CACHE_LINE_SIZE - 1);
+    void* ptr = aligned_alloc(GALOIS_CACHE_LINE_SIZE, size);
+    if (!ptr)
+      throw std::bad_alloc();
+    return ptr;
+  }
+
+  static void operator delete(void* ptr) { free(ptr); }
   /**
    * Initializes the per-thread state.  All threads must call this
    * before any call localTermination.
@@ -69,6 +84,8 @@ public:
    * Returns whether global termination is detected.
    */
   bool globalTermination() const { return globalTerm.data; }
+
+  virtual const char* name() const = 0;
 };
 
 namespace internal {
@@ -142,6 +159,8 @@ public:
       propToken(taint);
     }
   }
+
+  virtual const char* name() const { return "LocalTerminationDetection"; }
 };
 
 // Dijkstra style 2-pass tree termination detection
@@ -251,8 +270,162 @@ public:
     th.processIsBlack |= workHappened;
     processToken();
   }
+
+  virtual const char* name() const { return "TreeTerminationDetection"; }
 };
 
+/**
+ * Dijkstra style 2-pass termination detection over a tree that follows the
+ * machine topology: SMT siblings report to their core, cores to their socket
+ * and sockets to the root.
+ *
+ * Detection proceeds in epochs. In each epoch every thread arrives once at
+ * its tree node, which counts arrivals with an atomic counter; the last
+ * arrival at a node forwards the node's color to its parent. The thread that
+ * completes the root either detects termination (two consecutive white
+ * epochs) or opens the next epoch. Compared to the ring, the critical path of
+ * a round is a few atomic updates per level instead of one token hop per
+ * thread, and only the upper levels cross sockets.
+ */
+template <typename _UNUSED = void>
+class TopoTerminationDetection : public TerminationDetection {
+
+  struct Node {
+    std::atomic<unsigned> arrived;
+    std::atomic<bool> black;
+    unsigned children; //!< arrivals that complete the node
+    Node* parent;      //!< null for the top node
+  };
+
+  struct ThreadState {
+    Node* leaf;         //!< node this thread arrives at
+    unsigned nextEpoch; //!< epoch this thread arrives in next
+    bool processIsBlack;
+  };
+
+  PerThreadStorage<Node> coreNodes;   // used on core leaders
+  PerThreadStorage<Node> socketNodes; // used on socket leaders
+  CacheLineStorage<Node> root;
+  PerThreadStorage<ThreadState> data;
+
+  CacheLineStorage<std::atomic<unsigned>> epoch;
+  bool lastWasWhite; // only used by the thread completing the root
+
+  unsigned activeThreads;
+  unsigned builtFor;
+
+  static void resetNode(Node& n) {
+    n.arrived.store(0, std::memory_order_relaxed);
+    n.black.store(false, std::memory_order_relaxed);
+  }
+
+  //! Builds the tree for the first aThreads threads; runs on the master
+  void build(unsigned aThreads) {
+    auto& tp = getThreadPool();
+
+    for (unsigned t = 0; t < aThreads; ++t) {
+      coreNodes.getRemote(t)->children   = 0;
+      socketNodes.getRemote(t)->children = 0;
+    }
+    root.data.children = 0;
+
+    // count children bottom up
+    for (unsigned t = 0; t < aThreads; ++t)
+      ++coreNodes.getRemote(tp.getCoreLeader(t))->children;
+    for (unsigned t = 0; t < aThreads; ++t)
+      if (tp.getCoreLeader(t) == t)
+        ++socketNodes.getRemote(tp.getLeader(t))->children;
+    for (unsigned t = 0; t < aThreads; ++t)
+      if (tp.isLeader(t))
+        ++root.data.children;
+
+    // link; a core with a single thread is skipped, as is the root with a
+    // single socket
+    Node* top = root.data.children > 1 ? &root.data : nullptr;
+    root.data.parent = nullptr;
+    for (unsigned t = 0; t < aThreads; ++t) {
+      Node* socket  = socketNodes.getRemote(tp.getLeader(t));
+      Node* core    = coreNodes.getRemote(tp.getCoreLeader(t));
+      socket->parent = top;
+      core->parent   = socket;
+      data.getRemote(t)->leaf = core->children > 1 ? core : socket;
+    }
+    builtFor = aThreads;
+  }
+
+  void propGlobalTerm() { globalTerm = true; }
+
+protected:
+  virtual void init(unsigned aThreads) {
+    activeThreads = aThreads;
+    if (builtFor != aThreads)
+      build(aThreads);
+  }
+
+public:
+  TopoTerminationDetection() : lastWasWhite(false), activeThreads(0), builtFor(0) {}
+
+  virtual void initializeThread() {
+    auto& tp        = getThreadPool();
+    unsigned tid    = ThreadPool::getTID();
+    ThreadState& th = *data.getLocal();
+    th.nextEpoch      = 0;
+    th.processIsBlack = true;
+    globalTerm        = false;
+    // a loop that breaks may leave partial arrivals behind
+    if (tp.getCoreLeader(tid) == tid)
+      resetNode(*coreNodes.getLocal());
+    if (ThreadPool::isLeader())
+      resetNode(*socketNodes.getLocal());
+    if (tid == 0) {
+      resetNode(root.data);
+      lastWasWhite = false;
+      epoch.data.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  virtual void localTermination(bool workHappened) {
+    assert(!(workHappened && globalTerm.get()));
+    ThreadState& th = *data.getLocal();
+    th.processIsBlack |= workHappened;
+
+    unsigned e = epoch.data.load(std::memory_order_acquire);
+    if (th.nextEpoch != e)
+      return; // already arrived in this epoch
+    ++th.nextEpoch;
+
+    bool black        = th.processIsBlack;
+    th.processIsBlack = false;
+    for (Node* n = th.leaf; n; n = n->parent) {
+      if (black)
+        n->black.store(true, std::memory_order_relaxed);
+      if (n->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 != n->children)
+        return;
+      // last arrival: collect the color of the node and reset it for the
+      // next epoch, which cannot start before the root is complete
+      black = n->black.load(std::memory_order_relaxed);
+      resetNode(*n);
+    }
+
+    if (lastWasWhite && !black) {
+      // This was the second success
+      propGlobalTerm();
+      return;
+    }
+    lastWasWhite = !black;
+    epoch.data.store(e + 1, std::memory_order_release);
+  }
+
+  virtual const char* name() const { return "TopoTerminationDetection"; }
+};
+
+/**
+ * Creates the termination detector selected by the GALOIS_TERM environment
+ * variable: "ring" (LocalTerminationDetection, the default), "tree"
+ * (TreeTerminationDetection) or "topo" (TopoTerminationDetection)
+ */
+TerminationDetection* createTermDetect();
+
 void setTermDetect(TerminationDetection* term);
 } // end namespace internal
 
@@ -102,11 +102,16 @@ protected:
 
   machineTopoInfo mi;
   std::vector<per_signal*> signals;
+  std::vector<std::vector<unsigned>> socketThreads;
+  std::vector<std::vector<unsigned>> l3Peers;
+  std::vector<std::vector<unsigned>> socketPeers;
   std::vector<std::thread> threads;
   unsigned reserved;
   unsigned masterFastmode;
   bool running;
   std::function<void(void)> work;
+  //! run by every thread after its share of the work of a run
+  void (*endOfRunHook)();
 
   //! destroy all threads
   void destroyCommon();
@@ -166,6 +171,10 @@ public:
 
   bool isRunning() const { return running; }
 
+  //! install a function every thread calls when it finishes its part of a
+  //! run, before the run is considered complete
+  void setEndOfRunHook(void (*hook)()) { endOfRunHook = hook; }
+
   //! return the number of non-reserved threads in the pool
   unsigned getMaxUsableThreads() const { return mi.maxThreads - reserved; }
   //! return the number of threads supported by the thread pool on the current
@@ -174,6 +183,7 @@ public:
   unsigned getMaxCores() const { return mi.maxCores; }
   unsigned getMaxSockets() const { return mi.maxSockets; }
   unsigned getMaxNumaNodes() const { return mi.maxNumaNodes; }
+  unsigned getMaxL3Domains() const { return mi.maxL3Domains; }
 
   unsigned getLeaderForSocket(unsigned pid) const {
     for (unsigned i = 0; i < getMaxThreads(); ++i)
@@ -182,6 +192,24 @@ public:
     abort();
   }
 
+  //! ids of the threads of a socket in increasing order; they are not
+  //! contiguous since SMT siblings are numbered after all cores
+  const std::vector<unsigned>& getSocketThreads(unsigned socket) const {
+    return socketThreads[socket];
+  }
+
+  //! the other threads in tid's L3 domain, going around in a circle from
+  //! tid + 1
+  const std::vector<unsigned>& getL3Peers(unsigned tid) const {
+    return l3Peers[tid];
+  }
+
+  //! the threads of tid's socket outside its L3 domain, going around in a
+  //! circle from tid + 1
+  const std::vector<unsigned>& getSocketPeers(unsigned tid) const {
+    return socketPeers[tid];
+  }
+
   bool isLeader(unsigned tid) const {
     return signals[tid]->topo.socketLeader == tid;
   }
@@ -195,6 +223,15 @@ public:
   unsigned getNumaNode(unsigned tid) const {
     return signals[tid]->topo.numaNode;
   }
+  unsigned getCoreLeader(unsigned tid) const {
+    return signals[tid]->topo.coreLeader;
+  }
+  unsigned getL3Domain(unsigned tid) const {
+    return signals[tid]->topo.l3Domain;
+  }
+  unsigned getL3Leader(unsigned tid) const {
+    return signals[tid]->topo.l3Leader;
+  }
 
   static unsigned getTID() { return my_box.topo.tid; }
   static bool isLeader() { return my_box.topo.tid == my_box.topo.socketLeader; }
@@ -204,6 +241,8 @@ public:
     return my_box.topo.cumulativeMaxSocket;
   }
   static unsigned getNumaNode() { return my_box.topo.numaNode; }
+  static unsigned getL3Domain() { return my_box.topo.l3Domain; }
+  static unsigned getL3Leader() { return my_box.topo.l3Leader; }
 };
 
 namespace internal {
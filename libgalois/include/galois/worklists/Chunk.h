@@ -53,21 +53,58 @@ struct squeue<false, PS, TQ> {
   int size() { return 0; }
 };
 
+//! Granularity at which a chunked worklist shares its queues
+enum class ChunkDist { GLOBAL, SOCKET, L3 };
+
+/**
+ * Shared queues of a chunked worklist. Queue i is the one used by thread i;
+ * threads of the same domain share a queue, which lives with the domain
+ * leader returned by owner(i).
+ */
+template <ChunkDist D, typename TQ>
+struct dqueue;
+
+template <typename TQ>
+struct dqueue<ChunkDist::GLOBAL, TQ>
+    : public squeue<false, substrate::PerThreadStorage, TQ> {
+  unsigned owner(int i) const { return 0; }
+};
+
+template <typename TQ>
+struct dqueue<ChunkDist::SOCKET, TQ>
+    : public squeue<true, substrate::PerSocketStorage, TQ> {
+  unsigned owner(int i) const {
+    return substrate::getThreadPool().getLeader(i);
+  }
+};
+
+template <typename TQ>
+struct dqueue<ChunkDist::L3, TQ> {
+  substrate::PerThreadStorage<TQ> queues; // used on L3 leaders
+  TQ& get(int i) { return *queues.getRemote(owner(i)); }
+  TQ& get() {
+    return *queues.getRemote(substrate::ThreadPool::getL3Leader());
+  }
+  int myEffectiveID() { return substrate::ThreadPool::getTID(); }
+  int size() { return runtime::activeThreads; }
+  unsigned owner(int i) const {
+    return substrate::getThreadPool().getL3Leader(i);
+  }
+};
+
 //! Common functionality to all chunked worklists
-template <typename T, template <typename, bool> class QT, bool Distributed,
+template <typename T, template <typename, bool> class QT, ChunkDist Dist,
           bool IsStack, int ChunkSize, bool Concurrent>
 struct ChunkMaster : private boost::noncopyable {
   template <typename _T>
-  using retype =
-      ChunkMaster<_T, QT, Distributed, IsStack, ChunkSize, Concurrent>;
+  using retype = ChunkMaster<_T, QT, Dist, IsStack, ChunkSize, Concurrent>;
 
   template <int _chunk_size>
   using with_chunk_size =
-      ChunkMaster<T, QT, Distributed, IsStack, _chunk_size, Concurrent>;
+      ChunkMaster<T, QT, Dist, IsStack, _chunk_size, Concurrent>;
 
   template <bool _Concurrent>
-  using rethread =
-      ChunkMaster<T, QT, Distributed, IsStack, ChunkSize, _Concurrent>;
+  using rethread = ChunkMaster<T, QT, Dist, IsStack, ChunkSize, _Concurrent>;
 
 private:
   class Chunk : public FixedSizeRing<T, ChunkSize>,
@@ -84,7 +121,7 @@ private:
   typedef QT<Chunk, Concurrent> LevelItem;
 
   squeue<Concurrent, substrate::PerThreadStorage, p> data;
-  squeue<Distributed, substrate::PerSocketStorage, LevelItem> Q;
+  dqueue<Dist, LevelItem> Q;
 
   Chunk* mkChunk() {
     Chunk* ptr = alloc.allocate(1);
@@ -107,22 +144,38 @@ private:
     return I.pop();
   }
 
+  //! Pops from queue i if i owns a queue other than mine on the requested
+  //! side of the socket boundary
+  Chunk* popChunkFromOwner(int i, unsigned mine, bool local) {
+    auto& tp = substrate::getThreadPool();
+    if ((unsigned)i != Q.owner(i) || (unsigned)i == mine)
+      return 0;
+    if ((tp.getSocket(i) == substrate::ThreadPool::getSocket()) != local)
+      return 0;
+    return popChunkByID(i);
+  }
+
   Chunk* popChunk() {
     int id   = Q.myEffectiveID();
     Chunk* r = popChunkByID(id);
     if (r)
       return r;
 
-    for (int i = id + 1; i < (int)Q.size(); ++i) {
-      r = popChunkByID(i);
-      if (r)
-        return r;
-    }
+    // steal from the other queues of this socket first, then from the
+    // queues of the other sockets
+    const unsigned mine = Q.owner(id);
+    for (bool local : {true, false}) {
+      for (int i = id + 1; i < (int)Q.size(); ++i) {
+        r = popChunkFromOwner(i, mine, local);
+        if (r)
+          return r;
+      }
 
-    for (int i = 0; i < id; ++i) {
-      r = popChunkByID(i);
-      if (r)
-        return r;
+      for (int i = 0; i < id; ++i) {
+        r = popChunkFromOwner(i, mine, local);
+        if (r)
+          return r;
+      }
     }
 
     return 0;
@@ -269,8 +322,9 @@ public:
  * @tparam ChunkSize chunk size
  */
 template <int ChunkSize = 64, typename T = int, bool Concurrent = true>
-using ChunkFIFO = internal::ChunkMaster<T, ConExtLinkedQueue, false, false,
-                                        ChunkSize, Concurrent>;
+using ChunkFIFO =
+    internal::ChunkMaster<T, ConExtLinkedQueue, internal::ChunkDist::GLOBAL,
+                          false, ChunkSize, Concurrent>;
 GALOIS_WLCOMPILECHECK(ChunkFIFO)
 
 /**
@@ -279,8 +333,9 @@ GALOIS_WLCOMPILECHECK(ChunkFIFO)
  * @tparam ChunkSize chunk size
  */
 template <int ChunkSize = 64, typename T = int, bool Concurrent = true>
-using ChunkLIFO = internal::ChunkMaster<T, ConExtLinkedStack, false, true,
-                                        ChunkSize, Concurrent>;
+using ChunkLIFO =
+    internal::ChunkMaster<T, ConExtLinkedStack, internal::ChunkDist::GLOBAL,
+                          true, ChunkSize, Concurrent>;
 GALOIS_WLCOMPILECHECK(ChunkLIFO)
 
 /**
@@ -289,18 +344,33 @@ GALOIS_WLCOMPILECHECK(ChunkLIFO)
  * @tparam ChunkSize chunk size
  */
 template <int ChunkSize = 64, typename T = int, bool Concurrent = true>
-using PerSocketChunkFIFO = internal::ChunkMaster<T, ConExtLinkedQueue, true,
-                                                 false, ChunkSize, Concurrent>;
+using PerSocketChunkFIFO =
+    internal::ChunkMaster<T, ConExtLinkedQueue, internal::ChunkDist::SOCKET,
+                          false, ChunkSize, Concurrent>;
 GALOIS_WLCOMPILECHECK(PerSocketChunkFIFO)
 
+/**
+ * Distributed chunked FIFO with one queue per L3 cache domain. Threads steal
+ * from the other L3 domains of their socket before crossing sockets. Same as
+ * {@link PerSocketChunkFIFO} when L3 domains are not known.
+ *
+ * @tparam ChunkSize chunk size
+ */
+template <int ChunkSize = 64, typename T = int, bool Concurrent = true>
+using PerL3ChunkFIFO =
+    internal::ChunkMaster<T, ConExtLinkedQueue, internal::ChunkDist::L3,
+                          false, ChunkSize, Concurrent>;
+GALOIS_WLCOMPILECHECK(PerL3ChunkFIFO)
+
 /**
  * Distributed chunked LIFO. A more scalable version of {@link ChunkLIFO}.
  *
  * @tparam chunksize chunk size
  */
 template <int ChunkSize = 64, typename T = int, bool Concurrent = true>
-using PerSocketChunkLIFO = internal::ChunkMaster<T, ConExtLinkedStack, true,
-                                                 true, ChunkSize, Concurrent>;
+using PerSocketChunkLIFO =
+    internal::ChunkMaster<T, ConExtLinkedStack, internal::ChunkDist::SOCKET,
+                          true, ChunkSize, Concurrent>;
 GALOIS_WLCOMPILECHECK(PerSocketChunkLIFO)
 
 /**
@@ -310,8 +380,9 @@ GALOIS_WLCOMPILECHECK(PerSocketChunkLIFO)
  * @tparam chunksize chunk size
  */
 template <int ChunkSize = 64, typename T = int, bool Concurrent = true>
-using PerSocketChunkBag = internal::ChunkMaster<T, ConExtLinkedQueue, true,
-                                                true, ChunkSize, Concurrent>;
+using PerSocketChunkBag =
+    internal::ChunkMaster<T, ConExtLinkedQueue, internal::ChunkDist::SOCKET,
+                          true, ChunkSize, Concurrent>;
 GALOIS_WLCOMPILECHECK(PerSocketChunkBag)
 
 } // end namespace worklists
@@ -251,21 +251,19 @@ class StealingQueue : private boost::noncopyable {
     auto& tp                         = substrate::getThreadPool();
     unsigned id                      = tp.getTID();
     unsigned pkg                     = substrate::ThreadPool::getSocket();
+    unsigned l3                      = substrate::ThreadPool::getL3Domain();
     unsigned num                     = galois::getActiveThreads();
 
-    // First steal from this socket
-    for (unsigned eid = id + 1; eid < num; ++eid) {
-      if (tp.getSocket(eid) == pkg) {
-        ChunkHeader* c = me.first.stealHalfAndPop(local.getRemote(eid)->first);
-        if (c)
-          return c;
-      }
-    }
-    for (unsigned eid = 0; eid < id; ++eid) {
-      if (tp.getSocket(eid) == pkg) {
-        ChunkHeader* c = me.first.stealHalfAndPop(local.getRemote(eid)->first);
-        if (c)
-          return c;
+    // First steal from this L3 domain, then from the rest of this socket
+    for (bool sameL3 : {true, false}) {
+      for (unsigned i = 1; i < num; ++i) {
+        unsigned eid = (id + i) % num;
+        if (tp.getSocket(eid) == pkg && (tp.getL3Domain(eid) == l3) == sameL3) {
+          ChunkHeader* c =
+              me.first.stealHalfAndPop(local.getRemote(eid)->first);
+          if (c)
+            return c;
+        }
       }
     }
 
@@ -22,4 +22,8 @@
 galois::SharedMemSys::SharedMemSys(void)
     : galois::runtime::SharedMemRuntime<galois::runtime::StatManager>() {}
 
+galois::SharedMemSys::SharedMemSys(galois::substrate::PagePolicy policy)
+    : galois::runtime::SharedMemRuntime<galois::runtime::StatManager>(policy) {
+}
+
 galois::SharedMemSys::~SharedMemSys(void) {}
@@ -29,6 +29,7 @@
 #include <fstream>
 #include <functional>
 #include <set>
+#include <string>
 
 #ifdef GALOIS_USE_NUMA
 #include <numa.h>
@@ -49,6 +50,7 @@ struct cpuinfo {
   unsigned coreid;
   unsigned cpucores;
   unsigned numaNode; // from libnuma
+  unsigned l3;       // first cpu sharing the L3, from sysfs
   bool valid;        // from cpuset
   bool smt;          // computed
 };
@@ -91,6 +93,29 @@ static unsigned getNumaNode(cpuinfo& c) {
 #endif
 }
 
+//! Returns the first cpu sharing proc's L3 cache or ~0U if sysfs does not say
+static unsigned getL3(unsigned proc) {
+  std::string base("/sys/devices/system/cpu/cpu");
+  base += std::to_string(proc);
+  base += "/cache/index";
+  for (unsigned idx = 0;; ++idx) {
+    std::string dir = base + std::to_string(idx);
+    std::ifstream levelFile(dir + "/level");
+    if (!levelFile)
+      return ~0U;
+    unsigned level = 0;
+    levelFile >> level;
+    if (level != 3)
+      continue;
+    // shared_cpu_list is sorted, e.g. "0-7,64-71"
+    std::ifstream shared(dir + "/shared_cpu_list");
+    unsigned first;
+    if (shared >> first)
+      return first;
+    return ~0U;
+  }
+}
+
 //! Parse /proc/cpuinfo
 static std::vector<cpuinfo> parseCPUInfo() {
   std::vector<cpuinfo> vals;
@@ -126,8 +151,10 @@ static std::vector<cpuinfo> parseCPUInfo() {
     }
   }
 
-  for (auto& c : vals)
+  for (auto& c : vals) {
     c.numaNode = getNumaNode(c);
+    c.l3       = getL3(c.proc);
+  }
 
   return vals;
 }
@@ -203,6 +230,13 @@ static unsigned countCores(const std::vector<cpuinfo>& info) {
   return cores.size();
 }
 
+static unsigned countL3Domains(const std::vector<cpuinfo>& info) {
+  std::set<std::pair<unsigned, unsigned>> domains;
+  for (auto& c : info)
+    domains.insert(std::make_pair(c.physid, c.l3));
+  return domains.size();
+}
+
 static unsigned countNumaNodes(const std::vector<cpuinfo>& info) {
   std::set<unsigned> nodes;
   for (auto& c : info)
@@ -262,15 +296,19 @@ galois::substrate::getHWTopo() {
   retMTI.maxThreads   = info.size();
   retMTI.maxCores     = countCores(info);
   retMTI.maxNumaNodes = countNumaNodes(info);
+  retMTI.maxL3Domains = countL3Domains(info);
 
   std::vector<threadTopoInfo> retTTI;
   retTTI.reserve(retMTI.maxThreads);
   // compute renumberings
   std::set<unsigned> sockets;
   std::set<unsigned> numaNodes;
+  // L3 domains are identified by socket and first cpu sharing the cache
+  std::set<std::pair<unsigned, unsigned>> l3s;
   for (auto& i : info) {
     sockets.insert(i.physid);
     numaNodes.insert(i.numaNode);
+    l3s.insert(std::make_pair(i.physid, i.l3));
   }
   unsigned mid = 0; // max socket id
   for (unsigned i = 0; i < info.size(); ++i) {
@@ -282,11 +320,26 @@ galois::substrate::getHWTopo() {
         info.begin(),
         std::find_if(info.begin(), info.end(),
                      [pid](const cpuinfo& c) { return c.physid == pid; }));
+    unsigned cid        = info[i].coreid;
+    unsigned coreLeader = std::distance(
+        info.begin(), std::find_if(info.begin(), info.end(),
+                                   [pid, cid](const cpuinfo& c) {
+                                     return c.physid == pid && c.coreid == cid;
+                                   }));
+    unsigned l3       = info[i].l3;
+    unsigned l3Leader = std::distance(
+        info.begin(), std::find_if(info.begin(), info.end(),
+                                   [pid, l3](const cpuinfo& c) {
+                                     return c.physid == pid && c.l3 == l3;
+                                   }));
+    unsigned l3Domain =
+        std::distance(l3s.begin(), l3s.find(std::make_pair(pid, l3)));
     retTTI.push_back(
         threadTopoInfo{i, leader, repid,
                        (unsigned)std::distance(
                            numaNodes.begin(), numaNodes.find(info[i].numaNode)),
-                       mid, info[i].proc, info[i].numaNode});
+                       mid, info[i].proc, info[i].numaNode, coreLeader,
+                       l3Domain, l3Leader});
   }
 
   return std::make_pair(retMTI, retTTI);
@@ -29,6 +29,145 @@ SystemHeap::SystemHeap() { assert(AllocSize == runtime::pagePoolSize()); }
 
 SystemHeap::~SystemHeap() {}
 
+// SlabHeaps in which the current thread holds objects to return to other
+// threads
+static thread_local std::vector<SlabHeap*>* dirtyHeaps = nullptr;
+
+SlabHeap::SlabHeap(size_t size) {
+  static_assert(sizeof(Slab) <= HeaderSize, "slab header too large");
+  static_assert(sizeof(ThreadState) >= 64, "ThreadState not padded");
+  // same alignment as BumpHeap
+  objSize = (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+  if (objSize < sizeof(FreeNode))
+    objSize = sizeof(FreeNode);
+  if (objSize > SlabSize - HeaderSize)
+    throw std::bad_alloc();
+  slabBytes = HeaderSize + (SlabSize - HeaderSize) / objSize * objSize;
+}
+
+void SlabHeap::refill(ThreadState& st) {
+  // First try to get back what this thread freed for others; they may be
+  // waiting on those objects too
+  if (st.pending)
+    flushBatches(st);
+
+  void* page = pagePoolAlloc();
+  if (((uintptr_t)page & (SlabSize - 1)) != 0)
+    GALOIS_DIE("page pool returned unaligned page");
+  Slab* s    = new (page) Slab();
+  s->free    = nullptr;
+  s->bump    = (char*)s + HeaderSize;
+  s->owner   = substrate::ThreadPool::getTID();
+  s->live    = 0;
+  s->prevAll = nullptr;
+  s->nextAll = st.all;
+  if (st.all)
+    st.all->prevAll = s;
+  st.all = s;
+  linkPartial(st, s);
+  st.freeBytes += slabBytes - HeaderSize;
+}
+
+bool SlabHeap::drainReturned(ThreadState& st) {
+  FreeNode* n = st.returned.exchange(nullptr, std::memory_order_acquire);
+  if (!n)
+    return false;
+  while (n) {
+    FreeNode* next = n->next;
+    release(st, slabOf(n), n);
+    n = next;
+  }
+  return true;
+}
+
+void SlabHeap::releaseSlab(ThreadState& st, Slab* s) {
+  assert(s->live == 0 && s->listed);
+  unlinkPartial(st, s);
+  if (s->prevAll)
+    s->prevAll->nextAll = s->nextAll;
+  else
+    st.all = s->nextAll;
+  if (s->nextAll)
+    s->nextAll->prevAll = s->prevAll;
+  st.freeBytes -= slabBytes - HeaderSize;
+  pagePoolFree(s);
+}
+
+void SlabHeap::returnRemote(ThreadState& st, unsigned owner, FreeNode* n) {
+  if (st.batches.empty())
+    st.batches.resize(states.size(), Batch{nullptr, nullptr, 0});
+  Batch& b = st.batches[owner];
+  if (!b.count) {
+    b.tail = n;
+    ++st.pending;
+    if (!st.dirty) {
+      if (!dirtyHeaps)
+        dirtyHeaps = new std::vector<SlabHeap*>();
+      dirtyHeaps->push_back(this);
+      st.dirty = true;
+    }
+  }
+  n->next = b.head;
+  b.head  = n;
+  if (++b.count < BatchSize)
+    return;
+
+  ThreadState& ost = *states.getRemote(owner);
+  FreeNode* old    = ost.returned.load(std::memory_order_relaxed);
+  do {
+    b.tail->next = old;
+  } while (!ost.returned.compare_exchange_weak(
+      old, b.head, std::memory_order_release, std::memory_order_relaxed));
+  b = Batch{nullptr, nullptr, 0};
+  --st.pending;
+}
+
+void SlabHeap::flushBatches(ThreadState& st) {
+  for (unsigned owner = 0; owner < st.batches.size() && st.pending; ++owner) {
+    Batch& b = st.batches[owner];
+    if (!b.count)
+      continue;
+    ThreadState& ost = *states.getRemote(owner);
+    FreeNode* old    = ost.returned.load(std::memory_order_relaxed);
+    do {
+      b.tail->next = old;
+    } while (!ost.returned.compare_exchange_weak(
+        old, b.head, std::memory_order_release, std::memory_order_relaxed));
+    b = Batch{nullptr, nullptr, 0};
+    --st.pending;
+  }
+}
+
+void SlabHeap::flushReturns() {
+  if (!dirtyHeaps)
+    return;
+  for (SlabHeap* heap : *dirtyHeaps) {
+    ThreadState& st = *heap->states.getLocal();
+    if (st.pending)
+      heap->flushBatches(st);
+    st.dirty = false;
+  }
+  dirtyHeaps->clear();
+}
+
+void SlabHeap::clear() {
+  for (unsigned i = 0; i < states.size(); ++i) {
+    ThreadState& st = *states.getRemote(i);
+    while (st.all) {
+      Slab* s = st.all;
+      st.all  = s->nextAll;
+      pagePoolFree(s);
+    }
+    st.partial = nullptr;
+    st.returned.store(nullptr, std::memory_order_relaxed);
+    st.freeBytes = 0;
+    for (auto& b : st.batches)
+      b = Batch{nullptr, nullptr, 0};
+    st.pending = 0;
+    st.dirty   = false;
+  }
+}
+
 #ifndef GALOIS_FORCE_STANDALONE
 thread_local SizedHeapFactory::HeapMap* SizedHeapFactory::localHeaps = 0;
 
@@ -56,7 +195,7 @@ SizedHeapFactory::SizedHeap* SizedHeapFactory::getHeap(const size_t size) {
     std::lock_guard<galois::substrate::SimpleLock> ll(lock);
     auto& gentry = heaps[size];
     if (!gentry)
-      gentry = new SizedHeap();
+      gentry = new SizedHeap(size);
     lentry = gentry;
     return lentry;
   }
@@ -155,8 +155,8 @@ static size_t roundup(size_t data, size_t mult) {
 
 LAptr galois::substrate::largeMallocInterleaved(size_t bytes,
                                                 unsigned numThreads) {
-  // round up to hugePageSize
-  bytes = roundup(bytes, allocSize());
+  // round up to the page size of the current page policy
+  bytes = roundup(bytes, allocSizeFor(bytes));
 
 #ifdef GALOIS_USE_NUMA
   // We don't use numa_alloc_interleaved_subset because we really want huge
@@ -176,24 +176,24 @@ LAptr galois::substrate::largeMallocInterleaved(size_t bytes,
 }
 
 LAptr galois::substrate::largeMallocLocal(size_t bytes) {
-  // round up to hugePageSize
-  bytes = roundup(bytes, allocSize());
+  // round up to the page size of the current page policy
+  bytes = roundup(bytes, allocSizeFor(bytes));
   // Get a prefaulted allocation
   return LAptr{allocPages(bytes / allocSize(), true),
                internal::largeFreer{bytes}};
 }
 
 LAptr galois::substrate::largeMallocFloating(size_t bytes) {
-  // round up to hugePageSize
-  bytes = roundup(bytes, allocSize());
+  // round up to the page size of the current page policy
+  bytes = roundup(bytes, allocSizeFor(bytes));
   // Get a non-prefaulted allocation
   return LAptr{allocPages(bytes / allocSize(), false),
                internal::largeFreer{bytes}};
 }
 
 LAptr galois::substrate::largeMallocBlocked(size_t bytes, unsigned numThreads) {
-  // round up to hugePageSize
-  bytes = roundup(bytes, allocSize());
+  // round up to the page size of the current page policy
+  bytes = roundup(bytes, allocSizeFor(bytes));
   // Get a non-prefaulted allocation
   void* data = allocPages(bytes / allocSize(), false);
   if (data)
@@ -220,7 +220,7 @@ LAptr galois::substrate::largeMallocSpecified(size_t bytes, uint32_t numThreads,
                                               RangeArrayTy& threadRanges,
                                               size_t elementSize) {
   // ceiling to nearest page
-  bytes = roundup(bytes, allocSize());
+  bytes = roundup(bytes, allocSizeFor(bytes));
 
   void* data = allocPages(bytes / allocSize(), false);
 
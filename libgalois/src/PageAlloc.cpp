@@ -19,8 +19,12 @@
 
 #include "galois/substrate/PageAlloc.h"
 #include "galois/substrate/SimpleLock.h"
+#include "galois/substrate/EnvCheck.h"
 #include "galois/gIO.h"
 
+#include <atomic>
+#include <cstring>
+#include <strings.h>
 #include <mutex>
 
 #ifdef __linux__
@@ -30,6 +34,7 @@
 
 // figure this out dynamically
 const size_t hugePageSize = 2 * 1024 * 1024;
+const size_t gigaPageSize = 1024 * 1024 * 1024;
 // protect mmap, munmap since linux has issues
 static galois::substrate::SimpleLock allocLock;
 
@@ -61,33 +66,186 @@ static const bool doHandMap    = true;
 #ifdef MAP_HUGETLB
 static const int _MAP_HUGE_POP = MAP_HUGETLB | _MAP_POP;
 static const int _MAP_HUGE     = MAP_HUGETLB | _MAP;
+static const bool haveHuge     = true;
 #else
 static const int _MAP_HUGE_POP = _MAP_POP;
 static const int _MAP_HUGE     = _MAP;
+static const bool haveHuge     = false;
 #endif
+// explicit hugetlbfs page sizes; 0 if the size cannot be requested
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_2MB)
+static const int _MAP_HUGE_2MB = MAP_HUGE_2MB;
+#else
+static const int _MAP_HUGE_2MB = 0;
+#endif
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_1GB)
+static const int _MAP_HUGE_1GB = MAP_HUGE_1GB;
+#else
+static const int _MAP_HUGE_1GB = 0;
+#endif
+
+using galois::substrate::PageKind;
+using galois::substrate::PagePolicy;
+
+// -1 until read from the environment
+static std::atomic<int> pagePolicy(-1);
+static std::atomic<size_t> pageBytes[galois::substrate::NUM_PAGE_KINDS];
+static std::atomic<size_t> pageFallbacks(0);
+
+bool galois::substrate::parsePagePolicy(const char* name, PagePolicy& p) {
+  static const struct {
+    const char* name;
+    PagePolicy policy;
+  } names[] = {{"default", PagePolicy::DEFAULT}, {"normal", PagePolicy::NORMAL},
+               {"thp", PagePolicy::THP},         {"2m", PagePolicy::HUGE_2M},
+               {"1g", PagePolicy::HUGE_1G}};
+  for (auto& n : names) {
+    if (strcasecmp(name, n.name) == 0) {
+      p = n.policy;
+      return true;
+    }
+  }
+  return false;
+}
+
+void galois::substrate::setPagePolicy(PagePolicy p) {
+  pagePolicy.store(static_cast<int>(p), std::memory_order_relaxed);
+}
+
+PagePolicy galois::substrate::getPagePolicy() {
+  int p = pagePolicy.load(std::memory_order_relaxed);
+  if (p >= 0)
+    return static_cast<PagePolicy>(p);
+
+  PagePolicy policy = PagePolicy::DEFAULT;
+  std::string name;
+  if (EnvCheck("GALOIS_PAGE_POLICY", name) &&
+      !parsePagePolicy(name.c_str(), policy))
+    gWarn("unknown GALOIS_PAGE_POLICY ", name, ", using default");
+  // a concurrent setPagePolicy wins over the environment
+  int expected = -1;
+  pagePolicy.compare_exchange_strong(expected, static_cast<int>(policy),
+                                     std::memory_order_relaxed);
+  return static_cast<PagePolicy>(pagePolicy.load(std::memory_order_relaxed));
+}
+
+size_t galois::substrate::numPageBytes(PageKind k) { return pageBytes[k]; }
+
+size_t galois::substrate::numPageFallbacks() { return pageFallbacks; }
+
+const char* galois::substrate::pageKindName(PageKind k) {
+  switch (k) {
+  case PAGE_NORMAL:
+    return "Normal";
+  case PAGE_THP:
+    return "THP";
+  case PAGE_HUGE_2M:
+    return "Huge2M";
+  case PAGE_HUGE_1G:
+    return "Huge1G";
+  default:
+    return "Unknown";
+  }
+}
 
 size_t galois::substrate::allocSize() { return hugePageSize; }
 
+size_t galois::substrate::allocSizeFor(size_t bytes) {
+  // only take 1 GB pages when rounding up wastes at most an eighth of the
+  // allocation
+  if (_MAP_HUGE_1GB && getPagePolicy() == PagePolicy::HUGE_1G &&
+      bytes >= gigaPageSize &&
+      (gigaPageSize - bytes % gigaPageSize) % gigaPageSize <= bytes / 8)
+    return gigaPageSize;
+  return hugePageSize;
+}
+
+static void* tryHuge(size_t bytes, int sizeFlag, bool preFault) {
+  void* ptr = trymmap(bytes, (preFault ? _MAP_HUGE_POP : _MAP_HUGE) | sizeFlag);
+  if (ptr && preFault && doHandMap)
+    for (size_t x = 0; x < bytes; x += 4096)
+      static_cast<char*>(ptr)[x] = 0;
+  return ptr;
+}
+
+// Regular pages, aligned to hugePageSize as hugetlbfs pages would be;
+// allocators rely on this to find page headers
+static void* tryRegular(size_t bytes, PagePolicy policy, bool preFault) {
+  // Over-allocate and trim
+  char* raw = static_cast<char*>(trymmap(bytes + hugePageSize, _MAP));
+  if (!raw)
+    return nullptr;
+  size_t lead =
+      (hugePageSize - reinterpret_cast<uintptr_t>(raw) % hugePageSize) %
+      hugePageSize;
+  {
+    std::lock_guard<galois::substrate::SimpleLock> lg(allocLock);
+    if (lead)
+      munmap(raw, lead);
+    munmap(raw + lead + bytes, hugePageSize - lead);
+  }
+  char* ptr = raw + lead;
+
+#ifdef MADV_HUGEPAGE
+  // DEFAULT keeps whatever the system THP setting gives
+  if (policy == PagePolicy::NORMAL)
+    madvise(ptr, bytes, MADV_NOHUGEPAGE);
+  else if (policy != PagePolicy::DEFAULT)
+    madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+
+  // fault in by hand so that THP advice is in effect
+  if (preFault)
+    for (size_t x = 0; x < bytes; x += 4096)
+      ptr[x] = 0;
+  return ptr;
+}
+
 void* galois::substrate::allocPages(unsigned num, bool preFault) {
-  if (num > 0) {
-    void* ptr =
-        trymmap(num * hugePageSize, preFault ? _MAP_HUGE_POP : _MAP_HUGE);
-    if (!ptr) {
+  if (num == 0)
+    return nullptr;
+
+  const size_t bytes = num * hugePageSize;
+  PagePolicy policy  = getPagePolicy();
+  void* ptr          = nullptr;
+  PageKind kind      = PAGE_NORMAL;
+
+  if (policy == PagePolicy::HUGE_1G && bytes % gigaPageSize == 0) {
+    if (_MAP_HUGE_1GB)
+      ptr = tryHuge(bytes, _MAP_HUGE_1GB, preFault);
+    if (ptr)
+      kind = PAGE_HUGE_1G;
+    else
+      ++pageFallbacks;
+  }
+
+  if (!ptr && haveHuge && policy != PagePolicy::NORMAL &&
+      policy != PagePolicy::THP) {
+    ptr = tryHuge(bytes, policy == PagePolicy::DEFAULT ? 0 : _MAP_HUGE_2MB,
+                  preFault);
+    if (ptr) {
+      kind = PAGE_HUGE_2M;
+    } else {
       gDebug("Huge page alloc failed, falling back");
-      ptr = trymmap(num * hugePageSize, preFault ? _MAP_POP : _MAP);
+      if (policy != PagePolicy::DEFAULT)
+        ++pageFallbacks;
     }
+  }
 
-    if (!ptr)
-      GALOIS_SYS_DIE("Out of Memory");
+  if (!ptr) {
+    // explicit huge page policies fall back to THP
+    if (policy == PagePolicy::NORMAL || policy == PagePolicy::DEFAULT)
+      kind = PAGE_NORMAL;
+    else
+      kind = PAGE_THP;
+    ptr = tryRegular(bytes, policy, preFault);
+  }
 
-    if (preFault && doHandMap)
-      for (size_t x = 0; x < num * hugePageSize; x += 4096)
-        static_cast<char*>(ptr)[x] = 0;
+  if (!ptr)
+    GALOIS_SYS_DIE("Out of Memory");
 
-    return ptr;
-  } else {
-    return nullptr;
-  }
+  pageBytes[kind] += bytes;
+  return ptr;
 }
 
 void galois::substrate::freePages(void* ptr, unsigned num) {
@@ -18,9 +18,12 @@
  */
 
 #include "galois/substrate/PerThreadStorage.h"
+#include "galois/substrate/CompilerSpecific.h"
+#include "galois/substrate/PageAlloc.h"
 
 //#include "galois/runtime/Mem.h"
 #include "galois/gIO.h"
+#include <algorithm>
 #include <mutex>
 
 thread_local char* galois::substrate::ptsBase;
@@ -37,17 +40,17 @@ galois::substrate::PerBackend& galois::substrate::getPPSBackend() {
   return b;
 }
 
-#define MORE_MEM_HACK
-#ifdef MORE_MEM_HACK
-const size_t allocSize =
-    16 * (2 << 20); // galois::runtime::MM::hugePageSize * 16;
-inline void* alloc() { return malloc(allocSize); }
-
-#else
-const size_t allocSize = galois::runtime::MM::hugePageSize;
-inline void* alloc() { return galois::substrate::MM::pageAlloc(); }
-#endif
-#undef MORE_MEM_HACK
+// 32 MB per thread. Under the default page policy this comes from malloc as
+// it always has, so that per-thread storage does not eat into reserved
+// hugetlbfs pages; an explicitly chosen policy applies here too.
+const size_t blockSize = 16 * (2 << 20);
+inline void* alloc() {
+  if (galois::substrate::getPagePolicy() ==
+      galois::substrate::PagePolicy::DEFAULT)
+    return aligned_alloc(GALOIS_CACHE_LINE_SIZE, blockSize);
+  return galois::substrate::allocPages(
+      blockSize / galois::substrate::allocSize(), false);
+}
 
 unsigned galois::substrate::PerBackend::nextLog2(unsigned size) {
   unsigned i = MIN_SIZE;
@@ -61,14 +64,28 @@ unsigned galois::substrate::PerBackend::nextLog2(unsigned size) {
 }
 
 unsigned galois::substrate::PerBackend::allocOffset(const unsigned sz) {
-  unsigned retval = allocSize;
+  unsigned retval = blockSize;
   unsigned ll     = nextLog2(sz);
   unsigned size   = (1 << ll);
 
-  if ((nextLoc + size) <= allocSize) {
+  // align to the size of the allocation (up to a cache line) so that types
+  // with extended alignment, which the compiler may access with aligned
+  // vector instructions, end up properly aligned
+  unsigned align = std::min(size, (unsigned)GALOIS_CACHE_LINE_SIZE);
+  unsigned cur   = nextLoc;
+  unsigned start = (cur + align - 1) & ~(align - 1);
+
+  while (start + size <= blockSize) {
     // simple path, where we allocate bump ptr style
-    retval = __sync_fetch_and_add(&nextLoc, size);
-  } else if (!invalid) {
+    if (__sync_bool_compare_and_swap(&nextLoc, cur, start + size)) {
+      retval = start;
+      break;
+    }
+    cur   = nextLoc;
+    start = (cur + align - 1) & ~(align - 1);
+  }
+
+  if (retval == blockSize && !invalid) {
     // find a free offset
     std::lock_guard<Lock> llock(freeOffsetsLock);
 
@@ -90,18 +107,15 @@ unsigned galois::substrate::PerBackend::allocOffset(const unsigned sz) {
         retval = freeOffsets[index].back();
         freeOffsets[index].pop_back();
 
-        // remaining chunk
-        unsigned end   = retval + (1 << index);
-        unsigned start = retval + size;
-        for (unsigned i = index - 1; start < end; --i) {
-          freeOffsets[i].push_back(start);
-          start += (1 << i);
-        }
+        // remaining chunk, split buddy style so every piece stays aligned to
+        // its size
+        for (unsigned i = ll; i < index; ++i)
+          freeOffsets[i].push_back(retval + (1 << i));
       }
     }
   }
 
-  assert(retval != allocSize);
+  assert(retval != blockSize);
 
   return retval;
 }
@@ -137,7 +151,7 @@ void galois::substrate::PerBackend::initCommon(unsigned maxT) {
 char* galois::substrate::PerBackend::initPerThread(unsigned maxT) {
   initCommon(maxT);
   char* b = heads[ThreadPool::getTID()] = (char*)alloc();
-  memset(b, 0, allocSize);
+  memset(b, 0, blockSize);
   return b;
 }
 
@@ -147,7 +161,7 @@ char* galois::substrate::PerBackend::initPerSocket(unsigned maxT) {
   unsigned leader = ThreadPool::getLeader();
   if (id == leader) {
     char* b = heads[id] = (char*)alloc();
-    memset(b, 0, allocSize);
+    memset(b, 0, blockSize);
     return b;
   } else {
     // wait for leader to fix up socket
@@ -19,6 +19,7 @@
 
 #include "galois/runtime/Statistics.h"
 #include "galois/runtime/Executor_OnEach.h"
+#include "galois/substrate/PageAlloc.h"
 
 #include <iostream>
 #include <fstream>
@@ -115,6 +116,17 @@ void galois::runtime::reportPageAlloc(const char* category) {
         reportStat_Tsum("PageAlloc", category, numPagePoolAllocForThread(tid));
       },
       std::make_tuple());
+
+  // MB obtained from the OS so far by the kind of page backing them
+  for (unsigned k = 0; k < substrate::NUM_PAGE_KINDS; ++k) {
+    auto kind = static_cast<substrate::PageKind>(k);
+    reportStat_Single("PageAlloc",
+                      Str(category) + "_" +
+                          substrate::pageKindName(kind) + "_MB",
+                      substrate::numPageBytes(kind) >> 20);
+  }
+  reportStat_Single("PageAlloc", Str(category) + "_PageFallbacks",
+                    substrate::numPageFallbacks());
 }
 
 void galois::runtime::reportNumaAlloc(const char* category) {
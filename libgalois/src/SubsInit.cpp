@@ -27,13 +27,17 @@
 
 using namespace galois::substrate;
 
-SharedMemSubstrate::SharedMemSubstrate(void) {
+SharedMemSubstrate::SharedMemSubstrate(void)
+    : SharedMemSubstrate(getPagePolicy()) {}
+
+SharedMemSubstrate::SharedMemSubstrate(PagePolicy policy)
+    : m_pagePolicy(policy) {
   internal::setThreadPool(&m_tpool);
 
   // delayed initialization because both call getThreadPool in constructor
   // which is valid only after setThreadPool() above
   m_biPtr   = new internal::BarrierInstance<>();
-  m_termPtr = new internal::LocalTerminationDetection<>();
+  m_termPtr = internal::createTermDetect();
 
   GALOIS_ASSERT(m_biPtr);
   GALOIS_ASSERT(m_termPtr);
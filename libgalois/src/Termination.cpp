@@ -19,12 +19,26 @@
 
 #include "galois/gIO.h"
 #include "galois/substrate/Termination.h"
+#include "galois/substrate/EnvCheck.h"
 
 // vtable anchoring
 galois::substrate::TerminationDetection::~TerminationDetection(void) {}
 
 static galois::substrate::TerminationDetection* TERM = nullptr;
 
+galois::substrate::TerminationDetection*
+galois::substrate::internal::createTermDetect() {
+  std::string kind;
+  if (!EnvCheck("GALOIS_TERM", kind) || kind == "ring")
+    return new LocalTerminationDetection<>();
+  if (kind == "tree")
+    return new TreeTerminationDetection<>();
+  if (kind == "topo")
+    return new TopoTerminationDetection<>();
+  gWarn("unknown GALOIS_TERM ", kind, ", using ring");
+  return new LocalTerminationDetection<>();
+}
+
 void galois::substrate::internal::setTermDetect(
     galois::substrate::TerminationDetection* t) {
   GALOIS_ASSERT(!(TERM && t), "Double initialization of TerminationDetection");
@@ -40,8 +40,24 @@ thread_local ThreadPool::per_signal ThreadPool::my_box;
 
 ThreadPool::ThreadPool()
     : mi(getHWTopo().first), reserved(0), masterFastmode(false),
-      running(false) {
+      running(false), endOfRunHook(nullptr) {
   signals.resize(mi.maxThreads);
+  auto topo = getHWTopo().second;
+  socketThreads.resize(mi.maxSockets);
+  for (auto& t : topo)
+    socketThreads[t.socket].push_back(t.tid);
+
+  l3Peers.resize(mi.maxThreads);
+  socketPeers.resize(mi.maxThreads);
+  for (auto& me : topo) {
+    for (unsigned i = 1; i < mi.maxThreads; ++i) {
+      auto& t = topo[(me.tid + i) % mi.maxThreads];
+      if (t.l3Domain == me.l3Domain)
+        l3Peers[me.tid].push_back(t.tid);
+      else if (t.socket == me.socket)
+        socketPeers[me.tid].push_back(t.tid);
+    }
+  }
   initThread(0);
 
   for (unsigned i = 1; i < mi.maxThreads; ++i) {
@@ -133,6 +149,8 @@ void ThreadPool::threadLoop(unsigned tid) {
     cascade(fastmode);
     try {
       work();
+      if (endOfRunHook)
+        endOfRunHook();
     } catch (const shutdown_ty&) {
       return;
     } catch (const fastmode_ty& fm) {
@@ -218,6 +236,8 @@ void ThreadPool::runInternal(unsigned num) {
   // Do master thread work
   try {
     work();
+    if (endOfRunHook)
+      endOfRunHook();
   } catch (const shutdown_ty&) {
     return;
   } catch (const fastmode_ty& fm) {
@@ -55,6 +55,11 @@ static cll::opt<unsigned int>
     reportNode("reportNode",
                cll::desc("Node to report distance to (default value 1)"),
                cll::init(1));
+static cll::opt<unsigned int> prefetchDist(
+    "prefetchDist",
+    cll::desc("Number of edges ahead to prefetch destination labels; 0 "
+              "disables prefetching (default value 0)"),
+    cll::init(0));
 // static cll::opt<unsigned int> stepShiftw("delta",
 // cll::desc("Shift value for the deltastep"),
 // cll::init(10));
@@ -360,28 +365,29 @@ void runAlgo(Graph& graph, const GNode& source) {
 
   switch (algo) {
   case AsyncTile:
-    asyncAlgo<CONCURRENT, SrcEdgeTile>(
-        graph, source, SrcEdgeTilePushWrap{graph}, TileRangeFn());
+    asyncAlgo<CONCURRENT, SrcEdgeTile>(graph, source,
+                                       SrcEdgeTilePushWrap{graph},
+                                       TileRangeFn{graph, prefetchDist});
     break;
   case Async:
     asyncAlgo<CONCURRENT, UpdateRequest>(graph, source, ReqPushWrap(),
-                                         OutEdgeRangeFn{graph});
+                                         OutEdgeRangeFn{graph, prefetchDist});
     break;
   case SyncTile:
     syncAlgo<CONCURRENT, EdgeTile>(graph, source, EdgeTilePushWrap{graph},
-                                   TileRangeFn());
+                                   TileRangeFn{graph, prefetchDist});
     break;
   case Sync:
     syncAlgo<CONCURRENT, GNode>(graph, source, NodePushWrap(),
-                                OutEdgeRangeFn{graph});
+                                OutEdgeRangeFn{graph, prefetchDist});
     break;
   case Sync2pTile:
     sync2phaseAlgo<CONCURRENT>(graph, source, EdgeTilePushWrap{graph},
-                               TileRangeFn());
+                               TileRangeFn{graph, prefetchDist});
     break;
   case Sync2p:
     sync2phaseAlgo<CONCURRENT>(graph, source, OneTilePushWrap{graph},
-                               TileRangeFn());
+                               TileRangeFn{graph, prefetchDist});
     break;
   default:
     std::cerr << "ERROR: unkown algo type" << std::endl;
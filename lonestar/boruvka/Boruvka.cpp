@@ -19,6 +19,8 @@
 
 #include "galois/Galois.h"
 #include "galois/Reduction.h"
+#include "galois/AtomicHelpers.h"
+#include "galois/LargeArray.h"
 #include "galois/Bag.h"
 #include "galois/Timer.h"
 #include "galois/UnionFind.h"
@@ -37,6 +39,9 @@
 #include <utility>
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
 
 namespace cll = llvm::cl;
 
@@ -44,7 +49,7 @@ static const char* name = "Boruvka's Minimum Spanning Tree Algorithm";
 static const char* desc = "Computes the minimum spanning forest of a graph";
 static const char* url  = "mst";
 
-enum Algo { parallel, exp_parallel };
+enum Algo { parallel, exp_parallel, filterKruskal, contracting };
 
 static cll::opt<std::string>
     inputFilename(cll::Positional, cll::desc("<input file>"), cll::Required);
@@ -58,6 +63,9 @@ static cll::opt<Algo>
 #ifdef GALOIS_USE_EXP
                      clEnumVal(exp_parallel, "Parallel (exp)"),
 #endif
+                     clEnumVal(filterKruskal, "Parallel Filter-Kruskal"),
+                     clEnumVal(contracting,
+                               "Boruvka with edge contraction and compaction"),
                      clEnumValEnd),
          cll::init(parallel));
 
@@ -86,12 +94,232 @@ struct Edge {
       : src(s), dst(d), weight(w) {}
 };
 
+/**
+ * Packs the indices in [0, n) that satisfy pred: emit(i, pos) is called for
+ * each such i with pos its rank among them, so output order is stable. Runs
+ * as two blocked do_all passes (count, then emit) around a prefix sum over
+ * the block counts; pred is evaluated in both.
+ *
+ * @returns number of indices that satisfy pred
+ */
+template <typename Pred, typename Emit>
+size_t parallelPack(size_t n, Pred pred, Emit emit) {
+  constexpr size_t BLOCK_SIZE = 4096;
+
+  size_t numBlocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+  if (numBlocks <= 1) {
+    size_t pos = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (pred(i))
+        emit(i, pos++);
+    }
+    return pos;
+  }
+
+  std::vector<size_t> offsets(numBlocks + 1);
+
+  galois::do_all(galois::iterate(size_t{0}, numBlocks),
+                 [&](size_t b) {
+                   size_t end   = std::min(n, (b + 1) * BLOCK_SIZE);
+                   size_t count = 0;
+                   for (size_t i = b * BLOCK_SIZE; i < end; ++i) {
+                     if (pred(i))
+                       ++count;
+                   }
+                   offsets[b + 1] = count;
+                 },
+                 galois::steal(), galois::no_stats());
+
+  offsets[0] = 0;
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  galois::do_all(galois::iterate(size_t{0}, numBlocks),
+                 [&](size_t b) {
+                   size_t end = std::min(n, (b + 1) * BLOCK_SIZE);
+                   size_t pos = offsets[b];
+                   for (size_t i = b * BLOCK_SIZE; i < end; ++i) {
+                     if (pred(i))
+                       emit(i, pos++);
+                   }
+                 },
+                 galois::steal(), galois::no_stats());
+
+  return offsets[numBlocks];
+}
+
+/**
+ * Input graph, spanning forest and verification shared by all algorithms.
+ */
+struct BaseAlgo {
+  Graph graph;
+  galois::InsertBag<Edge> mst;
+  EdgeData heaviest;
+
+  //! An undirected edge of the input with its weight copied out
+  struct WeightedEdge {
+    EdgeData weight;
+    GNode src;
+    GNode dst;
+    const EdgeData* ptr;
+
+    bool operator<(const WeightedEdge& o) const { return weight < o.weight; }
+  };
+
+  //! Adds edge to the forest if it joins 2 components
+  bool addIfLight(const WeightedEdge& e) {
+    Node& sdata = graph.getData(e.src, galois::MethodFlag::UNPROTECTED);
+    Node& ddata = graph.getData(e.dst, galois::MethodFlag::UNPROTECTED);
+    if (sdata.merge(&ddata)) {
+      mst.push(Edge(e.src, e.dst, e.ptr));
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Collects each undirected edge of the (symmetric) graph once, from the
+   * endpoint with the smaller id. Self loops are dropped.
+   */
+  void buildEdgeList(galois::LargeArray<WeightedEdge>& edges) {
+    galois::LargeArray<uint64_t> offsets;
+    offsets.allocateBlocked(graph.size() + 1);
+
+    galois::do_all(galois::iterate(graph),
+                   [&](const GNode& src) {
+                     uint64_t count = 0;
+                     for (auto ii : graph.edges(
+                              src, galois::MethodFlag::UNPROTECTED)) {
+                       if (graph.getEdgeDst(ii) > src)
+                         ++count;
+                     }
+                     offsets[src + 1] = count;
+                   },
+                   galois::steal(), galois::no_stats());
+
+    offsets[0] = 0;
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    edges.allocateInterleaved(offsets[graph.size()]);
+
+    galois::do_all(galois::iterate(graph),
+                   [&](const GNode& src) {
+                     uint64_t pos = offsets[src];
+                     for (auto ii : graph.edges(
+                              src, galois::MethodFlag::UNPROTECTED)) {
+                       GNode dst = graph.getEdgeDst(ii);
+                       if (dst > src) {
+                         const EdgeData& w = graph.getEdgeData(ii);
+                         edges[pos++]      = WeightedEdge{w, src, dst, &w};
+                       }
+                     }
+                   },
+                   galois::steal(), galois::no_stats());
+  }
+
+  bool checkAcyclic(void) {
+    galois::GAccumulator<unsigned> roots;
+
+    galois::do_all(galois::iterate(graph), [&roots, this](const GNode& n) {
+      const auto& data = graph.getData(n, galois::MethodFlag::UNPROTECTED);
+      if (data.isRep())
+        roots += 1;
+    });
+
+    unsigned numRoots = roots.reduce();
+    unsigned numEdges = std::distance(mst.begin(), mst.end());
+
+    if (graph.size() - numRoots != numEdges) {
+      std::cerr << "Generated graph is not a forest. "
+                << "Expected " << graph.size() - numRoots << " edges but "
+                << "found " << numEdges << "\n";
+      return false;
+    }
+
+    std::cout << "Num trees: " << numRoots << "\n";
+    std::cout << "Tree edges: " << numEdges << "\n";
+    return true;
+  }
+
+  bool verify() {
+
+    auto is_bad_graph = [this](const GNode& n) {
+      Node& me = graph.getData(n);
+      for (auto ii : graph.edges(n)) {
+        GNode dst  = graph.getEdgeDst(ii);
+        Node& data = graph.getData(dst);
+        if (me.findAndCompress() != data.findAndCompress()) {
+          std::cerr << "not in same component: " << me << " and " << data
+                    << "\n";
+          return true;
+        }
+      }
+      return false;
+    };
+
+    auto is_bad_mst = [this](const Edge& e) {
+      return graph.getData(e.src).findAndCompress() !=
+             graph.getData(e.dst).findAndCompress();
+    };
+
+    if (galois::ParallelSTL::find_if(graph.begin(), graph.end(),
+                                     is_bad_graph) == graph.end()) {
+      if (galois::ParallelSTL::find_if(mst.begin(), mst.end(), is_bad_mst) ==
+          mst.end()) {
+        return checkAcyclic();
+      }
+    }
+    return false;
+  }
+
+  void readInput() {
+    galois::graphs::FileGraph origGraph;
+    galois::graphs::FileGraph symGraph;
+
+    origGraph.fromFileInterleaved<EdgeData>(inputFilename);
+    if (!symmetricGraph)
+      galois::graphs::makeSymmetric<EdgeData>(origGraph, symGraph);
+    else
+      std::swap(symGraph, origGraph);
+
+    galois::graphs::readGraph(graph, symGraph);
+  }
+
+  void checkWeights() {
+    if (heaviest == std::numeric_limits<EdgeData>::max() ||
+        heaviest == std::numeric_limits<EdgeData>::min()) {
+      GALOIS_DIE("Edge weights of graph out of range");
+    }
+  }
+
+  void printSummary() {
+    std::cout << "Nodes: " << graph.size() << " edges: " << graph.sizeEdges()
+              << " heaviest edge: " << heaviest << "\n";
+  }
+
+  //! Reads the input; adjacency lists are left unsorted
+  void initializeGraph() {
+    readInput();
+
+    galois::GReduceMax<EdgeData> heavy;
+    galois::do_all(galois::iterate(graph), [&](const GNode& src) {
+      for (auto ii : graph.edges(src, galois::MethodFlag::UNPROTECTED)) {
+        heavy.update(graph.getEdgeData(ii));
+      }
+    });
+    heaviest = heavy.reduce();
+    checkWeights();
+
+    printSummary();
+  }
+};
+
 /**
  * Boruvka's algorithm. Implemented bulk-synchronously in order to avoid the
  * need to merge edge lists.
  */
 template <bool useExp>
-struct ParallelAlgo {
+struct ParallelAlgo : public BaseAlgo {
   struct WorkItem {
     Edge edge;
     int cur;
@@ -101,16 +329,12 @@ struct ParallelAlgo {
 
   typedef galois::InsertBag<WorkItem> WL;
 
-  Graph graph;
-
   WL wls[3];
   WL* current;
   WL* next;
   WL* pending;
   EdgeData limit;
-  galois::InsertBag<Edge> mst;
   EdgeData inf;
-  EdgeData heaviest;
 
   /**
    * Find lightest edge between components leaving a node and add it to the
@@ -312,30 +536,6 @@ struct ParallelAlgo {
     }
   }
 
-  bool checkAcyclic(void) {
-    galois::GAccumulator<unsigned> roots;
-
-    galois::do_all(galois::iterate(graph), [&roots, this](const GNode& n) {
-      const auto& data = graph.getData(n, galois::MethodFlag::UNPROTECTED);
-      if (data.isRep())
-        roots += 1;
-    });
-
-    unsigned numRoots = roots.reduce();
-    unsigned numEdges = std::distance(mst.begin(), mst.end());
-
-    if (graph.size() - numRoots != numEdges) {
-      std::cerr << "Generated graph is not a forest. "
-                << "Expected " << graph.size() - numRoots << " edges but "
-                << "found " << numEdges << "\n";
-      return false;
-    }
-
-    std::cout << "Num trees: " << numRoots << "\n";
-    std::cout << "Tree edges: " << numEdges << "\n";
-    return true;
-  }
-
   EdgeData sortEdges() {
 
     galois::GReduceMax<EdgeData> heavy;
@@ -360,62 +560,262 @@ struct ParallelAlgo {
     return heavy.reduce();
   }
 
-  bool verify() {
+  void initializeGraph() {
+    readInput();
 
-    auto is_bad_graph = [this](const GNode& n) {
-      Node& me = graph.getData(n);
-      for (auto ii : graph.edges(n)) {
-        GNode dst  = graph.getEdgeDst(ii);
-        Node& data = graph.getData(dst);
-        if (me.findAndCompress() != data.findAndCompress()) {
-          std::cerr << "not in same component: " << me << " and " << data
-                    << "\n";
-          return true;
-        }
-      }
-      return false;
-    };
+    galois::StatTimer Tsort("InitializeSortTime");
+    Tsort.start();
+    heaviest = sortEdges();
+    checkWeights();
+    inf = heaviest + 1;
 
-    auto is_bad_mst = [this](const Edge& e) {
-      return graph.getData(e.src).findAndCompress() !=
-             graph.getData(e.dst).findAndCompress();
+    Tsort.stop();
+
+    printSummary();
+  }
+};
+
+/**
+ * Filter-Kruskal: Kruskal's algorithm that avoids sorting heavy edges which
+ * end up inside a component anyway. Edges are split around a sampled pivot
+ * weight; the light part is solved recursively, after which heavy edges
+ * whose endpoints are already connected are filtered out in parallel and
+ * the rest are solved recursively. Only small partitions are sorted.
+ */
+struct FilterKruskalAlgo : public BaseAlgo {
+  //! Partitions at or below this size are sorted and scanned serially
+  static constexpr size_t KRUSKAL_CUTOFF = 1 << 14;
+  static constexpr size_t PIVOT_SAMPLES  = 63;
+
+  galois::LargeArray<WeightedEdge> edges;
+  galois::LargeArray<WeightedEdge> scratch;
+
+  size_t leaves;
+  size_t filtered;
+
+  bool isCrossing(const WeightedEdge& e) {
+    return graph.getData(e.src, galois::MethodFlag::UNPROTECTED)
+               .findAndCompress() !=
+           graph.getData(e.dst, galois::MethodFlag::UNPROTECTED)
+               .findAndCompress();
+  }
+
+  //! Median of weights sampled evenly from the range
+  static EdgeData choosePivot(const WeightedEdge* in, size_t n) {
+    std::vector<EdgeData> samples;
+    samples.reserve(PIVOT_SAMPLES);
+    for (size_t i = 0; i < PIVOT_SAMPLES; ++i) {
+      samples.push_back(in[i * (n - 1) / (PIVOT_SAMPLES - 1)].weight);
+    }
+    auto mid = samples.begin() + samples.size() / 2;
+    std::nth_element(samples.begin(), mid, samples.end());
+    return *mid;
+  }
+
+  void kruskal(WeightedEdge* in, size_t n) {
+    leaves += 1;
+    std::sort(in, in + n);
+    for (size_t i = 0; i < n; ++i) {
+      addIfLight(in[i]);
+    }
+  }
+
+  /**
+   * Adds the forest edges among in[0, n) in weight order. out is scratch
+   * space of the same size; both are clobbered.
+   */
+  void filterKruskal(WeightedEdge* in, WeightedEdge* out, size_t n) {
+    if (n <= KRUSKAL_CUTOFF) {
+      kruskal(in, n);
+      return;
+    }
+
+    EdgeData pivot = choosePivot(in, n);
+    bool strict    = false;
+    auto isLight   = [&](size_t i) {
+      return strict ? in[i].weight < pivot : in[i].weight <= pivot;
+    };
+    auto copyTo = [&](WeightedEdge* dst) {
+      return [=](size_t i, size_t pos) { dst[pos] = in[i]; };
     };
 
-    if (galois::ParallelSTL::find_if(graph.begin(), graph.end(),
-                                     is_bad_graph) == graph.end()) {
-      if (galois::ParallelSTL::find_if(mst.begin(), mst.end(), is_bad_mst) ==
-          mst.end()) {
-        return checkAcyclic();
+    size_t numLight = parallelPack(n, isLight, copyTo(out));
+    if (numLight == n) {
+      // pivot is the heaviest weight: split off edges equal to it instead
+      strict   = true;
+      numLight = parallelPack(n, isLight, copyTo(out));
+      if (numLight == 0) {
+        // all weights equal; any order is sorted
+        leaves += 1;
+        for (size_t i = 0; i < n; ++i) {
+          addIfLight(in[i]);
+        }
+        return;
       }
     }
-    return false;
+    parallelPack(n, [&](size_t i) { return !isLight(i); },
+                 copyTo(out + numLight));
+
+    filterKruskal(out, in, numLight);
+
+    WeightedEdge* heavy = out + numLight;
+    size_t numHeavy     = n - numLight;
+    size_t numKept =
+        parallelPack(numHeavy, [&](size_t i) { return isCrossing(heavy[i]); },
+                     [&](size_t i, size_t pos) {
+                       in[numLight + pos] = heavy[i];
+                     });
+    filtered += numHeavy - numKept;
+
+    filterKruskal(in + numLight, out + numLight, numKept);
   }
 
-  void initializeGraph() {
-    galois::graphs::FileGraph origGraph;
-    galois::graphs::FileGraph symGraph;
+  void operator()() {
+    leaves   = 0;
+    filtered = 0;
 
-    origGraph.fromFileInterleaved<EdgeData>(inputFilename);
-    if (!symmetricGraph)
-      galois::graphs::makeSymmetric<EdgeData>(origGraph, symGraph);
-    else
-      std::swap(symGraph, origGraph);
+    buildEdgeList(edges);
+    scratch.allocateInterleaved(edges.size());
 
-    galois::graphs::readGraph(graph, symGraph);
+    filterKruskal(edges.data(), scratch.data(), edges.size());
 
-    galois::StatTimer Tsort("InitializeSortTime");
-    Tsort.start();
-    heaviest = sortEdges();
-    if (heaviest == std::numeric_limits<EdgeData>::max() ||
-        heaviest == std::numeric_limits<EdgeData>::min()) {
-      GALOIS_DIE("Edge weights of graph out of range");
+    galois::runtime::reportStat_Single("Boruvka", "KruskalLeaves", leaves);
+    galois::runtime::reportStat_Single("Boruvka", "FilteredEdges", filtered);
+  }
+};
+
+/**
+ * Boruvka's algorithm over an explicit edge list that is contracted every
+ * round: each component picks its lightest incident edge (ties broken by
+ * position), components are merged along the picked edges by pointer
+ * jumping and renumbered densely, and the edges still between different
+ * components are relabeled and compacted with a parallel pack. Later rounds
+ * thus only touch the surviving inter-component edges.
+ */
+struct ContractingAlgo : public BaseAlgo {
+  //! Edge between 2 (contracted) components and its index in original
+  struct ContractedEdge {
+    EdgeData weight;
+    uint32_t src;
+    uint32_t dst;
+    uint32_t id;
+  };
+
+  static constexpr uint64_t NO_EDGE = std::numeric_limits<uint64_t>::max();
+
+  galois::LargeArray<WeightedEdge> original;
+  galois::LargeArray<ContractedEdge> edges;
+  galois::LargeArray<ContractedEdge> nextEdges;
+  galois::LargeArray<std::atomic<uint64_t>> lightest;
+  galois::LargeArray<uint32_t> parent;
+  galois::LargeArray<uint32_t> jumped;
+  galois::LargeArray<uint32_t> label;
+
+  //! Orders edges by weight, then by position in the current edge list
+  static uint64_t edgeKey(EdgeData weight, size_t index) {
+    uint32_t biased = static_cast<uint32_t>(weight) ^ 0x80000000u;
+    return (static_cast<uint64_t>(biased) << 32) | index;
+  }
+
+  void operator()() {
+    buildEdgeList(original);
+
+    size_t numEdges      = original.size();
+    size_t numComponents = graph.size();
+
+    if (numEdges >= std::numeric_limits<uint32_t>::max()) {
+      GALOIS_DIE("too many edges for contracting Boruvka");
     }
-    inf = heaviest + 1;
 
-    Tsort.stop();
+    edges.allocateInterleaved(numEdges);
+    nextEdges.allocateInterleaved(numEdges);
+    lightest.allocateInterleaved(numComponents);
+    parent.allocateInterleaved(numComponents);
+    jumped.allocateInterleaved(numComponents);
+    label.allocateInterleaved(numComponents);
+
+    galois::do_all(galois::iterate(size_t{0}, numEdges),
+                   [&](size_t i) {
+                     const WeightedEdge& e = original[i];
+                     edges[i] = ContractedEdge{e.weight, e.src, e.dst,
+                                               static_cast<uint32_t>(i)};
+                   },
+                   galois::no_stats());
 
-    std::cout << "Nodes: " << graph.size() << " edges: " << graph.sizeEdges()
-              << " heaviest edge: " << heaviest << "\n";
+    size_t rounds = 0;
+
+    while (numEdges > 0) {
+      rounds += 1;
+
+      galois::do_all(galois::iterate(size_t{0}, numComponents),
+                     [&](size_t c) { lightest[c] = NO_EDGE; },
+                     galois::no_stats());
+
+      galois::do_all(galois::iterate(size_t{0}, numEdges),
+                     [&](size_t i) {
+                       const ContractedEdge& e = edges[i];
+                       uint64_t key            = edgeKey(e.weight, i);
+                       galois::atomicMin(lightest[e.src], key);
+                       galois::atomicMin(lightest[e.dst], key);
+                     },
+                     galois::steal(), galois::loopname("FindLightest"));
+
+      // hook each component to the other end of its lightest edge; of 2
+      // components that picked the same edge, the smaller becomes the root
+      galois::do_all(
+          galois::iterate(size_t{0}, numComponents),
+          [&](size_t c) {
+            uint64_t key = lightest[c];
+            if (key == NO_EDGE) {
+              parent[c] = c;
+              return;
+            }
+            const ContractedEdge& e = edges[key & 0xFFFFFFFFu];
+            uint32_t other          = (e.src == c) ? e.dst : e.src;
+            if (lightest[other] == key && c < other) {
+              parent[c] = c;
+              return;
+            }
+            parent[c] = other;
+            addIfLight(original[e.id]);
+          },
+          galois::steal(), galois::loopname("Hook"));
+
+      galois::GReduceLogicalOR changed;
+      do {
+        changed.reset();
+        galois::do_all(galois::iterate(size_t{0}, numComponents),
+                       [&](size_t c) {
+                         uint32_t p = parent[c];
+                         uint32_t g = parent[p];
+                         jumped[c]  = g;
+                         if (g != p)
+                           changed.update(true);
+                       },
+                       galois::loopname("PointerJump"));
+        std::swap(parent, jumped);
+      } while (changed.reduce());
+
+      size_t nextComponents = parallelPack(
+          numComponents,
+          [&](size_t c) { return parent[c] == c && lightest[c] != NO_EDGE; },
+          [&](size_t c, size_t pos) { label[c] = pos; });
+
+      size_t nextNumEdges = parallelPack(
+          numEdges,
+          [&](size_t i) { return parent[edges[i].src] != parent[edges[i].dst]; },
+          [&](size_t i, size_t pos) {
+            const ContractedEdge& e = edges[i];
+            nextEdges[pos] = ContractedEdge{e.weight, label[parent[e.src]],
+                                            label[parent[e.dst]], e.id};
+          });
+
+      std::swap(edges, nextEdges);
+      numEdges      = nextNumEdges;
+      numComponents = nextComponents;
+    }
+
+    galois::runtime::reportStat_Single("Boruvka", "rounds", rounds);
   }
 };
 
@@ -465,6 +865,12 @@ int main(int argc, char** argv) {
   case exp_parallel:
     run<ParallelAlgo<true>>();
     break;
+  case filterKruskal:
+    run<FilterKruskalAlgo>();
+    break;
+  case contracting:
+    run<ContractingAlgo>();
+    break;
   default:
     std::cerr << "Unknown algo: " << algo << "\n";
   }
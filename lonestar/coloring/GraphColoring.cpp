@@ -0,0 +1,383 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Bag.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "llvm/Support/CommandLine.h"
+#include "Lonestar/BoilerPlate.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+const char* name = "Graph Coloring";
+const char* desc = "Computes a greedy coloring of a symmetric graph";
+const char* url  = "graph_coloring";
+
+enum Algo { speculative, jonesPlassmann };
+
+namespace cll = llvm::cl;
+static cll::opt<std::string>
+    inputFilename(cll::Positional, cll::desc("<input graph (symmetric)>"),
+                  cll::Required);
+static cll::opt<Algo> algo(
+    "algo", cll::desc("Choose an algorithm (default value speculative):"),
+    cll::values(clEnumVal(speculative, "Speculative coloring with conflict "
+                                       "resolution rounds (Gebremedhin-Manne)"),
+                clEnumVal(jonesPlassmann, "Jones-Plassmann with largest "
+                                          "log-degree first priorities"),
+                clEnumValEnd),
+    cll::init(speculative));
+static cll::opt<unsigned>
+    scratchKB("scratchKB",
+              cll::desc("Size in KB of the per-thread forbidden color bitmap "
+                        "(default 0: L1 data cache size)"),
+              cll::init(0));
+
+//! color of uncolored nodes; colors start at 1
+constexpr static const uint32_t UNCOLORED = 0;
+
+struct NodeData {
+  uint32_t color;
+  //! jonesPlassmann: number of uncolored neighbors of higher priority
+  std::atomic<uint32_t> pending;
+  //! jonesPlassmann: log-degree in the high half, hashed id in the low half
+  uint64_t priority;
+};
+
+typedef galois::graphs::LC_CSR_Graph<NodeData, void>::with_numa_alloc<
+    true>::type ::with_no_lockable<true>::type Graph;
+typedef Graph::GraphNode GNode;
+typedef galois::InsertBag<GNode> Bag;
+
+static size_t l1CacheBytes() {
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  long size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+  if (size > 0)
+    return size;
+#endif
+  return 32 << 10;
+}
+
+/**
+ * Per-thread bitmap of the colors taken by the neighbors of a node. The
+ * bitmap has a fixed, cache-sized capacity and covers a window of colors at
+ * a time. A node of degree d always gets one of the colors 1 to d + 1, so
+ * only the first (d + 1) / 64 words are touched and cleared for it; nodes
+ * of larger degree than the capacity slide the window until it holds a free
+ * color, rescanning their neighbors each time.
+ */
+class ForbiddenColors {
+  std::vector<uint64_t> bits;
+
+public:
+  //! Allocated on first use so that the bitmap is local to its thread
+  void reserve(size_t bytes) {
+    if (bits.empty()) {
+      bits.resize(std::max<size_t>(1, bytes / sizeof(uint64_t)));
+    }
+  }
+
+  //! Number of colors covered by a window
+  uint32_t capacity() const { return bits.size() * 64; }
+
+  void set(uint32_t i) { bits[i / 64] |= uint64_t{1} << (i % 64); }
+
+  /**
+   * Returns the first unset bit below n, or n if there is none, and clears
+   * the bits below n.
+   */
+  uint32_t takeFirstFree(uint32_t n) {
+    uint32_t words = (n + 63) / 64;
+    uint32_t found = n;
+    for (uint32_t w = 0; w < words; ++w) {
+      if (found == n && ~bits[w]) {
+        found = std::min(n, w * 64 + __builtin_ctzll(~bits[w]));
+      }
+      bits[w] = 0;
+    }
+    return found;
+  }
+};
+
+typedef galois::substrate::PerThreadStorage<ForbiddenColors> Scratch;
+
+//! Smallest color not taken by a neighbor of src
+uint32_t firstFit(Graph& graph, GNode src, ForbiddenColors& forbidden) {
+  auto ii = graph.edge_begin(src, galois::MethodFlag::UNPROTECTED);
+  auto ei = graph.edge_end(src, galois::MethodFlag::UNPROTECTED);
+  // a free color among 1 to degree + 1 always exists
+  uint32_t limit = std::distance(ii, ei) + 2;
+
+  for (uint32_t base = 1;; base += forbidden.capacity()) {
+    uint32_t n = std::min(limit - base, forbidden.capacity());
+    for (auto jj = ii; jj != ei; ++jj) {
+      GNode dst = graph.getEdgeDst(jj);
+      if (dst == src)
+        continue;
+      uint32_t c =
+          graph.getData(dst, galois::MethodFlag::UNPROTECTED).color - base;
+      // also skips uncolored neighbors, which wrap around
+      if (c < n)
+        forbidden.set(c);
+    }
+    uint32_t free = forbidden.takeFirstFree(n);
+    if (free < n)
+      return base + free;
+  }
+}
+
+/**
+ * Speculative coloring of Gebremedhin and Manne, as refined by Catalyurek et
+ * al. Each round colors the nodes of the worklist in parallel with
+ * first-fit, reading neighbor colors without synchronization, and then
+ * detects conflicts: of 2 adjacent nodes that got the same color, the one
+ * with the larger id is recolored in the next round.
+ */
+void colorSpeculative(Graph& graph, Scratch& scratch) {
+  Bag bags[2];
+  Bag* cur  = &bags[0];
+  Bag* next = &bags[1];
+
+  galois::GAccumulator<size_t> conflicts;
+  size_t rounds = 0;
+
+  auto color = [&](const GNode& src) {
+    ForbiddenColors& forbidden = *scratch.getLocal();
+    graph.getData(src, galois::MethodFlag::UNPROTECTED).color =
+        firstFit(graph, src, forbidden);
+  };
+
+  auto detect = [&](const GNode& src) {
+    uint32_t mine = graph.getData(src, galois::MethodFlag::UNPROTECTED).color;
+    for (auto ii : graph.edges(src, galois::MethodFlag::UNPROTECTED)) {
+      GNode dst = graph.getEdgeDst(ii);
+      if (dst < src &&
+          graph.getData(dst, galois::MethodFlag::UNPROTECTED).color == mine) {
+        next->push(src);
+        conflicts += 1;
+        return;
+      }
+    }
+  };
+
+  galois::do_all(galois::iterate(graph), color, galois::steal(),
+                 galois::loopname("Color"));
+  galois::do_all(galois::iterate(graph), detect, galois::steal(),
+                 galois::loopname("DetectConflicts"));
+  rounds += 1;
+
+  while (!next->empty()) {
+    std::swap(cur, next);
+    next->clear();
+
+    galois::do_all(galois::iterate(*cur), color, galois::steal(),
+                   galois::loopname("Color"));
+    galois::do_all(galois::iterate(*cur), detect, galois::steal(),
+                   galois::loopname("DetectConflicts"));
+    rounds += 1;
+  }
+
+  galois::runtime::reportStat_Single("GraphColoring", "Rounds", rounds);
+  galois::runtime::reportStat_Single("GraphColoring", "Conflicts",
+                                     conflicts.reduce());
+}
+
+static uint32_t hash(uint32_t val) {
+  val = ((val >> 16) ^ val) * 0x45d9f3b;
+  val = ((val >> 16) ^ val) * 0x45d9f3b;
+  return (val >> 16) ^ val;
+}
+
+//! Total order of the Jones-Plassmann priorities
+static bool before(const NodeData& a, GNode an, const NodeData& b, GNode bn) {
+  return a.priority > b.priority || (a.priority == b.priority && an > bn);
+}
+
+/**
+ * Jones-Plassmann coloring with largest-log-degree-first priorities
+ * (Hasenplaugh et al. SPAA 2014): nodes are ordered by the log of their
+ * degree, with ties broken by a hash of their id. A node is colored with
+ * first-fit once all its neighbors of higher priority are colored, which
+ * makes the result deterministic. Rounds are bulk synchronous: the nodes
+ * colored in a round count down the pending neighbors of their lower
+ * priority neighbors, and those that reach zero form the next round.
+ */
+void colorJonesPlassmann(Graph& graph, Scratch& scratch) {
+  Bag bags[2];
+  Bag* cur  = &bags[0];
+  Bag* next = &bags[1];
+
+  size_t rounds = 0;
+
+  galois::do_all(
+      galois::iterate(graph),
+      [&](const GNode& src) {
+        NodeData& data = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+        uint32_t degree = std::distance(
+            graph.edge_begin(src, galois::MethodFlag::UNPROTECTED),
+            graph.edge_end(src, galois::MethodFlag::UNPROTECTED));
+        uint64_t logDegree = degree ? 32 - __builtin_clz(degree) : 0;
+        data.priority      = (logDegree << 32) | hash(src);
+      },
+      galois::no_stats(), galois::loopname("Priority"));
+
+  galois::do_all(
+      galois::iterate(graph),
+      [&](const GNode& src) {
+        NodeData& data = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+        uint32_t count = 0;
+        for (auto ii : graph.edges(src, galois::MethodFlag::UNPROTECTED)) {
+          GNode dst = graph.getEdgeDst(ii);
+          if (dst != src &&
+              before(graph.getData(dst, galois::MethodFlag::UNPROTECTED), dst,
+                     data, src))
+            count += 1;
+        }
+        data.pending = count;
+        if (count == 0)
+          next->push(src);
+      },
+      galois::steal(), galois::loopname("CountPending"));
+
+  while (!next->empty()) {
+    std::swap(cur, next);
+    next->clear();
+
+    galois::do_all(
+        galois::iterate(*cur),
+        [&](const GNode& src) {
+          ForbiddenColors& forbidden = *scratch.getLocal();
+          NodeData& data = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+          data.color     = firstFit(graph, src, forbidden);
+
+          for (auto ii : graph.edges(src, galois::MethodFlag::UNPROTECTED)) {
+            GNode dst      = graph.getEdgeDst(ii);
+            NodeData& ddst = graph.getData(dst, galois::MethodFlag::UNPROTECTED);
+            if (dst != src && before(data, src, ddst, dst) &&
+                ddst.pending.fetch_sub(1) == 1)
+              next->push(dst);
+          }
+        },
+        galois::steal(), galois::loopname("Color"));
+    rounds += 1;
+  }
+
+  galois::runtime::reportStat_Single("GraphColoring", "Rounds", rounds);
+}
+
+//! Checks that every node is colored and differs from its neighbors
+bool verify(Graph& graph) {
+  galois::GAccumulator<size_t> uncolored;
+  galois::GAccumulator<size_t> clashes;
+
+  galois::do_all(
+      galois::iterate(graph),
+      [&](const GNode& src) {
+        uint32_t mine = graph.getData(src).color;
+        if (mine == UNCOLORED) {
+          uncolored += 1;
+          return;
+        }
+        for (auto ii : graph.edges(src)) {
+          GNode dst = graph.getEdgeDst(ii);
+          if (dst != src && graph.getData(dst).color == mine)
+            clashes += 1;
+        }
+      },
+      galois::steal(), galois::no_stats(), galois::loopname("Verify"));
+
+  if (uncolored.reduce() || clashes.reduce()) {
+    std::cerr << "uncolored nodes: " << uncolored.reduce()
+              << ", adjacent nodes of the same color: " << clashes.reduce()
+              << "\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  Graph graph;
+  galois::graphs::readGraph(graph, inputFilename);
+  std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
+            << " edges\n";
+
+  galois::do_all(galois::iterate(graph),
+                 [&](const GNode& n) {
+                   graph.getData(n, galois::MethodFlag::UNPROTECTED).color =
+                       UNCOLORED;
+                 },
+                 galois::no_stats());
+
+  size_t scratchBytes = scratchKB ? scratchKB * 1024 : l1CacheBytes();
+  Scratch scratch;
+  galois::on_each([&](unsigned, unsigned) {
+    scratch.getLocal()->reserve(scratchBytes);
+  });
+
+  galois::preAlloc(numThreads +
+                   4 * graph.size() * sizeof(GNode) /
+                       galois::runtime::pagePoolSize());
+  galois::reportPageAlloc("MeminfoPre");
+
+  galois::StatTimer T;
+  T.start();
+  switch (algo) {
+  case speculative:
+    colorSpeculative(graph, scratch);
+    break;
+  case jonesPlassmann:
+    colorJonesPlassmann(graph, scratch);
+    break;
+  default:
+    std::cerr << "Unknown algorithm " << algo << "\n";
+    abort();
+  }
+  T.stop();
+
+  galois::reportPageAlloc("MeminfoPost");
+
+  galois::GReduceMax<uint32_t> maxColor;
+  galois::do_all(galois::iterate(graph),
+                 [&](const GNode& n) { maxColor.update(graph.getData(n).color); },
+                 galois::no_stats(), galois::loopname("MaxColor"));
+  std::cout << "Colors used: " << maxColor.reduce() << "\n";
+  galois::runtime::reportStat_Single("GraphColoring", "Colors",
+                                     maxColor.reduce());
+
+  if (!skipVerify) {
+    if (verify(graph)) {
+      std::cout << "Verification successful.\n";
+    } else {
+      GALOIS_DIE("verification failed");
+    }
+  }
+
+  return 0;
+}
@@ -101,7 +101,7 @@ public:
    */
   void run(int argc, char* argv[]) {
 
-    galois::StatManager sm;
+    galois::SharedMemSys G;
     LonestarStart(argc, argv, name, desc, url);
 
     SimInit_tp simInit(netlistFile);
@@ -142,7 +142,8 @@ private:
    * read next token as a C string
    */
   char* readNextToken() {
-    nextTokPtr = strtok(NULL, delim);
+    // strtok (NULL, ...) is only valid once a line has been tokenized
+    nextTokPtr = (linePtr != NULL) ? strtok(NULL, delim) : NULL;
 
     while (nextTokPtr == NULL || isCommentBegin()) {
       linePtr = getNextLine();
@@ -26,7 +26,6 @@
 #include "galois/Galois.h"
 #include "galois/PerThreadContainer.h"
 
-#include "galois/runtime/KDGaddRem.h"
 #include "galois/substrate/PaddedLock.h"
 #include "galois/substrate/CompilerSpecific.h"
 
@@ -127,19 +126,14 @@ class DESordered : public des::AbstractMain<TypeHelper<>::SimInit_ty>,
                    public TypeHelper<> {
 
   struct NhoodVisitor {
-    typedef int tt_has_fixed_neighborhood;
-
-    static const unsigned CHUNK_SIZE = 4;
-
     Graph& graph;
     VecSobjInfo& sobjInfoVec;
 
     NhoodVisitor(Graph& graph, VecSobjInfo& sobjInfoVec)
         : graph(graph), sobjInfoVec(sobjInfoVec) {}
 
-    template <typename C>
-    GALOIS_ATTRIBUTE_PROF_NOINLINE void operator()(const Event_ty& event,
-                                                   C&) const {
+    GALOIS_ATTRIBUTE_PROF_NOINLINE void
+    operator()(const Event_ty& event) const {
       SimObjInfo& recvInfo = sobjInfoVec[event.getRecvObj()->getID()];
       graph.getData(recvInfo.node, galois::MethodFlag::WRITE);
     }
@@ -158,10 +152,6 @@ class DESordered : public des::AbstractMain<TypeHelper<>::SimInit_ty>,
   };
 
   struct OpFunc {
-
-    static const size_t CHUNK_SIZE    = 4;
-    static const size_t UNROLL_FACTOR = 1024;
-
     Graph& graph;
     std::vector<SimObjInfo>& sobjInfoVec;
     AddList_ty& newEvents;
@@ -179,9 +169,6 @@ class DESordered : public des::AbstractMain<TypeHelper<>::SimInit_ty>,
       // std::cout << ">>> Processing: " << event.detailedString () <<
       // std::endl;
 
-      // TODO: needs a PQ with remove operation to work correctly
-      assert(ReadyTest(sobjInfoVec)(event));
-
       SimObj_ty* recvObj   = static_cast<SimObj_ty*>(event.getRecvObj());
       SimObjInfo& recvInfo = sobjInfoVec[recvObj->getID()];
 
@@ -211,7 +198,7 @@ class DESordered : public des::AbstractMain<TypeHelper<>::SimInit_ty>,
 
 protected:
   virtual std::string getVersion() const {
-    return "Handwritten Ordered ODG, no barrier";
+    return "Ordered executor with ready test";
   }
 
   virtual void initRemaining(const SimInit_ty& simInit, Graph& graph) {
@@ -241,12 +228,13 @@ protected:
     AddList_ty newEvents;
     Accumulator_ty nevents;
 
-    galois::runtime::for_each_ordered_ar(
-        galois::runtime::makeStandardRange(simInit.getInitEvents().begin(),
-                                           simInit.getInitEvents().end()),
+    // an event is a stable source once every input of its gate has seen an
+    // event at least as late, so no earlier event can still arrive
+    galois::for_each_ordered(
+        simInit.getInitEvents().begin(), simInit.getInitEvents().end(),
         Cmp_ty(), NhoodVisitor(graph, sobjInfoVec),
         OpFunc(graph, sobjInfoVec, newEvents, nevents), ReadyTest(sobjInfoVec),
-        std::make_tuple(galois::loopname("des_main_loop")));
+        "des_main_loop");
 
     std::cout << "Number of events processed= " << nevents.reduce()
               << std::endl;
@@ -282,8 +282,8 @@ protected:
             edgeSet.insert(edgeSet.erase(res.first), ke);
           }
         } else {
-          galois::substrate::gDebug("Warning: Ignoring self edge (", src, ",",
-                                    dst, ",", ingraph.getEdgeData(*e), ")");
+          galois::gDebug("Warning: Ignoring self edge (", src, ",", dst, ",",
+                         ingraph.getEdgeData(*e), ")");
         }
       }
     }
@@ -379,7 +379,7 @@ protected:
 
 public:
   virtual void run(int argc, char* argv[]) {
-    galois::StatManager stat;
+    galois::SharedMemSys G;
     LonestarStart(argc, argv, name, desc, url);
 
     size_t numNodes;
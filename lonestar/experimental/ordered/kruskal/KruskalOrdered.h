@@ -21,52 +21,93 @@
 #define KRUSKAL_ORDERED_H
 
 #include "Kruskal.h"
-#include "KruskalParallel.h"
-#include "galois/runtime/KDGtwoPhase.h"
 
-namespace kruskal {
-
-struct UnionFindUsingRuntime {
-  void operator()(EdgeCtxWL& perThrdWL, VecRep_ty& repVec,
-                  VecAtomicCtxPtr& repOwnerCtxVec, size_t& mstWeight,
-                  size_t& totalIter, galois::TimeAccumulator& sortTimer,
-                  galois::TimeAccumulator& findTimer,
-                  galois::TimeAccumulator& linkUpTimer, Accumulator& findIter,
-                  Accumulator& linkUpIter) const {
-
-    EdgeCtxWL* nextWL = NULL; // not used actually
-    Accumulator mstSum;
+#include "galois/substrate/CompilerSpecific.h"
 
-    // galois::for_each_ordered (perThrdWL.begin_all (), perThrdWL.end_all (),
-    galois::runtime::for_each_ordered_ikdg(
-        galois::runtime::makeLocalRange(perThrdWL), Edge::Comparator(),
-        FindLoop(repVec, repOwnerCtxVec, findIter),
-        LinkUpLoop<true>(repVec, repOwnerCtxVec, *nextWL, mstSum, linkUpIter),
-        std::make_tuple(galois::needs_custom_locking<>(),
-                        galois::loopname("kruskal-ikdg")));
-
-    totalIter += findIter.reduce();
-    mstWeight += mstSum.reduce();
-  }
-};
+namespace kruskal {
 
 class KruskalOrdered : public Kruskal {
 protected:
+  using Lock    = galois::runtime::Lockable;
+  using VecLock = std::vector<Lock>;
+
   virtual const std::string getVersion() const {
     return "Parallel Kruskal using Ordered Runtime";
   }
 
+  struct FindLoop {
+    VecLock& lockVec;
+    const VecRep& repVec;
+    std::vector<char>& isCycle;
+    Accumulator& findIter;
+
+    //! locks the components of the endpoints; reps don't change in this phase
+    GALOIS_ATTRIBUTE_PROF_NOINLINE void operator()(const Edge& e) const {
+      int repSrc = getRep_int(e.src, repVec);
+      int repDst = getRep_int(e.dst, repVec);
+
+      // an edge within a component stays so however earlier edges link
+      // components, so it needs no locks and no ordering
+      if (repSrc == repDst) {
+        isCycle[e.id] = true;
+      } else {
+        galois::runtime::acquire(&lockVec[repSrc], galois::MethodFlag::WRITE);
+        galois::runtime::acquire(&lockVec[repDst], galois::MethodFlag::WRITE);
+      }
+
+      findIter += 1;
+    }
+  };
+
+  struct LinkUpLoop {
+    VecRep& repVec;
+    const std::vector<char>& isCycle;
+    Accumulator& mstSum;
+    Accumulator& linkUpIter;
+
+    GALOIS_ATTRIBUTE_PROF_NOINLINE void
+    operator()(const Edge& e, galois::UserContext<Edge>&) const {
+      if (isCycle[e.id]) {
+        return;
+      }
+
+      int repSrc = findPCiter_int(e.src, repVec);
+      int repDst = findPCiter_int(e.dst, repVec);
+
+      if (repSrc != repDst) {
+        unionByRank_int(repSrc, repDst, repVec);
+        linkUpIter += 1;
+        mstSum += e.weight;
+      }
+    }
+  };
+
   virtual void runMST(const size_t numNodes, VecEdge& edges, size_t& mstWeight,
                       size_t& totalIter) {
+    VecLock lockVec(numNodes);
+    VecRep repVec(numNodes, -1);
+    std::vector<char> isCycle(edges.size(), false);
 
-    if (!bool(galois::runtime::useParaMeterOpt) &&
-        (edges.size() >= 2 * numNodes)) {
-      runMSTfilter(numNodes, edges, mstWeight, totalIter,
-                   UnionFindUsingRuntime());
-    } else {
-      runMSTsimple(numNodes, edges, mstWeight, totalIter,
-                   UnionFindUsingRuntime());
-    }
+    Accumulator findIter;
+    Accumulator linkUpIter;
+    Accumulator mstSum;
+
+    galois::StatTimer runningTime("time for running MST loop:");
+
+    runningTime.start();
+    galois::for_each_ordered(edges.begin(), edges.end(), Edge::Comparator(),
+                             FindLoop{lockVec, repVec, isCycle, findIter},
+                             LinkUpLoop{repVec, isCycle, mstSum, linkUpIter},
+                             "kruskal-ordered");
+    runningTime.stop();
+
+    mstWeight = mstSum.reduce();
+    totalIter = findIter.reduce();
+
+    std::cout << "Number of FindLoop iterations = " << findIter.reduce()
+              << std::endl;
+    std::cout << "Number of LinkUpLoop iterations = " << linkUpIter.reduce()
+              << std::endl;
   }
 };
 
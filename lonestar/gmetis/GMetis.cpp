@@ -52,6 +52,7 @@ static cll::opt<refinementMode> refineMode(
     cll::desc("Choose a refinement mode:"),
     cll::values(clEnumVal(BKL, "BKL"), clEnumVal(BKL2, "BKL2 (default)"),
                 clEnumVal(ROBO, "ROBO"), clEnumVal(GRACLUS, "GRACLUS"),
+                clEnumVal(LP, "LP (parallel label propagation)"),
                 clEnumValEnd),
     cll::init(BKL2));
 
@@ -80,6 +81,10 @@ static cll::opt<double> imbalance(
     "balance",
     cll::desc("Fraction deviated from mean partition size (default 0.01)"),
     cll::init(0.01));
+static cll::opt<unsigned>
+    lpRounds("lpRounds",
+             cll::desc("Maximum LP refinement rounds per level (default 12)"),
+             cll::init(12));
 
 // const double COARSEN_FRACTION = 0.9;
 
@@ -131,6 +136,9 @@ void Partition(MetisGraph* metisGraph, unsigned nparts) {
     case GRACLUS:
       std::cout << "Sorting refinnement with GRACLUS\n";
       break;
+    case LP:
+      std::cout << "Sorting refinnement with LP\n";
+      break;
     default:
       abort();
     }
@@ -139,7 +147,8 @@ void Partition(MetisGraph* metisGraph, unsigned nparts) {
   galois::StatTimer T3("Refine");
   T3.start();
   refine(mcg, parts, meanWeight - (unsigned)(meanWeight * imbalance),
-         meanWeight + (unsigned)(meanWeight * imbalance), refineMode, verbose);
+         meanWeight + (unsigned)(meanWeight * imbalance), refineMode, lpRounds,
+         verbose);
   T3.stop();
   if (verbose)
     std::cout << "Time refinement: " << T3.get() << "\n";
@@ -152,6 +161,7 @@ void Partition(MetisGraph* metisGraph, unsigned nparts) {
 
   std::cout << "Refined dist\n";
   printPartStats(parts);
+  reportRefineStats("Refined", *metisGraph->getGraph(), parts);
   std::cout << "\n";
 
   std::cout << "Time:  " << TM.get() << '\n';
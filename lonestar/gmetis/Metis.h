@@ -29,7 +29,7 @@ using GNodeBag = galois::InsertBag<GNode>;
 
 // algorithms
 enum InitialPartMode { GGP, GGGP, MGGGP };
-enum refinementMode { BKL, BKL2, ROBO, GRACLUS };
+enum refinementMode { BKL, BKL2, ROBO, GRACLUS, LP };
 // Nodes in the metis graph
 class MetisNode {
 
@@ -42,6 +42,8 @@ class MetisNode {
     unsigned partition;
     unsigned oldPartition;
     bool maybeBoundary;
+    unsigned lpDest; // desired partition in label-propagation refinement
+    int lpGain;      // cut reduction of moving to lpDest
   };
   struct partitionData {
     bool locked;
@@ -78,7 +80,7 @@ public:
 
   // call to switch data to refining
   void initRefine(unsigned part = 0, bool bound = false) {
-    refineData rd = {part, part, bound};
+    refineData rd = {part, part, bound, part, 0};
     data.rd       = rd;
   }
 
@@ -109,6 +111,13 @@ public:
   bool getmaybeBoundary() const { return data.rd.maybeBoundary; }
   void setmaybeBoundary(bool val) { data.rd.maybeBoundary = val; }
 
+  unsigned getLPDest() const { return data.rd.lpDest; }
+  int getLPGain() const { return data.rd.lpGain; }
+  void setLPMove(unsigned dest, int gain) {
+    data.rd.lpDest = dest;
+    data.rd.lpGain = gain;
+  }
+
   void setLocked(bool locked) { pd.locked = locked; }
   bool isLocked() { return pd.locked; }
 
@@ -194,6 +203,9 @@ unsigned graphStat(GGraph& graph);
 std::vector<unsigned> edgeCut(GGraph& g, unsigned nparts);
 void printCuts(const char* str, MetisGraph* g, unsigned numPartitions);
 unsigned computeCut(GGraph& g);
+double computeImbalance(std::vector<partInfo>& parts);
+void reportRefineStats(const char* str, GGraph& g,
+                       std::vector<partInfo>& parts);
 
 // Coarsening
 MetisGraph* coarsen(MetisGraph* fineMetisGraph, unsigned coarsenTo,
@@ -209,7 +221,7 @@ std::vector<partInfo> BisectAll(MetisGraph* mcg, unsigned numPartitions,
 // Refinement
 void refine(MetisGraph* coarseGraph, std::vector<partInfo>& parts,
             unsigned minSize, unsigned maxSize, refinementMode refM,
-            bool verbose);
+            unsigned lpRounds, bool verbose);
 // void refinePart(GGraph& g, std::vector<partInfo>& parts, unsigned maxSize);
 // Balancing
 void balance(MetisGraph* Graph, std::vector<partInfo>& parts, unsigned maxSize);
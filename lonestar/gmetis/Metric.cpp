@@ -18,6 +18,7 @@
  */
 
 #include "Metis.h"
+#include "galois/runtime/Statistics.h"
 
 #include <iomanip>
 #include <iostream>
@@ -97,6 +98,27 @@ unsigned computeCut(GGraph& g) {
   return cuts / 2;
 }
 
+// ratio of the heaviest partition to the mean partition weight
+double computeImbalance(std::vector<partInfo>& parts) {
+  onlineStat e;
+  assert(!parts.empty());
+  for (unsigned x = 0; x < parts.size(); ++x)
+    e.add(parts[x].partWeight);
+  return e.mean() > 0 ? (double)e.max() / e.mean() : 0;
+}
+
+// quality of a refined partition; compare refinement modes (e.g., LP against
+// BKL2) using these together with the Refine timer
+void reportRefineStats(const char* str, GGraph& g,
+                       std::vector<partInfo>& parts) {
+  unsigned cut     = computeCut(g);
+  double imbalance = computeImbalance(parts);
+  std::cout << str << " edge cut " << cut << " imbalance " << imbalance
+            << "\n";
+  galois::runtime::reportStat_Single("GMetis", "EdgeCut", cut);
+  galois::runtime::reportStat_Single("GMetis", "Imbalance", imbalance);
+}
+
 void printPartStats(std::vector<partInfo>& parts) {
   onlineStat e;
   assert(!parts.empty());
@@ -21,6 +21,8 @@
 #include "galois/Reduction.h"
 #include "galois/Timer.h"
 #include "Metis.h"
+#include <algorithm>
+#include <limits>
 #include <set>
 #include <iostream>
 
@@ -177,6 +179,227 @@ void refine_BKL2(unsigned minSize, unsigned maxSize, GGraph& cg, GGraph* fg,
       galois::loopname("refine"), galois::wl<pG>(gainIndexer));
 }
 
+// Label-propagation refinement (Jet-style). Each round every boundary node
+// picks the adjacent partition it is most connected to; candidate moves are
+// filtered against higher-priority neighbor moves and then applied bucket by
+// bucket (highest gain first) subject to the partition size constraints.
+// Rounds stop when no positive-gain move survives or after maxRounds; a
+// rebalancing pass then drains partitions that are still above maxSize.
+const unsigned LP_NUM_BUCKETS = 16;
+const unsigned LP_MAX_BALANCE = 4;
+
+unsigned lpBucket(int gain) {
+  assert(gain > 0);
+  return std::min(LP_NUM_BUCKETS - 1, 31u - __builtin_clz((unsigned)gain));
+}
+
+// higher gain first; ties broken by node address so the order is total
+bool lpBeats(GNode a, const MetisNode& ad, GNode b, const MetisNode& bd) {
+  return ad.getLPGain() > bd.getLPGain() ||
+         (ad.getLPGain() == bd.getLPGain() && a < b);
+}
+
+// try to move n from its partition to dest; fails if either partition would
+// leave [minSize, maxSize]
+bool lpTryMove(MetisNode& nd, unsigned dest, unsigned minSize,
+               unsigned maxSize, std::vector<partInfo>& parts) {
+  unsigned src = nd.getPart();
+  unsigned w   = nd.getWeight();
+  if (__sync_add_and_fetch(&parts[dest].partWeight, w) > maxSize) {
+    __sync_fetch_and_sub(&parts[dest].partWeight, w);
+    return false;
+  }
+  unsigned srcWeight = __sync_fetch_and_sub(&parts[src].partWeight, w);
+  if (srcWeight < minSize + w) {
+    __sync_fetch_and_add(&parts[src].partWeight, w);
+    __sync_fetch_and_sub(&parts[dest].partWeight, w);
+    return false;
+  }
+  nd.setPart(dest);
+  return true;
+}
+
+void lpMarkMoved(GGraph& cg, GNode n) {
+  constexpr auto flag = galois::MethodFlag::UNPROTECTED;
+  cg.getData(n, flag).setmaybeBoundary(true);
+  for (auto ii : cg.edges(n, flag))
+    cg.getData(cg.getEdgeDst(ii), flag).setmaybeBoundary(true);
+}
+
+void refine_LP(unsigned minSize, unsigned maxSize, unsigned maxRounds,
+               GGraph& cg, GGraph* fg, std::vector<partInfo>& parts) {
+  constexpr auto flag = galois::MethodFlag::UNPROTECTED;
+
+  struct Conn {
+    galois::gstl::Vector<int> weight;
+    galois::gstl::Vector<unsigned> touched;
+  };
+  galois::substrate::PerThreadStorage<Conn> connThreadLocal;
+
+  // accumulates connectivity of n per partition into thread-local storage;
+  // callers must release it with lpClearConn
+  auto lpConn = [&](GNode n, auto&& partOf) -> Conn& {
+    auto& conn = *connThreadLocal.getLocal();
+    if (conn.weight.size() != parts.size())
+      conn.weight.assign(parts.size(), 0);
+    for (auto ii : cg.edges(n, flag)) {
+      unsigned q = partOf(cg.getEdgeDst(ii));
+      if (conn.weight[q] == 0)
+        conn.touched.push_back(q);
+      conn.weight[q] += cg.getEdgeData(ii, flag);
+    }
+    return conn;
+  };
+  auto lpClearConn = [](Conn& conn) {
+    for (unsigned q : conn.touched)
+      conn.weight[q] = 0;
+    conn.touched.clear();
+  };
+  auto curPart = [&](GNode m) { return cg.getData(m, flag).getPart(); };
+
+  GNodeBag candidates[LP_NUM_BUCKETS];
+  GNodeBag confirmed[LP_NUM_BUCKETS];
+  galois::GAccumulator<size_t> movedGain;
+
+  for (unsigned round = 0; round < maxRounds; ++round) {
+    GNodeBag boundary;
+    findBoundary(boundary, cg);
+
+    // pick the best adjacent partition for every boundary node
+    galois::do_all(
+        galois::iterate(boundary),
+        [&](GNode n) {
+          auto& nd   = cg.getData(n, flag);
+          unsigned P = nd.getPart();
+          auto& conn    = lpConn(n, curPart);
+          unsigned best = P;
+          int bestConn  = conn.weight[P];
+          for (unsigned q : conn.touched) {
+            if (conn.weight[q] > bestConn &&
+                parts[q].partWeight + nd.getWeight() <= maxSize) {
+              best     = q;
+              bestConn = conn.weight[q];
+            }
+          }
+          int g = bestConn - conn.weight[P];
+          lpClearConn(conn);
+          if (best != P) {
+            nd.setLPMove(best, g);
+            candidates[lpBucket(g)].push(n);
+          }
+        },
+        galois::loopname("LP-Choose"));
+
+    // afterburner: recompute the gain assuming every higher-priority
+    // neighbor has already moved; drop moves that are no longer profitable
+    for (unsigned b = 0; b < LP_NUM_BUCKETS; ++b) {
+      galois::do_all(
+          galois::iterate(candidates[b]),
+          [&](GNode n) {
+            auto& nd   = cg.getData(n, flag);
+            auto after = [&](GNode m) {
+              auto& md = cg.getData(m, flag);
+              if (md.getLPDest() != md.getPart() && lpBeats(m, md, n, nd))
+                return md.getLPDest();
+              return md.getPart();
+            };
+            auto& conn = lpConn(n, after);
+            int g = conn.weight[nd.getLPDest()] - conn.weight[nd.getPart()];
+            lpClearConn(conn);
+            if (g > 0)
+              confirmed[lpBucket(g)].push(n);
+          },
+          galois::loopname("LP-Filter"));
+    }
+
+    movedGain.reset();
+    for (unsigned b = LP_NUM_BUCKETS; b-- > 0;) {
+      galois::do_all(
+          galois::iterate(confirmed[b]),
+          [&](GNode n) {
+            auto& nd = cg.getData(n, flag);
+            if (lpTryMove(nd, nd.getLPDest(), minSize, maxSize, parts)) {
+              movedGain += nd.getLPGain();
+              lpMarkMoved(cg, n);
+            }
+          },
+          galois::loopname("LP-Apply"));
+    }
+
+    for (unsigned b = 0; b < LP_NUM_BUCKETS; ++b) {
+      galois::do_all(galois::iterate(candidates[b]),
+                     [&](GNode n) {
+                       auto& nd = cg.getData(n, flag);
+                       nd.setLPMove(nd.getPart(), 0);
+                     },
+                     galois::loopname("LP-Reset"));
+      candidates[b].clear();
+      confirmed[b].clear();
+    }
+
+    if (movedGain.reduce() == 0)
+      break;
+  }
+
+  // rebalance: move boundary nodes out of overweight partitions into the
+  // adjacent partition that loses the least cut
+  for (unsigned round = 0; round < LP_MAX_BALANCE; ++round) {
+    if (std::none_of(parts.begin(), parts.end(), [&](const partInfo& p) {
+          return p.partWeight > maxSize;
+        }))
+      break;
+
+    GNodeBag boundary;
+    findBoundary(boundary, cg);
+    galois::do_all(
+        galois::iterate(boundary),
+        [&](GNode n) {
+          auto& nd   = cg.getData(n, flag);
+          unsigned P = nd.getPart();
+          unsigned w = nd.getWeight();
+          if (parts[P].partWeight <= maxSize)
+            return;
+          auto& conn    = lpConn(n, curPart);
+          unsigned best = P;
+          int bestConn  = std::numeric_limits<int>::min();
+          for (unsigned q : conn.touched) {
+            if (q != P && conn.weight[q] > bestConn &&
+                parts[q].partWeight + w <= maxSize) {
+              best     = q;
+              bestConn = conn.weight[q];
+            }
+          }
+          lpClearConn(conn);
+          if (best == P)
+            return;
+          // only drain P while it is still overweight
+          if (__sync_fetch_and_sub(&parts[P].partWeight, w) <= maxSize) {
+            __sync_fetch_and_add(&parts[P].partWeight, w);
+            return;
+          }
+          if (__sync_add_and_fetch(&parts[best].partWeight, w) > maxSize) {
+            __sync_fetch_and_sub(&parts[best].partWeight, w);
+            __sync_fetch_and_add(&parts[P].partWeight, w);
+            return;
+          }
+          nd.setPart(best);
+          lpMarkMoved(cg, n);
+        },
+        galois::loopname("LP-Balance"));
+  }
+
+  // project to the finer graph; every child is a boundary candidate
+  if (fg)
+    galois::do_all(galois::iterate(cg),
+                   [&](GNode n) {
+                     auto& cn = cg.getData(n, flag);
+                     for (unsigned x = 0; x < cn.numChildren(); ++x)
+                       fg->getData(cn.getChild(x), flag)
+                           .initRefine(cn.getPart(), true);
+                   },
+                   galois::loopname("LP-Project"));
+}
+
 void projectPart(MetisGraph* Graph, std::vector<partInfo>& parts) {
   GGraph* fineGraph   = Graph->getFinerGraph()->getGraph();
   GGraph* coarseGraph = Graph->getGraph();
@@ -385,7 +608,7 @@ void GraclusRefining(GGraph* graph, int nbParti, int nbIter) {
 
 void refine(MetisGraph* coarseGraph, std::vector<partInfo>& parts,
             unsigned minSize, unsigned maxSize, refinementMode refM,
-            bool verbose) {
+            unsigned lpRounds, bool verbose) {
   MetisGraph* tGraph = coarseGraph;
   int nbIter         = 1;
   if (refM == GRACLUS) {
@@ -419,6 +642,11 @@ void refine(MetisGraph* coarseGraph, std::vector<partInfo>& parts,
       GraclusRefining(coarseGraph->getGraph(), parts.size(), nbIter);
       nbIter = (nbIter + 1) / 2;
       break;
+    case LP:
+      refine_LP(minSize, maxSize, lpRounds, *coarseGraph->getGraph(),
+                fineGraph ? fineGraph->getGraph() : nullptr, parts);
+      doProject = false;
+      break;
     default:
       abort();
     }
@@ -159,21 +159,30 @@ struct BFS_SSSP {
     }
   };
 
+  //! Edge ranges prefetch the destination labels prefetchDist edges ahead;
+  //! 0, the default of the apps' -prefetchDist, disables prefetching
   struct OutEdgeRangeFn {
     Graph& graph;
+    unsigned prefetchDist;
+
     auto operator()(const GNode& n) const {
-      return graph.edges(n, galois::MethodFlag::UNPROTECTED);
+      return graph.prefetched_edges(n, galois::MethodFlag::UNPROTECTED,
+                                    prefetchDist);
     }
 
     auto operator()(const UpdateRequest& req) const {
-      return graph.edges(req.src, galois::MethodFlag::UNPROTECTED);
+      return graph.prefetched_edges(req.src, galois::MethodFlag::UNPROTECTED,
+                                    prefetchDist);
     }
   };
 
   struct TileRangeFn {
+    Graph& graph;
+    unsigned prefetchDist;
+
     template <typename T>
     auto operator()(const T& tile) const {
-      return galois::makeIterRange(tile.beg, tile.end);
+      return graph.prefetched_edges(tile.beg, tile.end, prefetchDist);
     }
   };
 
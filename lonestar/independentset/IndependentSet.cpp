@@ -20,6 +20,7 @@
 #include "galois/Galois.h"
 #include "galois/Reduction.h"
 #include "galois/Bag.h"
+#include "galois/LargeArray.h"
 #include "galois/Timer.h"
 #include "galois/graphs/LCGraph.h"
 #include "galois/ParallelSTL.h"
@@ -28,6 +29,7 @@
 
 #include "Lonestar/BoilerPlate.h"
 
+#include <atomic>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -41,7 +43,7 @@ const char* desc =
     "Computes a maximal independent set (not maximum) of nodes in a graph";
 const char* url = "independent_set";
 
-enum Algo { serial, pull, nondet, detBase, prio, edgetiledprio };
+enum Algo { serial, pull, nondet, detBase, prio, edgetiledprio, detPrio };
 
 namespace cll = llvm::cl;
 static cll::opt<std::string> filename(cll::Positional,
@@ -61,6 +63,8 @@ static cll::opt<Algo> algo(
         clEnumVal(
             edgetiledprio,
             "edge-tiled prio algo based on Martin's GPU ECL-MIS algorithm"),
+        clEnumVal(detPrio, "deterministic Luby-style prio algo with hashed "
+                           "priorities over a shrinking frontier"),
         clEnumValEnd),
     cll::init(prio));
 
@@ -577,6 +581,138 @@ struct EdgeTiledPrioAlgo {
   }
 };
 
+/**
+ * Deterministic, lock-free Luby-style algorithm. Every node gets a fixed
+ * pseudo-random priority by hashing its id. Each round has two bulk
+ * synchronous phases over the frontier of undecided nodes: nodes whose
+ * priority beats that of all undecided neighbors join the set, then their
+ * neighbors are taken out of it. Decisions only depend on the state at the
+ * start of a round, so the result is independent of thread count and
+ * schedule. Undecided nodes are tracked in a bitset, so the neighbor checks
+ * of the select phase touch one bit per neighbor (priorities are recomputed,
+ * not loaded).
+ */
+struct DetPrioAlgo {
+  using Graph = galois::graphs::LC_CSR_Graph<Node, void>::with_numa_alloc<
+      true>::type ::with_no_lockable<true>::type;
+  using GNode = Graph::GraphNode;
+  using Bag   = galois::InsertBag<GNode>;
+
+  galois::LargeArray<std::atomic<uint64_t>> undecided;
+
+  bool isUndecided(GNode n) const {
+    return undecided[n / 64].load(std::memory_order_relaxed) &
+           (uint64_t{1} << (n % 64));
+  }
+
+  void decide(GNode n) {
+    undecided[n / 64].fetch_and(~(uint64_t{1} << (n % 64)),
+                                std::memory_order_relaxed);
+  }
+
+  static uint64_t priority(GNode n) {
+    uint32_t val = n;
+    val          = ((val >> 16) ^ val) * 0x45d9f3b;
+    val          = ((val >> 16) ^ val) * 0x45d9f3b;
+    val          = (val >> 16) ^ val;
+    // break ties on the id to get a total order
+    return (static_cast<uint64_t>(val) << 32) | n;
+  }
+
+  template <typename R>
+  void select(const R& range, Graph& graph, Bag& selected) {
+    galois::do_all(
+        range,
+        [&](const GNode& src) {
+          uint64_t prio = priority(src);
+          for (auto edge :
+               graph.out_edges(src, galois::MethodFlag::UNPROTECTED)) {
+            GNode dst = graph.getEdgeDst(edge);
+            if (dst != src && isUndecided(dst) && priority(dst) > prio)
+              return;
+          }
+          selected.push_back(src);
+        },
+        galois::steal(), galois::loopname("select"));
+  }
+
+  void operator()(Graph& graph) {
+    size_t rounds = 0;
+    galois::GAccumulator<size_t> numFrontier;
+
+    Bag bags[2];
+    Bag* cur  = &bags[0];
+    Bag* next = &bags[1];
+    Bag selected;
+
+    size_t numWords = (graph.size() + 63) / 64;
+    undecided.allocateInterleaved(numWords);
+    galois::do_all(galois::iterate(size_t{0}, numWords),
+                   [&](size_t w) {
+                     size_t bits = std::min<size_t>(64, graph.size() - w * 64);
+                     undecided[w] =
+                         (bits == 64) ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+                   },
+                   galois::no_stats());
+
+    bool first = true;
+    while (first || !cur->empty()) {
+      if (first) {
+        select(galois::iterate(graph), graph, selected);
+      } else {
+        select(galois::iterate(*cur), graph, selected);
+      }
+
+      galois::do_all(
+          galois::iterate(selected),
+          [&](const GNode& src) {
+            graph.getData(src, galois::MethodFlag::UNPROTECTED).flag = MATCHED;
+            decide(src);
+            for (auto edge :
+                 graph.out_edges(src, galois::MethodFlag::UNPROTECTED)) {
+              GNode dst = graph.getEdgeDst(edge);
+              if (dst == src)
+                continue;
+              graph.getData(dst, galois::MethodFlag::UNPROTECTED).flag =
+                  OTHER_MATCHED;
+              decide(dst);
+            }
+          },
+          galois::steal(), galois::loopname("update"));
+
+      numFrontier.reset();
+      auto keepUndecided = [&](const GNode& src) {
+        if (isUndecided(src)) {
+          next->push_back(src);
+          numFrontier += 1;
+        }
+      };
+      if (first) {
+        galois::do_all(galois::iterate(graph), keepUndecided, galois::steal(),
+                       galois::loopname("compact"));
+      } else {
+        galois::do_all(galois::iterate(*cur), keepUndecided, galois::steal(),
+                       galois::loopname("compact"));
+      }
+
+      if (rounds < 8) {
+        galois::runtime::reportStat_Single(
+            "IndependentSet-DetPrioAlgo",
+            "Frontier" + std::to_string(rounds), numFrontier.reduce());
+      }
+
+      cur->clear();
+      selected.clear();
+      std::swap(cur, next);
+      first = false;
+      rounds += 1;
+    }
+
+    galois::runtime::reportStat_Single("IndependentSet-DetPrioAlgo", "rounds",
+                                       rounds);
+  }
+};
+
 template <typename Graph>
 struct is_bad {
   using GNode = typename Graph::GraphNode;
@@ -717,6 +853,9 @@ int main(int argc, char** argv) {
   case edgetiledprio:
     run<EdgeTiledPrioAlgo>();
     break;
+  case detPrio:
+    run<DetPrioAlgo>();
+    break;
   default:
     std::cerr << "Unknown algorithm" << algo << "\n";
     abort();
@@ -0,0 +1,516 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Bag.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "llvm/Support/CommandLine.h"
+#include "Lonestar/BoilerPlate.h"
+
+#include <atomic>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+const char* name = "k-core decomposition";
+const char* desc = "Computes the core number of every node in a symmetric "
+                   "graph by parallel bucketed peeling";
+const char* url  = 0;
+
+namespace cll = llvm::cl;
+static cll::opt<std::string>
+    inputFilename(cll::Positional, cll::desc("<input file>"), cll::Required);
+static cll::opt<unsigned int>
+    reportNode("reportNode",
+               cll::desc("Node to report core number of (default value 0)"),
+               cll::init(0));
+
+enum Algo { Histogram, Atomic };
+
+static cll::opt<Algo> algo(
+    "algo",
+    cll::desc("Choose how a round updates degrees (default value "
+              "Histogram):"),
+    cll::values(clEnumVal(Histogram, "Count the decrements of each neighbor "
+                                     "without atomics, then apply them once"),
+                clEnumVal(Atomic, "Decrement degrees atomically per edge"),
+                clEnumValEnd),
+    cll::init(Histogram));
+
+constexpr static const unsigned CHUNK_SIZE = 64u;
+//! number of consecutive degrees that get a bucket of their own; nodes of
+//! higher degree wait in a single overflow bucket
+constexpr static const uint32_t NUM_OPEN_BUCKETS = 128u;
+constexpr static const uint32_t UNPEELED = std::numeric_limits<uint32_t>::max();
+
+struct NodeData {
+  //! number of edges to nodes that have not been peeled yet
+  std::atomic<uint32_t> degree;
+  //! Atomic: last peeling round in which degree was decremented;
+  //! Histogram: decrements counted for the node in the current round
+  std::atomic<uint32_t> touched;
+  uint32_t core;
+};
+
+typedef galois::graphs::LC_CSR_Graph<NodeData, void>::with_numa_alloc<
+    true>::type ::with_no_lockable<true>::type Graph;
+typedef Graph::GraphNode GNode;
+
+/**
+ * Bucket array in the style of Julienne. The open buckets hold the degrees
+ * [base, base + NUM_OPEN_BUCKETS); every node of higher degree sits in the
+ * overflow bucket until the open range is used up, at which point the
+ * overflow is redistributed from the smallest remaining degree.
+ *
+ * Entries are never removed: a node is pushed again whenever its degree
+ * moves to another open bucket, and an entry is stale once its node has been
+ * peeled or its degree no longer matches the bucket. Since degrees only
+ * decrease, a node is in any bucket at most once.
+ */
+class PeelBuckets {
+  typedef galois::InsertBag<GNode> Bag;
+
+  Graph& graph;
+  uint32_t base;
+  std::vector<Bag> open;
+  Bag overflow[2];
+  unsigned curOverflow;
+
+public:
+  explicit PeelBuckets(Graph& g)
+      : graph(g), base(0), open(NUM_OPEN_BUCKETS), curOverflow(0) {}
+
+  uint32_t begin() const { return base; }
+
+  bool isOpen(uint32_t degree) const {
+    return degree < base + NUM_OPEN_BUCKETS;
+  }
+
+  //! Pushes a node with degree >= begin()
+  void push(GNode n, uint32_t degree) {
+    if (isOpen(degree)) {
+      open[degree - base].push(n);
+    } else {
+      overflow[curOverflow].push(n);
+    }
+  }
+
+  Bag& bucket(uint32_t degree) { return open[degree - base]; }
+
+  /**
+   * Moves the open range to start at the smallest degree of an unpeeled node
+   * in the overflow bucket. All open buckets must have been drained.
+   *
+   * @returns false if no unpeeled node is left
+   */
+  bool refill() {
+    Bag& old = overflow[curOverflow];
+    galois::GReduceMin<uint32_t> minDegree;
+
+    galois::do_all(galois::iterate(old),
+                   [&](GNode n) {
+                     NodeData& data = graph.getData(n);
+                     if (data.core == UNPEELED) {
+                       minDegree.update(data.degree);
+                     }
+                   },
+                   galois::steal(), galois::no_stats(),
+                   galois::loopname("FindMinDegree"));
+
+    uint32_t next = minDegree.reduce();
+    if (next == std::numeric_limits<uint32_t>::max()) {
+      old.clear();
+      return false;
+    }
+
+    base       = next;
+    curOverflow ^= 1;
+    galois::do_all(galois::iterate(old),
+                   [&](GNode n) {
+                     NodeData& data = graph.getData(n);
+                     if (data.core == UNPEELED) {
+                       push(n, data.degree);
+                     }
+                   },
+                   galois::steal(), galois::no_stats(),
+                   galois::loopname("RedistributeOverflow"));
+    old.clear();
+    return true;
+  }
+};
+
+typedef galois::InsertBag<GNode> Frontier;
+
+/**
+ * Moves a node whose degree dropped in this round: it joins the next
+ * frontier if its degree reached k, and the bucket of its new degree
+ * otherwise.
+ */
+inline void settle(Graph& graph, GNode n, uint32_t degree, uint32_t k,
+                   Frontier& next, PeelBuckets& buckets,
+                   galois::GAccumulator<size_t>& peeled) {
+  if (degree <= k) {
+    graph.getData(n).core = k;
+    next.push(n);
+    peeled += 1;
+  } else if (buckets.isOpen(degree)) {
+    buckets.push(n, degree);
+  }
+}
+
+/**
+ * One round that decrements the degrees of the neighbors of the frontier
+ * atomically. A neighbor is recorded the first time it is decremented in
+ * the round, and is settled with its final degree once the round is done.
+ */
+class AtomicRound {
+  Graph& graph;
+  Frontier touched;
+  uint32_t round;
+
+public:
+  explicit AtomicRound(Graph& g) : graph(g), round(0) {}
+
+  void operator()(Frontier& curr, Frontier& next, PeelBuckets& buckets,
+                  uint32_t k, galois::GAccumulator<size_t>& peeled) {
+    ++round;
+
+    galois::do_all(
+        galois::iterate(curr),
+        [&](GNode n) {
+          for (auto e : graph.edges(n)) {
+            NodeData& data = graph.getData(graph.getEdgeDst(e));
+            if (data.core != UNPEELED) {
+              continue;
+            }
+            data.degree.fetch_sub(1, std::memory_order_relaxed);
+            if (data.touched.load(std::memory_order_relaxed) != round &&
+                data.touched.exchange(round) != round) {
+              touched.push(graph.getEdgeDst(e));
+            }
+          }
+        },
+        galois::steal(), galois::chunk_size<CHUNK_SIZE>(), galois::no_stats(),
+        galois::loopname("PeelFrontier"));
+
+    galois::do_all(galois::iterate(touched),
+                   [&](GNode n) {
+                     settle(graph, n, graph.getData(n).degree, k, next,
+                            buckets, peeled);
+                   },
+                   galois::steal(), galois::no_stats(),
+                   galois::loopname("UpdateBuckets"));
+    touched.clear();
+  }
+};
+
+/**
+ * One round that builds a histogram of the decrements instead of applying
+ * them per edge. Every thread sorts the neighbors of its part of the
+ * frontier into bins by ID range. Each bin is then owned by one thread, which
+ * counts how often each node occurs without atomic RMWs, subtracts the count
+ * from the degree once and settles the node. Hubs adjacent to much of the
+ * frontier take one update per round instead of one contended atomic per
+ * edge.
+ */
+class HistogramRound {
+  //! bins per thread; more bins than threads to balance skewed ID ranges
+  constexpr static const unsigned BINS_PER_THREAD = 4u;
+
+  Graph& graph;
+  unsigned numBins;
+  uint32_t binWidth;
+  galois::substrate::PerThreadStorage<std::vector<std::vector<GNode>>> bins;
+
+public:
+  explicit HistogramRound(Graph& g) : graph(g) {
+    numBins  = BINS_PER_THREAD * galois::getActiveThreads();
+    binWidth = (graph.size() + numBins - 1) / numBins;
+    binWidth = std::max(binWidth, 1u);
+    for (unsigned t = 0; t < bins.size(); ++t) {
+      bins.getRemote(t)->resize(numBins);
+    }
+  }
+
+  void operator()(Frontier& curr, Frontier& next, PeelBuckets& buckets,
+                  uint32_t k, galois::GAccumulator<size_t>& peeled) {
+    galois::do_all(
+        galois::iterate(curr),
+        [&](GNode n) {
+          auto& local = *bins.getLocal();
+          for (auto e : graph.edges(n)) {
+            GNode dst = graph.getEdgeDst(e);
+            if (graph.getData(dst).core == UNPEELED) {
+              local[dst / binWidth].push_back(dst);
+            }
+          }
+        },
+        galois::steal(), galois::chunk_size<CHUNK_SIZE>(), galois::no_stats(),
+        galois::loopname("GatherNeighbors"));
+
+    galois::do_all(
+        galois::iterate(0u, numBins),
+        [&](unsigned b) {
+          // count, then settle every distinct node of the bin once
+          for (unsigned t = 0; t < bins.size(); ++t) {
+            for (GNode n : (*bins.getRemote(t))[b]) {
+              auto& count = graph.getData(n).touched;
+              count.store(count.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+            }
+          }
+          for (unsigned t = 0; t < bins.size(); ++t) {
+            auto& bin = (*bins.getRemote(t))[b];
+            for (GNode n : bin) {
+              NodeData& data = graph.getData(n);
+              uint32_t count = data.touched.load(std::memory_order_relaxed);
+              if (count == 0) {
+                continue;
+              }
+              data.touched.store(0, std::memory_order_relaxed);
+              uint32_t degree = data.degree.load(std::memory_order_relaxed);
+              degree -= count;
+              data.degree.store(degree, std::memory_order_relaxed);
+              settle(graph, n, degree, k, next, buckets, peeled);
+            }
+            bin.clear();
+          }
+        },
+        galois::steal(), galois::chunk_size<1>(), galois::no_stats(),
+        galois::loopname("ApplyHistogram"));
+  }
+};
+
+/**
+ * Peels the graph one core number k at a time. Each round removes a
+ * frontier of nodes with core number k and lowers the degrees of their
+ * unpeeled neighbors with PeelRound. Every affected node is then looked at
+ * once, with its final degree for the round: nodes whose degree dropped to
+ * k or below form the next frontier, and the rest move to the bucket of
+ * their new degree.
+ */
+template <typename PeelRound>
+void kcoreBucketed(Graph& graph) {
+  PeelBuckets buckets(graph);
+  PeelRound peelRound(graph);
+  Frontier frontiers[2];
+  galois::GAccumulator<size_t> peeled;
+
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   NodeData& data = graph.getData(n);
+                   uint32_t degree =
+                       std::distance(graph.edge_begin(n), graph.edge_end(n));
+                   data.degree  = degree;
+                   data.touched = 0;
+                   data.core    = UNPEELED;
+                   buckets.push(n, degree);
+                 },
+                 galois::steal(), galois::no_stats(),
+                 galois::loopname("Initialize"));
+
+  size_t numPeeled = 0;
+  uint32_t round   = 0;
+  uint32_t k       = 0;
+
+  while (numPeeled < graph.size()) {
+    if (!buckets.isOpen(k)) {
+      if (!buckets.refill()) {
+        break;
+      }
+      k = buckets.begin();
+    }
+
+    Frontier* curr = &frontiers[0];
+    Frontier* next = &frontiers[1];
+
+    auto& bucket = buckets.bucket(k);
+    if (bucket.empty()) {
+      ++k;
+      continue;
+    }
+
+    galois::do_all(galois::iterate(bucket),
+                   [&](GNode n) {
+                     NodeData& data = graph.getData(n);
+                     if (data.core == UNPEELED && data.degree == k) {
+                       data.core = k;
+                       curr->push(n);
+                       peeled += 1;
+                     }
+                   },
+                   galois::steal(), galois::no_stats(),
+                   galois::loopname("ExtractBucket"));
+    bucket.clear();
+
+    while (!curr->empty()) {
+      ++round;
+      peelRound(*curr, *next, buckets, k, peeled);
+      curr->clear();
+      std::swap(curr, next);
+    }
+
+    numPeeled += peeled.reduce();
+    peeled.reset();
+    ++k;
+  }
+
+  galois::runtime::reportStat_Single("KCore", "rounds", round);
+}
+
+//! Serial O(m) algorithm of Batagelj and Zaversnik
+std::vector<uint32_t> serialCores(Graph& graph) {
+  size_t n = graph.size();
+  std::vector<uint32_t> degree(n);
+  uint32_t maxDegree = 0;
+  for (GNode v : graph) {
+    degree[v] = std::distance(graph.edge_begin(v), graph.edge_end(v));
+    maxDegree = std::max(maxDegree, degree[v]);
+  }
+
+  // bin sort the nodes by degree
+  std::vector<size_t> binStart(maxDegree + 2, 0);
+  for (GNode v : graph) {
+    ++binStart[degree[v] + 1];
+  }
+  for (uint32_t d = 1; d <= maxDegree + 1; ++d) {
+    binStart[d] += binStart[d - 1];
+  }
+  std::vector<GNode> order(n);
+  std::vector<size_t> pos(n);
+  {
+    std::vector<size_t> fill(binStart.begin(), binStart.end() - 1);
+    for (GNode v : graph) {
+      pos[v]        = fill[degree[v]]++;
+      order[pos[v]] = v;
+    }
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    GNode v = order[i];
+    for (auto e : graph.edges(v)) {
+      GNode u = graph.getEdgeDst(e);
+      if (degree[u] > degree[v]) {
+        // swap u with the first node of its bin and shrink the bin
+        uint32_t du = degree[u];
+        size_t pu   = pos[u];
+        size_t pw   = binStart[du];
+        GNode w     = order[pw];
+        if (u != w) {
+          order[pu] = w;
+          pos[w]    = pu;
+          order[pw] = u;
+          pos[u]    = pw;
+        }
+        ++binStart[du];
+        --degree[u];
+      }
+    }
+  }
+
+  return degree;
+}
+
+bool verify(Graph& graph) {
+  std::vector<uint32_t> expected = serialCores(graph);
+  galois::GAccumulator<size_t> mismatches;
+
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   if (graph.getData(n).core != expected[n]) {
+                     mismatches += 1;
+                   }
+                 },
+                 galois::no_stats(), galois::loopname("Verify"));
+
+  if (mismatches.reduce() != 0) {
+    std::cerr << mismatches.reduce() << " nodes have a wrong core number\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  Graph graph;
+  galois::graphs::readGraph(graph, inputFilename);
+  std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
+            << " edges\n";
+
+  if (reportNode >= graph.size()) {
+    std::cerr << "failed to set report node: " << reportNode << "\n";
+    abort();
+  }
+
+  galois::preAlloc(numThreads +
+                   4 * graph.size() * sizeof(GNode) /
+                       galois::runtime::pagePoolSize());
+  galois::reportPageAlloc("MeminfoPre");
+
+  galois::StatTimer T;
+  T.start();
+  switch (algo) {
+  case Histogram:
+    kcoreBucketed<HistogramRound>(graph);
+    break;
+  case Atomic:
+    kcoreBucketed<AtomicRound>(graph);
+    break;
+  default:
+    std::cerr << "Unknown algorithm\n";
+    abort();
+  }
+  T.stop();
+
+  galois::reportPageAlloc("MeminfoPost");
+
+  galois::GReduceMax<uint32_t> maxCore;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) { maxCore.update(graph.getData(n).core); },
+                 galois::no_stats(), galois::loopname("MaxCore"));
+  galois::GAccumulator<size_t> maxCoreSize;
+  uint32_t degeneracy = maxCore.reduce();
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   if (graph.getData(n).core == degeneracy) {
+                     maxCoreSize += 1;
+                   }
+                 },
+                 galois::no_stats(), galois::loopname("MaxCoreSize"));
+
+  std::cout << "Maximum core number: " << degeneracy << " ("
+            << maxCoreSize.reduce() << " nodes)\n";
+  std::cout << "Node " << reportNode << " has core number "
+            << graph.getData(reportNode).core << "\n";
+
+  if (!skipVerify) {
+    if (verify(graph)) {
+      std::cout << "Verification successful.\n";
+    } else {
+      GALOIS_DIE("Verification failed");
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,579 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "llvm/Support/CommandLine.h"
+#include "Lonestar/BoilerPlate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+const char* name = "Louvain";
+const char* desc = "Detects communities in a symmetric graph by parallel "
+                   "Louvain modularity optimization";
+const char* url  = 0;
+
+namespace cll = llvm::cl;
+static cll::opt<std::string>
+    inputFilename(cll::Positional, cll::desc("<input graph (symmetric)>"),
+                  cll::Required);
+static cll::opt<double>
+    threshold("threshold",
+              cll::desc("Minimum modularity gain of a round to keep moving "
+                        "nodes on a level (default value 1e-6)"),
+              cll::init(1e-6));
+static cll::opt<unsigned>
+    maxIterations("maxIterations",
+                  cll::desc("Maximum number of rounds per level (default "
+                            "value 100)"),
+                  cll::init(100));
+static cll::opt<unsigned>
+    maxLevels("maxLevels",
+              cll::desc("Maximum number of levels (default value 100)"),
+              cll::init(100));
+
+//! Input graph; every edge has weight 1
+typedef galois::graphs::LC_CSR_Graph<void, void>::with_numa_alloc<
+    true>::type ::with_no_lockable<true>::type InputGraph;
+//! Graph of the communities of the level below. Built in memory, so it
+//! has no NUMA-aware local ranges (those are set up by readGraph).
+typedef galois::graphs::LC_CSR_Graph<void, uint64_t>::with_no_lockable<
+    true>::type CoarseGraph;
+typedef InputGraph::GraphNode GNode;
+
+uint64_t edgeWeight(InputGraph&, InputGraph::edge_iterator) { return 1; }
+
+uint64_t edgeWeight(CoarseGraph& graph, CoarseGraph::edge_iterator ii) {
+  return graph.getEdgeData(ii);
+}
+
+/**
+ * Replaces a[0, n) by its exclusive prefix sum and returns the total. Runs
+ * as two blocked do_all passes around a serial scan of the block sums.
+ */
+template <typename T>
+T prefixSum(galois::LargeArray<T>& a, size_t n) {
+  constexpr size_t BLOCK_SIZE = 1 << 14;
+  size_t numBlocks            = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  std::vector<T> blockSums(numBlocks + 1, 0);
+
+  galois::do_all(galois::iterate(size_t{0}, numBlocks),
+                 [&](size_t b) {
+                   size_t end = std::min(n, (b + 1) * BLOCK_SIZE);
+                   T sum      = 0;
+                   for (size_t i = b * BLOCK_SIZE; i < end; ++i)
+                     sum += a[i];
+                   blockSums[b + 1] = sum;
+                 },
+                 galois::no_stats());
+
+  for (size_t b = 0; b < numBlocks; ++b)
+    blockSums[b + 1] += blockSums[b];
+
+  galois::do_all(galois::iterate(size_t{0}, numBlocks),
+                 [&](size_t b) {
+                   size_t end = std::min(n, (b + 1) * BLOCK_SIZE);
+                   T sum      = blockSums[b];
+                   for (size_t i = b * BLOCK_SIZE; i < end; ++i) {
+                     T count = a[i];
+                     a[i]    = sum;
+                     sum += count;
+                   }
+                 },
+                 galois::no_stats());
+
+  return blockSums[numBlocks];
+}
+
+//! key of a free slot of CommunityWeights
+constexpr static const uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+
+/**
+ * Per-thread open-addressing map from community to the weight of the edges
+ * to it. The table grows to twice the largest number of keys it is prepared
+ * for and is cleared by visiting only the slots in use.
+ */
+class CommunityWeights {
+  std::vector<uint32_t> keys;
+  std::vector<uint64_t> weights;
+  std::vector<uint32_t> used;
+  uint32_t mask = 0;
+
+  uint32_t slot(uint32_t key) const {
+    return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+  }
+
+public:
+  //! Makes room for up to maxKeys keys and clears the map
+  void prepare(size_t maxKeys) {
+    clear();
+    if (keys.empty() || keys.size() < 2 * maxKeys) {
+      size_t capacity = 16;
+      while (capacity < 2 * maxKeys)
+        capacity *= 2;
+      keys.assign(capacity, EMPTY);
+      weights.resize(capacity);
+      mask = capacity - 1;
+    }
+  }
+
+  void add(uint32_t key, uint64_t weight) {
+    uint32_t s = slot(key);
+    while (keys[s] != EMPTY && keys[s] != key)
+      s = (s + 1) & mask;
+    if (keys[s] == EMPTY) {
+      keys[s]    = key;
+      weights[s] = weight;
+      used.push_back(s);
+    } else {
+      weights[s] += weight;
+    }
+  }
+
+  //! Weight of key, 0 if absent
+  uint64_t get(uint32_t key) const {
+    for (uint32_t s = slot(key); keys[s] != EMPTY; s = (s + 1) & mask) {
+      if (keys[s] == key)
+        return weights[s];
+    }
+    return 0;
+  }
+
+  size_t size() const { return used.size(); }
+
+  //! Calls fn(key, weight) for every key in insertion order
+  template <typename Fn>
+  void forEach(Fn fn) const {
+    for (uint32_t s : used)
+      fn(keys[s], weights[s]);
+  }
+
+  void clear() {
+    for (uint32_t s : used)
+      keys[s] = EMPTY;
+    used.clear();
+  }
+};
+
+typedef galois::substrate::PerThreadStorage<CommunityWeights> Scratch;
+
+/**
+ * Community state of one level. Community ids are node ids of the level's
+ * graph; a community is named after any of its nodes initially.
+ */
+struct Level {
+  size_t numNodes;
+  //! sum of the weights of all edges; twice the total weight
+  uint64_t m2;
+  //! weighted degree of each node, self loops included
+  galois::LargeArray<uint64_t> degree;
+  //! community of each node
+  galois::LargeArray<uint32_t> community;
+  //! sum of the degrees of the nodes of each community
+  galois::LargeArray<std::atomic<uint64_t>> total;
+  //! number of nodes in each community
+  galois::LargeArray<std::atomic<uint32_t>> size;
+};
+
+template <typename Graph>
+void initLevel(Graph& graph, Level& level) {
+  level.numNodes = graph.size();
+  level.degree.allocateInterleaved(level.numNodes);
+  level.community.allocateInterleaved(level.numNodes);
+  level.total.allocateInterleaved(level.numNodes);
+  level.size.allocateInterleaved(level.numNodes);
+
+  galois::GAccumulator<uint64_t> m2;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   uint64_t d = 0;
+                   for (auto ii :
+                        graph.edges(n, galois::MethodFlag::UNPROTECTED))
+                     d += edgeWeight(graph, ii);
+                   level.degree[n]    = d;
+                   level.community[n] = n;
+                   level.total[n]     = d;
+                   level.size[n]      = 1;
+                   m2 += d;
+                 },
+                 galois::steal(), galois::no_stats(),
+                 galois::loopname("InitLevel"));
+  level.m2 = m2.reduce();
+}
+
+/**
+ * Modularity of the current communities: the fraction of edge weight inside
+ * communities minus its expected value, sum_c (total_c / m2)^2.
+ */
+template <typename Graph>
+double modularity(Graph& graph, Level& level) {
+  galois::GAccumulator<uint64_t> internal;
+  galois::GAccumulator<double> expected;
+
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   uint32_t c = level.community[n];
+                   uint64_t w = 0;
+                   for (auto ii :
+                        graph.edges(n, galois::MethodFlag::UNPROTECTED)) {
+                     if (level.community[graph.getEdgeDst(ii)] == c)
+                       w += edgeWeight(graph, ii);
+                   }
+                   internal += w;
+                   double t = static_cast<double>(level.total[n]) / level.m2;
+                   expected += t * t;
+                 },
+                 galois::steal(), galois::no_stats(),
+                 galois::loopname("Modularity"));
+
+  return static_cast<double>(internal.reduce()) / level.m2 - expected.reduce();
+}
+
+/**
+ * Louvain local moving phase. In each round, all nodes are visited in
+ * parallel, and each moves to the neighboring community with the highest
+ * modularity gain if that beats staying. Community totals are updated
+ * atomically as nodes move, so later nodes of a round see earlier moves.
+ * To keep pairs of singletons from swapping forever, a singleton only
+ * joins another singleton of smaller id.
+ *
+ * @returns number of rounds
+ */
+template <typename Graph>
+unsigned moveNodes(Graph& graph, Level& level, Scratch& scratch,
+                   double& quality) {
+  const double m2 = static_cast<double>(level.m2);
+  unsigned rounds = 0;
+
+  quality = modularity(graph, level);
+
+  while (rounds < maxIterations) {
+    galois::GAccumulator<size_t> moved;
+
+    galois::do_all(
+        galois::iterate(graph),
+        [&](GNode n) {
+          CommunityWeights& weights = *scratch.getLocal();
+          weights.prepare(std::distance(
+              graph.edge_begin(n, galois::MethodFlag::UNPROTECTED),
+              graph.edge_end(n, galois::MethodFlag::UNPROTECTED)));
+
+          for (auto ii : graph.edges(n, galois::MethodFlag::UNPROTECTED)) {
+            GNode dst = graph.getEdgeDst(ii);
+            if (dst != n)
+              weights.add(level.community[dst], edgeWeight(graph, ii));
+          }
+
+          const uint32_t cur   = level.community[n];
+          const double degree  = level.degree[n];
+          const double scale   = degree / m2;
+          const bool singleton = level.size[cur] == 1;
+
+          // gains relative to n being on its own
+          uint32_t best = cur;
+          double bestGain =
+              weights.get(cur) - scale * (level.total[cur] - level.degree[n]);
+
+          weights.forEach([&](uint32_t c, uint64_t w) {
+            if (c == cur)
+              return;
+            if (singleton && c > cur && level.size[c] == 1)
+              return;
+            double gain = w - scale * level.total[c];
+            if (gain > bestGain || (gain == bestGain && best != cur && c < best)) {
+              best     = c;
+              bestGain = gain;
+            }
+          });
+
+          if (best != cur) {
+            level.total[cur] -= level.degree[n];
+            level.total[best] += level.degree[n];
+            level.size[cur] -= 1;
+            level.size[best] += 1;
+            level.community[n] = best;
+            moved += 1;
+          }
+        },
+        galois::steal(), galois::loopname("MoveNodes"));
+
+    rounds += 1;
+
+    double next = modularity(graph, level);
+    double gain = next - quality;
+    quality     = next;
+    if (moved.reduce() == 0 || gain < threshold)
+      break;
+  }
+
+  return rounds;
+}
+
+/**
+ * Renumbers the non-empty communities densely (in order of their ids) and
+ * builds the graph of communities: an edge between 2 communities weighs as
+ * much as all edges between their nodes, and the edges inside a community
+ * become a self loop. Nodes are grouped by community with a counting sort;
+ * the edges of each community are aggregated in the per-thread map twice,
+ * once to size the CSR by a prefix sum of the degrees and once to fill it.
+ *
+ * @returns number of communities
+ */
+template <typename Graph>
+uint32_t coarsen(Graph& graph, Level& level, Scratch& scratch,
+                 CoarseGraph& coarse) {
+  const size_t numNodes = level.numNodes;
+
+  galois::LargeArray<uint32_t> newId;
+  newId.allocateInterleaved(numNodes);
+  galois::do_all(galois::iterate(size_t{0}, numNodes),
+                 [&](size_t c) { newId[c] = level.size[c] > 0 ? 1 : 0; },
+                 galois::no_stats());
+  uint32_t numCommunities = prefixSum(newId, numNodes);
+
+  galois::LargeArray<uint64_t> memberStart;
+  memberStart.allocateInterleaved(numCommunities + 1);
+  galois::do_all(galois::iterate(size_t{0}, numNodes),
+                 [&](size_t c) {
+                   if (level.size[c] > 0)
+                     memberStart[newId[c]] = level.size[c];
+                 },
+                 galois::no_stats());
+  prefixSum(memberStart, numCommunities);
+  memberStart[numCommunities] = numNodes;
+
+  galois::do_all(galois::iterate(size_t{0}, numNodes),
+                 [&](size_t n) {
+                   level.community[n] = newId[level.community[n]];
+                 },
+                 galois::no_stats());
+
+  galois::LargeArray<std::atomic<uint64_t>> cursor;
+  cursor.allocateInterleaved(numCommunities);
+  galois::do_all(galois::iterate(size_t{0}, size_t{numCommunities}),
+                 [&](size_t c) { cursor[c] = memberStart[c]; },
+                 galois::no_stats());
+
+  galois::LargeArray<GNode> members;
+  members.allocateInterleaved(numNodes);
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   members[cursor[level.community[n]]++] = n;
+                 },
+                 galois::no_stats());
+
+  auto aggregate = [&](uint32_t c, CommunityWeights& weights) {
+    size_t edges = 0;
+    for (uint64_t i = memberStart[c]; i < memberStart[c + 1]; ++i) {
+      edges += std::distance(
+          graph.edge_begin(members[i], galois::MethodFlag::UNPROTECTED),
+          graph.edge_end(members[i], galois::MethodFlag::UNPROTECTED));
+    }
+    weights.prepare(std::min<size_t>(edges, numCommunities));
+    for (uint64_t i = memberStart[c]; i < memberStart[c + 1]; ++i) {
+      for (auto ii :
+           graph.edges(members[i], galois::MethodFlag::UNPROTECTED)) {
+        weights.add(level.community[graph.getEdgeDst(ii)],
+                    edgeWeight(graph, ii));
+      }
+    }
+  };
+
+  galois::LargeArray<uint64_t> edgeStart;
+  edgeStart.allocateInterleaved(numCommunities + 1);
+  galois::do_all(galois::iterate(size_t{0}, size_t{numCommunities}),
+                 [&](size_t c) {
+                   CommunityWeights& weights = *scratch.getLocal();
+                   aggregate(c, weights);
+                   edgeStart[c] = weights.size();
+                 },
+                 galois::steal(), galois::loopname("CountCoarseEdges"));
+  uint64_t numEdges = prefixSum(edgeStart, numCommunities);
+
+  coarse.allocateFrom(numCommunities, numEdges);
+  coarse.constructNodes();
+
+  galois::do_all(galois::iterate(size_t{0}, size_t{numCommunities}),
+                 [&](size_t c) {
+                   CommunityWeights& weights = *scratch.getLocal();
+                   aggregate(c, weights);
+                   uint64_t e = edgeStart[c];
+                   weights.forEach([&](uint32_t dst, uint64_t w) {
+                     coarse.constructEdge(e++, dst, w);
+                   });
+                   coarse.fixEndEdge(c, e);
+                   coarse.sortEdgesByDst(c, galois::MethodFlag::UNPROTECTED);
+                 },
+                 galois::steal(), galois::loopname("BuildCoarseEdges"));
+
+  return numCommunities;
+}
+
+//! Runs one level; returns true if it merged any nodes
+template <typename Graph>
+bool runLevel(Graph& graph, unsigned levelNum, Scratch& scratch,
+              galois::LargeArray<uint32_t>& assignment, CoarseGraph& coarse,
+              double& quality) {
+  galois::Timer timer;
+  timer.start();
+
+  Level level;
+  initLevel(graph, level);
+
+  if (level.m2 == 0) {
+    quality = 0;
+    return false;
+  }
+
+  unsigned rounds = moveNodes(graph, level, scratch, quality);
+  uint32_t numCommunities = coarsen(graph, level, scratch, coarse);
+
+  galois::do_all(galois::iterate(size_t{0}, assignment.size()),
+                 [&](size_t n) { assignment[n] = level.community[assignment[n]]; },
+                 galois::no_stats());
+
+  timer.stop();
+
+  std::cout << "Level " << levelNum << ": " << level.numNodes << " nodes, "
+            << numCommunities << " communities, " << rounds
+            << " rounds, modularity " << quality << ", " << timer.get()
+            << " ms\n";
+
+  std::string prefix = "Level" + std::to_string(levelNum) + "_";
+  galois::runtime::reportStat_Single("Louvain", prefix + "Nodes",
+                                     level.numNodes);
+  galois::runtime::reportStat_Single("Louvain", prefix + "Communities",
+                                     numCommunities);
+  galois::runtime::reportStat_Single("Louvain", prefix + "Rounds", rounds);
+  galois::runtime::reportStat_Single("Louvain", prefix + "Modularity",
+                                     quality);
+  galois::runtime::reportStat_Single("Louvain", prefix + "TimeMs",
+                                     timer.get());
+
+  return numCommunities < level.numNodes;
+}
+
+//! Recomputes the modularity of the final communities on the input graph
+double checkModularity(InputGraph& graph,
+                       galois::LargeArray<uint32_t>& assignment) {
+  galois::LargeArray<std::atomic<uint64_t>> total;
+  total.allocateInterleaved(graph.size());
+  galois::do_all(galois::iterate(graph), [&](GNode n) { total[n] = 0; },
+                 galois::no_stats());
+
+  galois::GAccumulator<uint64_t> internal;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   uint64_t degree = 0;
+                   for (auto ii : graph.edges(n)) {
+                     degree += 1;
+                     if (assignment[graph.getEdgeDst(ii)] == assignment[n])
+                       internal += 1;
+                   }
+                   total[assignment[n]] += degree;
+                 },
+                 galois::steal(), galois::no_stats());
+
+  galois::GAccumulator<double> expected;
+  double m2 = graph.sizeEdges();
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode c) {
+                   double t = total[c] / m2;
+                   expected += t * t;
+                 },
+                 galois::no_stats());
+
+  return internal.reduce() / m2 - expected.reduce();
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  InputGraph graph;
+  galois::graphs::readGraph(graph, inputFilename);
+  std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
+            << " edges\n";
+
+  galois::preAlloc(numThreads +
+                   8 * graph.size() * sizeof(uint64_t) /
+                       galois::runtime::pagePoolSize());
+  galois::reportPageAlloc("MeminfoPre");
+
+  galois::LargeArray<uint32_t> assignment;
+  assignment.allocateInterleaved(graph.size());
+  galois::do_all(galois::iterate(graph), [&](GNode n) { assignment[n] = n; },
+                 galois::no_stats());
+
+  Scratch scratch;
+  double quality  = 0;
+  unsigned levels = 0;
+
+  galois::StatTimer T;
+  T.start();
+
+  std::unique_ptr<CoarseGraph> coarse(new CoarseGraph);
+  bool merged = runLevel(graph, levels++, scratch, assignment, *coarse, quality);
+
+  while (merged && levels < maxLevels) {
+    std::unique_ptr<CoarseGraph> next(new CoarseGraph);
+    double previous = quality;
+    merged = runLevel(*coarse, levels++, scratch, assignment, *next, quality);
+    coarse = std::move(next);
+    if (quality - previous < threshold)
+      break;
+  }
+
+  T.stop();
+
+  galois::reportPageAlloc("MeminfoPost");
+
+  galois::GReduceMax<uint32_t> maxCommunity;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) { maxCommunity.update(assignment[n]); },
+                 galois::no_stats());
+
+  std::cout << "Levels: " << levels << "\n";
+  std::cout << "Communities: " << maxCommunity.reduce() + 1 << "\n";
+  std::cout << "Modularity: " << quality << "\n";
+  galois::runtime::reportStat_Single("Louvain", "Modularity", quality);
+
+  if (!skipVerify) {
+    double check = checkModularity(graph, assignment);
+    if (std::fabs(check - quality) > 1e-6) {
+      std::cerr << "recomputed modularity " << check << " differs from "
+                << quality << "\n";
+      GALOIS_DIE("verification failed");
+    }
+    std::cout << "Verification successful.\n";
+  }
+
+  return 0;
+}
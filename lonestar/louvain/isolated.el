@@ -0,0 +1,8 @@
+1 2
+2 1
+1 3
+3 1
+2 3
+3 2
+4 5
+5 4
@@ -0,0 +1,247 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef _LATENT_STORE_H_
+#define _LATENT_STORE_H_
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Dense store of the latent vectors of all nodes.
+ *
+ * Vectors are kept in one contiguous LargeArray, one row per node. The array
+ * is page (hence cache line) aligned, and each row is padded to a multiple of
+ * 32 bytes so that every row is aligned for the widest vectors the kernels
+ * below use and they can work on whole vectors without remainder loops.
+ * Rows are not padded to full cache lines: for the common sizes that would
+ * grow the working set (e.g., 20 doubles to 24) for no gain. Padding is
+ * zeroed and stays zero under the kernels.
+ *
+ * @tparam T element type (float or double)
+ */
+template <typename T>
+class LatentStore {
+  static_assert(std::is_floating_point<T>::value,
+                "latent values must be floating point");
+
+public:
+  //! Row alignment in bytes
+  static const size_t ROW_ALIGNMENT = 32;
+
+private:
+  galois::LargeArray<T> data;
+  size_t numNodes;
+  size_t dim;
+  size_t rowStride;
+
+public:
+  LatentStore() : numNodes(0), dim(0), rowStride(0) {}
+
+  /**
+   * Allocates (interleaved across NUMA nodes) and zeroes a row of
+   * dimension elements for each of n nodes.
+   */
+  void allocate(size_t n, size_t dimension) {
+    assert(dimension > 0);
+    const size_t perRowUnit = ROW_ALIGNMENT / sizeof(T);
+
+    numNodes  = n;
+    dim       = dimension;
+    rowStride = (dimension + perRowUnit - 1) / perRowUnit * perRowUnit;
+
+    data.deallocate();
+    data.allocateInterleaved(numNodes * rowStride);
+    galois::do_all(galois::iterate(size_t{0}, numNodes),
+                   [&](size_t i) {
+                     std::memset(&data[i * rowStride], 0,
+                                 rowStride * sizeof(T));
+                   },
+                   galois::no_stats(), galois::loopname("LatentStoreInit"));
+  }
+
+  //! Returns the latent vector of node n
+  T* operator[](size_t n) {
+    assert(n < numNodes);
+    return &data[n * rowStride];
+  }
+
+  const T* operator[](size_t n) const {
+    assert(n < numNodes);
+    return &data[n * rowStride];
+  }
+
+  //! Number of nodes
+  size_t size() const { return numNodes; }
+  //! Number of meaningful elements in each vector
+  size_t dimension() const { return dim; }
+  //! Distance in elements between the starts of consecutive vectors
+  size_t stride() const { return rowStride; }
+};
+
+//! Width in bytes of the SIMD vectors used by LatentKernel. Matches the
+//! native register width of the target: wider generic vectors are split
+//! through the stack when broadcasting scalars.
+#ifdef __AVX__
+static const size_t LATENT_VECTOR_BYTES = 32;
+#else
+static const size_t LATENT_VECTOR_BYTES = 16;
+#endif
+
+/**
+ * SIMD kernels over padded rows of a LatentStore, written with GCC vector
+ * extensions so the same code lowers to AVX, SSE or NEON.
+ *
+ * @tparam T element type
+ * @tparam Stride row stride known at compile time; 0 if only known at
+ * runtime
+ */
+template <typename T, size_t Stride>
+class LatentKernel {
+  typedef T Vec __attribute__((vector_size(LATENT_VECTOR_BYTES)));
+
+  static const size_t WIDTH = sizeof(Vec) / sizeof(T);
+  static_assert(Stride % WIDTH == 0, "stride must be a multiple of a vector");
+
+  size_t runtimeStride;
+
+  size_t length() const { return Stride ? Stride : runtimeStride; }
+
+  static Vec load(const T* p) {
+    return *reinterpret_cast<const Vec*>(
+        __builtin_assume_aligned(p, sizeof(Vec)));
+  }
+
+  static void store(T* p, Vec v) {
+    *reinterpret_cast<Vec*>(__builtin_assume_aligned(p, sizeof(Vec))) = v;
+  }
+
+public:
+  explicit LatentKernel(size_t stride = Stride) : runtimeStride(stride) {
+    assert(length() % WIDTH == 0);
+  }
+
+  //! Inner product of 2 latent vectors
+  T dot(const T* __restrict__ a, const T* __restrict__ b) const {
+    const size_t n = length();
+    // two independent accumulators to hide FMA latency
+    Vec acc0 = {};
+    Vec acc1 = {};
+    size_t i = 0;
+    for (; i + 2 * WIDTH <= n; i += 2 * WIDTH) {
+      acc0 += load(a + i) * load(b + i);
+      acc1 += load(a + i + WIDTH) * load(b + i + WIDTH);
+    }
+    if (i < n) {
+      acc0 += load(a + i) * load(b + i);
+    }
+    acc0 += acc1;
+
+    T sum = 0;
+    for (size_t j = 0; j < WIDTH; ++j) {
+      sum += acc0[j];
+    }
+    return sum;
+  }
+
+  //! y += alpha * x
+  void axpy(T alpha, const T* __restrict__ x, T* __restrict__ y) const {
+    const size_t n = length();
+    const Vec va   = Vec{} + alpha;
+    for (size_t i = 0; i < n; i += WIDTH) {
+      store(y + i, load(y + i) + va * load(x + i));
+    }
+  }
+
+  //! Inner product of the 2 vectors minus the expected value
+  T predictionError(const T* __restrict__ itemLatent,
+                    const T* __restrict__ userLatent, double actual) const {
+    return dot(itemLatent, userLatent) - static_cast<T>(actual);
+  }
+
+  /**
+   * Objective: squared loss with weighted-square-norm regularization
+   *
+   * Updates latent vectors to reduce the error from the edge value.
+   *
+   * @param itemLatent latent vector of the item
+   * @param userLatent latent vector of the user
+   * @param lambda learning parameter
+   * @param edgeRating Data on the edge, i.e. the number that the inner product
+   * of the 2 latent vectors should eventually get to
+   * @param stepSize learning parameter: how much to adjust vectors by to
+   * correct for error
+   *
+   * @return Error before gradient update
+   */
+  T gradientUpdate(T* __restrict__ itemLatent, T* __restrict__ userLatent,
+                   double lambda, double edgeRating, double stepSize) const {
+    const size_t n = length();
+    const T error  = predictionError(itemLatent, userLatent, edgeRating);
+    const Vec e    = Vec{} + error;
+    const Vec l    = Vec{} + static_cast<T>(lambda);
+    const Vec step = Vec{} + static_cast<T>(stepSize);
+
+    // Take gradient step to reduce error
+    for (size_t i = 0; i < n; i += WIDTH) {
+      Vec prevItem = load(itemLatent + i);
+      Vec prevUser = load(userLatent + i);
+      store(itemLatent + i, prevItem - step * (e * prevUser + l * prevItem));
+      store(userLatent + i, prevUser - step * (e * prevItem + l * prevUser));
+    }
+
+    return error;
+  }
+};
+
+/**
+ * Calls fn with the LatentKernel for the given row stride. Common strides get
+ * a kernel whose loop bounds are compile-time constants; others fall back to
+ * a kernel with a runtime bound. Dispatch once outside of parallel loops.
+ *
+ * @param stride row stride of the LatentStore the kernel is used on
+ * @param fn generic callable taking the kernel by value
+ */
+template <typename T, typename Fn>
+auto withLatentKernel(size_t stride, Fn fn) {
+  switch (stride * sizeof(T)) {
+  case 64:
+    return fn(LatentKernel<T, 64 / sizeof(T)>());
+  case 128:
+    return fn(LatentKernel<T, 128 / sizeof(T)>());
+  case 160:
+    return fn(LatentKernel<T, 160 / sizeof(T)>());
+  case 256:
+    return fn(LatentKernel<T, 256 / sizeof(T)>());
+  case 512:
+    return fn(LatentKernel<T, 512 / sizeof(T)>());
+  case 1024:
+    return fn(LatentKernel<T, 1024 / sizeof(T)>());
+  case 2048:
+    return fn(LatentKernel<T, 2048 / sizeof(T)>());
+  default:
+    return fn(LatentKernel<T, 0>(stride));
+  }
+}
+
+#endif
@@ -21,7 +21,9 @@
 #include <fstream>
 #include <iostream>
 #include <ostream>
+#include <unistd.h>
 #include "matrixCompletion.h"
+#include "LatentStore.h"
 #include "galois/runtime/TiledExecutor.h"
 #include "galois/ParallelSTL.h"
 #include "galois/graphs/Graph.h"
@@ -49,6 +51,8 @@ enum Algo {
   sgdByEdges,
   sgdBlockEdge,
   sgdBlockJump,
+  sgdDiagonal,
+  sgdHogwild,
 };
 
 enum Step { bold, bottou, intel, inverse, purdue };
@@ -68,6 +72,10 @@ static cll::opt<Algo>
                         "SGD using Block jumping "),
              clEnumValN(Algo::sgdByItems, "sgdByItems", "Simple SGD on Items"),
              clEnumValN(Algo::sgdByEdges, "sgdByEdges", "Simple SGD on edges"),
+             clEnumValN(Algo::sgdDiagonal, "sgdDiagonal",
+                        "SGD over lock-free diagonal strata of tiles"),
+             clEnumValN(Algo::sgdHogwild, "sgdHogwild",
+                        "SGD over tiles without any synchronization"),
              clEnumValEnd),
          cll::init(Algo::sgdBlockEdge));
 /*
@@ -84,10 +92,19 @@ static cll::opt<Step> learningRateFunction(
 
 static cll::opt<int> cutoff("cutoff");
 
+static cll::opt<unsigned>
+    tileKB("tileKB",
+           cll::desc("sgdDiagonal/sgdHogwild: size in KB of the latent "
+                     "vectors touched by one tile (default 0: L2 size)"),
+           cll::init(0));
+
 static const unsigned ALS_CHUNK_SIZE = 4;
 
 size_t NUM_ITEM_NODES = 0;
 
+//! Latent vectors of all nodes; items first, then users
+LatentStore<LatentValue> latents;
+
 struct PurdueStepFunction : public StepFunction {
   virtual std::string name() const { return "Purdue"; }
   virtual LatentValue stepSize(int round) const {
@@ -127,16 +144,17 @@ double sumSquaredError(Graph& g) {
   // Assuming only item nodes have edges
   galois::GAccumulator<double> error;
 
-  galois::do_all(
-      galois::iterate(g.begin(), g.begin() + NUM_ITEM_NODES), [&](GNode n) {
-        for (auto ii = g.edge_begin(n), ei = g.edge_end(n); ii != ei; ++ii) {
-          GNode dst = g.getEdgeDst(ii);
-          LatentValue e =
-              predictionError(g.getData(n).latentVector,
-                              g.getData(dst).latentVector, g.getEdgeData(ii));
-          error += (e * e);
-        }
-      });
+  withLatentKernel<LatentValue>(latents.stride(), [&](auto kernel) {
+    galois::do_all(
+        galois::iterate(g.begin(), g.begin() + NUM_ITEM_NODES), [&](GNode n) {
+          for (auto ii = g.edge_begin(n), ei = g.edge_end(n); ii != ei; ++ii) {
+            GNode dst     = g.getEdgeDst(ii);
+            LatentValue e = kernel.predictionError(latents[n], latents[dst],
+                                                   g.getEdgeData(ii));
+            error += (e * e);
+          }
+        });
+  });
   return error.reduce();
 }
 
@@ -291,12 +309,20 @@ void executeUntilConverged(const StepFunction& sf, Graph& g, Fn fn) {
     unsigned long millis = curElapsed - lastTime;
     lastTime             = curElapsed;
 
-    double gflops = countFlops(g.sizeEdges(), deltaRound, LATENT_VECTOR_SIZE) /
+    double gflops = countFlops(g.sizeEdges(), deltaRound, latents.dimension()) /
                     millis / 1e6;
 
     int curRound = round + deltaRound;
     galois::gPrint("R: ", curRound, " elapsed (ms): ", curElapsed,
                    " GFLOP/s: ", gflops);
+
+    // RMSE vs. time curve
+    std::string roundName = "R" + std::to_string(curRound);
+    galois::runtime::reportStat_Single("Convergence", roundName + "_ElapsedMs",
+                                       curElapsed);
+    galois::runtime::reportStat_Single("Convergence", roundName + "_RMSE",
+                                       std::sqrt(std::abs(error /
+                                                          g.sizeEdges())));
     if (useExactError) {
       galois::gPrint(" RMSE (R ", curRound,
                      "): ", std::sqrt(error / g.sizeEdges()), "\n");
@@ -333,11 +359,7 @@ struct SGDBlockJumpAlgo {
 
   std::string name() const { return "sgdBlockJumpAlgo"; }
 
-  struct Node {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
-
-  typedef galois::graphs::LC_CSR_Graph<Node, double>
+  typedef galois::graphs::LC_CSR_Graph<void, double>
       //    ::with_numa_alloc<true>::type
       ::with_no_lockable<true>::type Graph;
   typedef Graph::GraphNode GNode;
@@ -392,8 +414,8 @@ struct SGDBlockJumpAlgo {
      * Postconditions: increments update count, does sgd update on each item
      * and user in the slice
      */
-    template <bool Enable = precomputeOffsets>
-    size_t runBlock(BlockInfo& si,
+    template <typename Kernel, bool Enable = precomputeOffsets>
+    size_t runBlock(BlockInfo& si, const Kernel& kernel,
                     typename std::enable_if<!Enable>::type* = 0) {
       typedef galois::NoDerefIterator<Graph::edge_iterator> no_deref_iterator;
       typedef boost::transform_iterator<GetDst, no_deref_iterator>
@@ -413,9 +435,9 @@ struct SGDBlockJumpAlgo {
 
       // For each item in the range
       for (; mm != em; ++mm, ++itemId) {
-        GNode item      = *mm;
-        Node& itemData  = g.getData(item);
-        size_t lastUser = si.userEnd + NUM_ITEM_NODES;
+        GNode item              = *mm;
+        LatentValue* itemLatent = latents[item];
+        size_t lastUser         = si.userEnd + NUM_ITEM_NODES;
 
         edge_dst_iterator start(no_deref_iterator(g.edge_begin(
                                     item, galois::MethodFlag::UNPROTECTED)),
@@ -433,9 +455,9 @@ struct SGDBlockJumpAlgo {
           if (user >= lastUser)
             break;
 
-          LatentValue e = doGradientUpdate(itemData.latentVector,
-                                           g.getData(user).latentVector, lambda,
-                                           g.getEdgeData(*ii.base()), stepSize);
+          LatentValue e =
+              kernel.gradientUpdate(itemLatent, latents[user], lambda,
+                                    g.getEdgeData(*ii.base()), stepSize);
           if (errorAccum)
             error += e * e;
           ++seen;
@@ -451,8 +473,9 @@ struct SGDBlockJumpAlgo {
       return seen;
     }
 
-    template <bool Enable = precomputeOffsets>
-    size_t runBlock(BlockInfo& si, typename std::enable_if<Enable>::type* = 0) {
+    template <typename Kernel, bool Enable = precomputeOffsets>
+    size_t runBlock(BlockInfo& si, const Kernel& kernel,
+                    typename std::enable_if<Enable>::type* = 0) {
       LatentValue stepSize = steps[si.updates - maxUpdates + updatesPerEdge];
       size_t seen          = 0;
       double error         = 0.0;
@@ -468,9 +491,9 @@ struct SGDBlockJumpAlgo {
         if (si.userOffsets[itemId] < 0)
           continue;
 
-        GNode item      = *mm;
-        Node& itemData  = g.getData(item);
-        size_t lastUser = si.userEnd + NUM_ITEM_NODES;
+        GNode item              = *mm;
+        LatentValue* itemLatent = latents[item];
+        size_t lastUser         = si.userEnd + NUM_ITEM_NODES;
 
         // For each edge in the range
         for (auto ii = g.edge_begin(item) + si.userOffsets[itemId],
@@ -481,9 +504,8 @@ struct SGDBlockJumpAlgo {
           if (user >= lastUser)
             break;
 
-          LatentValue e = doGradientUpdate(itemData.latentVector,
-                                           g.getData(user).latentVector, lambda,
-                                           g.getEdgeData(ii), stepSize);
+          LatentValue e = kernel.gradientUpdate(
+              itemLatent, latents[user], lambda, g.getEdgeData(ii), stepSize);
           if (errorAccum)
             error += e * e;
           ++seen;
@@ -541,16 +563,18 @@ struct SGDBlockJumpAlgo {
 
       timer.start();
 
-      while (true) {
-        sp = &blocks[getNextBlock(sp)];
-        if (sp == &blocks[numBlocks])
-          break;
-        blocksVisited += 1;
-        edgesVisited += runBlock(*sp);
+      withLatentKernel<LatentValue>(latents.stride(), [&](auto kernel) {
+        while (true) {
+          sp = &blocks[getNextBlock(sp)];
+          if (sp == &blocks[numBlocks])
+            break;
+          blocksVisited += 1;
+          edgesVisited += runBlock(*sp, kernel);
 
-        xLocks[sp->x].unlock();
-        yLocks[sp->y].unlock();
-      }
+          xLocks[sp->x].unlock();
+          yLocks[sp->y].unlock();
+        }
+      });
 
       timer.stop();
     }
@@ -645,11 +669,8 @@ struct SGDBlockJumpAlgo {
 class SGDItemsAlgo {
   static const bool makeSerializable = false;
 
-  struct BasicNode {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
-
-  using Node = BasicNode;
+  // latent vectors live in the LatentStore
+  using Node = void;
 
 public:
   bool isSgd() const { return true; }
@@ -677,24 +698,27 @@ private:
                     galois::GAccumulator<double>* errorAccum) {
 
       const LatentValue stepSize = steps[0];
-      galois::for_each(
-          galois::iterate(g.begin(), g.begin() + NUM_ITEM_NODES),
-          [&](GNode src, auto& ctx) {
-            for (auto ii : g.edges(src)) {
-
-              GNode dst         = g.getEdgeDst(ii);
-              LatentValue error = doGradientUpdate(
-                  g.getData(src, galois::MethodFlag::UNPROTECTED).latentVector,
-                  g.getData(dst).latentVector, lambda, g.getEdgeData(ii),
-                  stepSize);
-
-              edgesVisited += 1;
-              if (useExactError)
-                *errorAccum += error;
-            }
-          },
-          galois::wl<galois::worklists::PerSocketChunkFIFO<64>>(),
-          galois::no_pushes(), galois::loopname("sgdItemsAlgo"));
+      withLatentKernel<LatentValue>(latents.stride(), [&](auto kernel) {
+        galois::for_each(
+            galois::iterate(g.begin(), g.begin() + NUM_ITEM_NODES),
+            [&](GNode src, auto& ctx) {
+              for (auto ii : g.edges(src)) {
+
+                GNode dst = g.getEdgeDst(ii);
+                // Acquire the user (a no-op unless serializable)
+                g.getData(dst);
+                LatentValue error =
+                    kernel.gradientUpdate(latents[src], latents[dst], lambda,
+                                          g.getEdgeData(ii), stepSize);
+
+                edgesVisited += 1;
+                if (useExactError)
+                  *errorAccum += error;
+              }
+            },
+            galois::wl<galois::worklists::PerSocketChunkFIFO<64>>(),
+            galois::no_pushes(), galois::loopname("sgdItemsAlgo"));
+      });
     }
   };
 
@@ -725,8 +749,6 @@ class SGDEdgeItem {
   static const bool makeSerializable = false;
 
   struct BasicNode {
-    // latent vector to be learned.
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
     // if a item's update is interrupted, where to start when resuming.
     unsigned int edge_offset;
   };
@@ -757,47 +779,50 @@ private:
     void operator()(LatentValue* steps, int maxUpdates,
                     galois::GAccumulator<double>* errorAccum) {
       const LatentValue stepSize = steps[0];
-      galois::for_each(
-          galois::iterate(g.begin(), g.begin() + NUM_ITEM_NODES),
-          [&](GNode src, auto& ctx) {
-            auto ii = g.edge_begin(src, galois::MethodFlag::UNPROTECTED);
-            auto ee = g.edge_end(src, galois::MethodFlag::UNPROTECTED);
-
-            if (ii == ee)
-              return;
-
-            // Do not need lock on the source node, since only one thread can
-            // work on a given src(item).
-            auto& srcData = g.getData(src, galois::MethodFlag::UNPROTECTED);
-            // Advance to the edge that has not been worked yet.
-            std::advance(ii, srcData.edge_offset);
-            // Take lock on the destination as multiple source may update the
-            // same destination.
-            auto& dstData = g.getData(g.getEdgeDst(ii));
-            LatentValue error =
-                doGradientUpdate(srcData.latentVector, dstData.latentVector,
-                                 lambda, g.getEdgeData(ii), stepSize);
-
-            ++srcData.edge_offset;
-            ++ii;
-
-            edgesVisited += 1;
-            if (useExactError)
-              *errorAccum += error;
+      withLatentKernel<LatentValue>(latents.stride(), [&](auto kernel) {
+        galois::for_each(
+            galois::iterate(g.begin(), g.begin() + NUM_ITEM_NODES),
+            [&](GNode src, auto& ctx) {
+              auto ii = g.edge_begin(src, galois::MethodFlag::UNPROTECTED);
+              auto ee = g.edge_end(src, galois::MethodFlag::UNPROTECTED);
+
+              if (ii == ee)
+                return;
+
+              // Do not need lock on the source node, since only one thread
+              // can work on a given src(item).
+              auto& srcData = g.getData(src, galois::MethodFlag::UNPROTECTED);
+              // Advance to the edge that has not been worked yet.
+              std::advance(ii, srcData.edge_offset);
+              // Take lock on the destination as multiple source may update
+              // the same destination.
+              GNode dst = g.getEdgeDst(ii);
+              g.getData(dst);
+              LatentValue error =
+                  kernel.gradientUpdate(latents[src], latents[dst], lambda,
+                                        g.getEdgeData(ii), stepSize);
+
+              ++srcData.edge_offset;
+              ++ii;
 
-            if (ii == ee) {
-              // Finished the last edge.
-              // Start from the first edge.
-              srcData.edge_offset = 0;
-              return;
-            } else {
-              // More edges to work on, therefore push the current src
-              // to the worklist.
-              ctx.push(src);
-            }
-          },
-          galois::wl<galois::worklists::PerSocketChunkLIFO<8>>(),
-          galois::loopname("sgdEdgeItem"));
+              edgesVisited += 1;
+              if (useExactError)
+                *errorAccum += error;
+
+              if (ii == ee) {
+                // Finished the last edge.
+                // Start from the first edge.
+                srcData.edge_offset = 0;
+                return;
+              } else {
+                // More edges to work on, therefore push the current src
+                // to the worklist.
+                ctx.push(src);
+              }
+            },
+            galois::wl<galois::worklists::PerSocketChunkLIFO<8>>(),
+            galois::loopname("sgdEdgeItem"));
+      });
     }
   };
 
@@ -829,11 +854,8 @@ public:
 class SGDBlockEdgeAlgo {
   static const bool makeSerializable = false;
 
-  struct BasicNode {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
-
-  using Node = BasicNode;
+  // latent vectors live in the LatentStore
+  using Node = void;
 
 public:
   bool isSgd() const { return true; }
@@ -860,20 +882,22 @@ private:
     void operator()(LatentValue* steps, int maxUpdates,
                     galois::GAccumulator<double>* errorAccum) {
       galois::runtime::Fixed2DGraphTiledExecutor<Graph> executor(g);
-      executor.execute(
-          g.begin(), g.begin() + NUM_ITEM_NODES, g.begin() + NUM_ITEM_NODES,
-          g.end(), itemsPerBlock, usersPerBlock,
-          [&](GNode src, GNode dst, edge_iterator edge) {
-            const LatentValue stepSize = steps[0];
-            LatentValue error          = doGradientUpdate(
-                g.getData(src).latentVector, g.getData(dst).latentVector,
-                lambda, g.getEdgeData(edge), stepSize);
-            edgesVisited += 1;
-            if (useExactError)
-              *errorAccum += error;
-          },
-          true // use locks
-      );
+      withLatentKernel<LatentValue>(latents.stride(), [&](auto kernel) {
+        executor.execute(
+            g.begin(), g.begin() + NUM_ITEM_NODES, g.begin() + NUM_ITEM_NODES,
+            g.end(), itemsPerBlock, usersPerBlock,
+            [&](GNode src, GNode dst, edge_iterator edge) {
+              const LatentValue stepSize = steps[0];
+              LatentValue error          = kernel.gradientUpdate(
+                  latents[src], latents[dst], lambda, g.getEdgeData(edge),
+                  stepSize);
+              edgesVisited += 1;
+              if (useExactError)
+                *errorAccum += error;
+            },
+            true // use locks
+        );
+      });
     }
   };
 
@@ -896,6 +920,210 @@ public:
   }
 };
 
+/**
+ * Stratified SGD in the style of DSGD.
+ *
+ * Items and users are each split into B blocks, giving B x B tiles. Stratum s
+ * is the diagonal of tiles (i, (i + s) mod B); tiles of a stratum share no
+ * items or users, so a stratum is processed by a do_all without any locks and
+ * B strata make one pass over all edges. B is picked so that the latent
+ * vectors touched by a tile fit in L2 (see -tileKB) and is a multiple of the
+ * number of threads. Item blocks are statically assigned to threads, so each
+ * thread keeps working on the same item vectors (and the same NUMA node)
+ * across strata while user blocks rotate.
+ *
+ * With Hogwild, there is no barrier between strata: every item block walks
+ * its row of tiles in diagonal order on its own and users are updated
+ * without synchronization.
+ */
+template <bool Hogwild>
+class SGDDiagonalAlgo {
+public:
+  bool isSgd() const { return true; }
+
+  typedef typename galois::graphs::LC_CSR_Graph<void, double>::
+      template with_no_lockable<true>::type Graph;
+
+  void readGraph(Graph& g) { galois::graphs::readGraph(g, inputFilename); }
+
+  std::string name() const { return Hogwild ? "sgdHogwild" : "sgdDiagonal"; }
+
+  size_t numItems() const { return NUM_ITEM_NODES; }
+
+private:
+  using GNode = typename Graph::GraphNode;
+
+  //! Number of item blocks (= number of user blocks = number of strata)
+  size_t numBlocks;
+  //! First node of each item block; numBlocks + 1 entries
+  std::vector<GNode> itemStarts;
+  //! First node of each user block; numBlocks + 1 entries
+  std::vector<GNode> userStarts;
+  //! Per item, offset of the first edge of the next tile it visits
+  galois::LargeArray<uint64_t> cursor;
+
+  static size_t l2CacheBytes() {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0)
+      return size;
+#endif
+    return 1 << 20;
+  }
+
+  void initializeTiles(Graph& g) {
+    const size_t numUsers = g.size() - NUM_ITEM_NODES;
+    const size_t tileBytes =
+        tileKB ? static_cast<size_t>(tileKB) * 1024 : l2CacheBytes();
+    const size_t rowBytes = latents.stride() * sizeof(LatentValue);
+    const size_t threads  = galois::getActiveThreads();
+
+    numBlocks = ((NUM_ITEM_NODES + numUsers) * rowBytes + tileBytes - 1) /
+                tileBytes;
+    // every block needs an item and a user; clamp before rounding to a
+    // multiple of the thread count so that the rounding survives
+    const size_t maxBlocks =
+        std::max<size_t>(1, std::min(NUM_ITEM_NODES, numUsers));
+    numBlocks = std::min(std::max(numBlocks, threads), maxBlocks);
+    size_t rounded = (numBlocks + threads - 1) / threads * threads;
+    if (rounded > maxBlocks)
+      rounded = numBlocks / threads * threads;
+    if (rounded)
+      numBlocks = rounded;
+
+    itemStarts.resize(numBlocks + 1);
+    userStarts.resize(numBlocks + 1);
+    for (size_t i = 0; i < numBlocks; ++i) {
+      itemStarts[i] =
+          galois::block_range(size_t{0}, NUM_ITEM_NODES, i, numBlocks).first;
+      userStarts[i] =
+          NUM_ITEM_NODES +
+          galois::block_range(size_t{0}, numUsers, i, numBlocks).first;
+    }
+    itemStarts[numBlocks] = NUM_ITEM_NODES;
+    userStarts[numBlocks] = g.size();
+
+    // The first tile of item block i is (i, i); after that, each tile starts
+    // where the previous one ended, so a single search per item suffices
+    cursor.allocateBlocked(NUM_ITEM_NODES);
+    galois::do_all(
+        galois::iterate(size_t{0}, numBlocks),
+        [&](size_t i) {
+          for (GNode item = itemStarts[i]; item < itemStarts[i + 1]; ++item) {
+            auto ii = g.edge_begin(item), ei = g.edge_end(item);
+            while (ii != ei && g.getEdgeDst(ii) < userStarts[i])
+              ++ii;
+            cursor[item] = *ii;
+          }
+        },
+        galois::no_stats(), galois::loopname("InitializeTiles"));
+
+    std::cout << "strata: " << numBlocks << " items per block: "
+              << NUM_ITEM_NODES / numBlocks
+              << " users per block: " << numUsers / numBlocks << "\n";
+    galois::runtime::reportStat_Single(name(), "Strata", numBlocks);
+  }
+
+  /**
+   * Does an sgd update on every edge of tile (i, j).
+   *
+   * @returns sum of squared errors before the updates
+   */
+  template <typename Kernel>
+  double runTile(Graph& g, const Kernel& kernel, size_t i, size_t j,
+                 LatentValue stepSize) {
+    const GNode userEnd = userStarts[j + 1];
+    double error        = 0.0;
+
+    for (GNode item = itemStarts[i]; item < itemStarts[i + 1]; ++item) {
+      LatentValue* itemLatent = latents[item];
+      auto ii = (j == 0) ? g.edge_begin(item) : typename Graph::edge_iterator(
+                                                    cursor[item]);
+      auto ei = g.edge_end(item);
+
+      for (; ii != ei; ++ii) {
+        GNode user = g.getEdgeDst(ii);
+        if (user >= userEnd)
+          break;
+        LatentValue e = kernel.gradientUpdate(
+            itemLatent, latents[user], lambda, g.getEdgeData(ii), stepSize);
+        error += e * e;
+      }
+      cursor[item] = *ii;
+    }
+
+    return error;
+  }
+
+  struct Execute {
+    SGDDiagonalAlgo& self;
+    Graph& g;
+    galois::GAccumulator<size_t>& edgesVisited;
+
+    void operator()(LatentValue* steps, int maxUpdates,
+                    galois::GAccumulator<double>* errorAccum) {
+      const size_t B = self.numBlocks;
+
+      withLatentKernel<LatentValue>(latents.stride(), [&](auto kernel) {
+        for (unsigned u = 0; u < updatesPerEdge; ++u) {
+          const LatentValue stepSize = steps[u];
+          // Only keep the error of the last pass
+          const bool lastPass = errorAccum && u + 1 == updatesPerEdge;
+          if (lastPass)
+            errorAccum->reset();
+
+          auto runTile = [&](size_t i, size_t j) {
+            double error = self.runTile(g, kernel, i, j, stepSize);
+            if (lastPass)
+              *errorAccum += error;
+          };
+
+          if (Hogwild) {
+            galois::do_all(
+                galois::iterate(size_t{0}, B),
+                [&](size_t i) {
+                  for (size_t s = 0; s < B; ++s)
+                    runTile(i, (i + s) % B);
+                },
+                galois::steal(), galois::loopname("sgdHogwild"));
+          } else {
+            for (size_t s = 0; s < B; ++s) {
+              galois::do_all(galois::iterate(size_t{0}, B),
+                             [&](size_t i) { runTile(i, (i + s) % B); },
+                             galois::no_stats(),
+                             galois::loopname("sgdDiagonal"));
+            }
+          }
+        }
+      });
+
+      edgesVisited += g.sizeEdges() * updatesPerEdge;
+    }
+  };
+
+public:
+  void operator()(Graph& g, const StepFunction& sf) {
+    verify(g, name());
+    galois::GAccumulator<size_t> edgesVisited;
+
+    galois::StatTimer preProcessTimer("PreProcessingTime");
+    preProcessTimer.start();
+    initializeTiles(g);
+    preProcessTimer.stop();
+
+    galois::StatTimer executeTimer("Time");
+    executeTimer.start();
+
+    Execute fn{*this, g, edgesVisited};
+    executeUntilConverged(sf, g, fn);
+
+    executeTimer.stop();
+
+    galois::runtime::reportStat_Single(name(), "EdgesVisited",
+                                       edgesVisited.reduce());
+  }
+};
+
 /**
  * ALS algorithms
  */
@@ -905,47 +1133,25 @@ public:
 struct SimpleALSalgo {
   bool isSgd() const { return false; }
   std::string name() const { return "AlternatingLeastSquares"; }
-  struct Node {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
 
-  typedef typename galois::graphs::LC_CSR_Graph<Node, double>::with_no_lockable<
+  typedef typename galois::graphs::LC_CSR_Graph<void, double>::with_no_lockable<
       true>::type Graph;
   typedef Graph::GraphNode GNode;
   // Column-major access
   typedef Eigen::SparseMatrix<LatentValue> Sp;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, Eigen::Dynamic> MT;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, 1> V;
-  typedef Eigen::Map<V> MapV;
+  typedef Eigen::Matrix<LatentValue, Eigen::Dynamic, Eigen::Dynamic> DenseM;
+  typedef Eigen::Map<DenseM, Eigen::Unaligned, Eigen::OuterStride<>> MT;
 
   Sp A;
   Sp AT;
 
   void readGraph(Graph& g) { galois::graphs::readGraph(g, inputFilename); }
 
-  void copyToGraph(Graph& g, MT& WT, MT& HT) {
-    // Copy out
-    for (GNode n : g) {
-      LatentValue* ptr = &g.getData(n).latentVector[0];
-      MapV mapV{ptr};
-      if (n < NUM_ITEM_NODES) {
-        mapV = WT.col(n);
-      } else {
-        mapV = HT.col(n - NUM_ITEM_NODES);
-      }
-    }
-  }
-
-  void copyFromGraph(Graph& g, MT& WT, MT& HT) {
-    for (GNode n : g) {
-      LatentValue* ptr = &g.getData(n).latentVector[0];
-      MapV mapV{ptr};
-      if (n < NUM_ITEM_NODES) {
-        WT.col(n) = mapV;
-      } else {
-        HT.col(n - NUM_ITEM_NODES) = mapV;
-      }
-    }
+  //! View the latent vectors of nodes [first, first + n) as the columns of a
+  //! matrix; no copy is made
+  MT mapLatents(size_t first, size_t n) {
+    return MT{latents[first], Eigen::Index(latents.dimension()), Eigen::Index(n),
+              Eigen::OuterStride<>(latents.stride())};
   }
 
   void initializeA(Graph& g) {
@@ -971,25 +1177,21 @@ struct SimpleALSalgo {
     // squares problems:
     //   (W^T W + lambda I) H^T = W^T A (solving for H^T)
     //   (H^T H + lambda I) W^T = H^T A^T (solving for W^T)
-    MT WT{LATENT_VECTOR_SIZE, NUM_ITEM_NODES};
-    MT HT{LATENT_VECTOR_SIZE, g.size() - NUM_ITEM_NODES};
-    typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, LATENT_VECTOR_SIZE>
-        XTX;
-    typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, Eigen::Dynamic> XTSp;
+    MT WT = mapLatents(0, NUM_ITEM_NODES);
+    MT HT = mapLatents(NUM_ITEM_NODES, g.size() - NUM_ITEM_NODES);
+    const int dim = latents.dimension();
+    typedef DenseM XTX;
+    typedef DenseM XTSp;
     typedef galois::substrate::PerThreadStorage<XTX> PerThrdXTX;
 
     galois::gPrint("ALS::Start initializeA\n");
     initializeA(g);
     galois::gPrint("ALS::End initializeA\n");
-    galois::gPrint("ALS::Start copyFromGraph\n");
-    copyFromGraph(g, WT, HT);
-    galois::gPrint("ALS::End copyFromGraph\n");
 
     double last = -1.0;
     galois::StatTimer mmTime("MMTime");
     galois::StatTimer update1Time("UpdateTime1");
     galois::StatTimer update2Time("UpdateTime2");
-    galois::StatTimer copyTime("CopyTime");
     galois::StatTimer totalExecTime("totalExecTime");
     galois::StatTimer totalAlgoTime("Time");
     PerThrdXTX xtxs;
@@ -1010,11 +1212,11 @@ struct SimpleALSalgo {
           [&](int col, galois::UserContext<int>&) {
             // Compute WTW = W^T * W for sparse A
             XTX& WTW = *xtxs.getLocal();
-            WTW.setConstant(0);
+            WTW.setZero(dim, dim);
             for (Sp::InnerIterator it(A, col); it; ++it)
               WTW.triangularView<Eigen::Upper>() +=
                   WT.col(it.row()) * WT.col(it.row()).transpose();
-            for (int i = 0; i < LATENT_VECTOR_SIZE; ++i)
+            for (int i = 0; i < dim; ++i)
               WTW(i, i) += lambda;
             HT.col(col) =
                 WTW.selfadjointView<Eigen::Upper>().llt().solve(WTA.col(col));
@@ -1032,20 +1234,16 @@ struct SimpleALSalgo {
           [&](int col, galois::UserContext<int>&) {
             // Compute HTH = H^T * H for sparse A
             XTX& HTH = *xtxs.getLocal();
-            HTH.setConstant(0);
+            HTH.setZero(dim, dim);
             for (Sp::InnerIterator it(AT, col); it; ++it)
               HTH.triangularView<Eigen::Upper>() +=
                   HT.col(it.row()) * HT.col(it.row()).transpose();
-            for (int i = 0; i < LATENT_VECTOR_SIZE; ++i)
+            for (int i = 0; i < dim; ++i)
               HTH(i, i) += lambda;
             WT.col(col) =
                 HTH.selfadjointView<Eigen::Upper>().llt().solve(HTAT.col(col));
           });
       update2Time.stop();
-
-      copyTime.start();
-      copyToGraph(g, WT, HT);
-      copyTime.stop();
       totalExecTime.stop();
 
       double error = sumSquaredError(g);
@@ -1073,12 +1271,8 @@ struct SyncALSalgo {
 
   std::string name() const { return "SynchronousAlternatingLeastSquares"; }
 
-  struct Node {
-    LatentValue latentVector[LATENT_VECTOR_SIZE];
-  };
-
   static const bool NEEDS_LOCKS = false;
-  typedef typename galois::graphs::LC_CSR_Graph<Node, double> BaseGraph;
+  typedef typename galois::graphs::LC_CSR_Graph<void, double> BaseGraph;
   typedef typename std::conditional<
       NEEDS_LOCKS,
       typename BaseGraph::template with_out_of_line_lockable<true>::type,
@@ -1086,12 +1280,10 @@ struct SyncALSalgo {
   typedef typename Graph::GraphNode GNode;
   // Column-major access
   typedef Eigen::SparseMatrix<LatentValue> Sp;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, Eigen::Dynamic> MT;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, 1> V;
-  typedef Eigen::Map<V> MapV;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, LATENT_VECTOR_SIZE>
-      XTX;
-  typedef Eigen::Matrix<LatentValue, LATENT_VECTOR_SIZE, Eigen::Dynamic> XTSp;
+  typedef Eigen::Matrix<LatentValue, Eigen::Dynamic, Eigen::Dynamic> DenseM;
+  typedef Eigen::Map<DenseM, Eigen::Unaligned, Eigen::OuterStride<>> MT;
+  typedef Eigen::Matrix<LatentValue, Eigen::Dynamic, 1> V;
+  typedef DenseM XTX;
 
   typedef galois::substrate::PerThreadStorage<XTX> PerThrdXTX;
   typedef galois::substrate::PerThreadStorage<V> PerThrdV;
@@ -1101,29 +1293,11 @@ struct SyncALSalgo {
 
   void readGraph(Graph& g) { galois::graphs::readGraph(g, inputFilename); }
 
-  void copyToGraph(Graph& g, MT& WT, MT& HT) {
-    // Copy out
-    for (GNode n : g) {
-      LatentValue* ptr = &g.getData(n).latentVector[0];
-      MapV mapV{ptr};
-      if (n < NUM_ITEM_NODES) {
-        mapV = WT.col(n);
-      } else {
-        mapV = HT.col(n - NUM_ITEM_NODES);
-      }
-    }
-  }
-
-  void copyFromGraph(Graph& g, MT& WT, MT& HT) {
-    for (GNode n : g) {
-      LatentValue* ptr = &g.getData(n).latentVector[0];
-      MapV mapV{ptr};
-      if (n < NUM_ITEM_NODES) {
-        WT.col(n) = mapV;
-      } else {
-        HT.col(n - NUM_ITEM_NODES) = mapV;
-      }
-    }
+  //! View the latent vectors of nodes [first, first + n) as the columns of a
+  //! matrix; no copy is made
+  MT mapLatents(size_t first, size_t n) {
+    return MT{latents[first], Eigen::Index(latents.dimension()), Eigen::Index(n),
+              Eigen::OuterStride<>(latents.stride())};
   }
 
   void initializeA(Graph& g) {
@@ -1144,32 +1318,33 @@ struct SyncALSalgo {
   void update(Graph& g, size_t col, MT& WT, MT& HT, PerThrdXTX& xtxs,
               PerThrdV& rhs) {
     // Compute WTW = W^T * W for sparse A
-    V& r = *rhs.getLocal();
+    const int dim = latents.dimension();
+    V& r          = *rhs.getLocal();
     if (col < NUM_ITEM_NODES) {
-      r.setConstant(0);
+      r.setZero(dim);
       // HTAT = HT * AT; r = HTAT.col(col)
       for (Sp::InnerIterator it(AT, col); it; ++it)
         r += it.value() * HT.col(it.row());
       XTX& HTH = *xtxs.getLocal();
-      HTH.setConstant(0);
+      HTH.setZero(dim, dim);
       for (Sp::InnerIterator it(AT, col); it; ++it)
         HTH.triangularView<Eigen::Upper>() +=
             HT.col(it.row()) * HT.col(it.row()).transpose();
-      for (int i = 0; i < LATENT_VECTOR_SIZE; ++i)
+      for (int i = 0; i < dim; ++i)
         HTH(i, i) += lambda;
       WT.col(col) = HTH.selfadjointView<Eigen::Upper>().llt().solve(r);
     } else {
       col = col - NUM_ITEM_NODES;
-      r.setConstant(0);
+      r.setZero(dim);
       // WTA = WT * A; x = WTA.col(col)
       for (Sp::InnerIterator it(A, col); it; ++it)
         r += it.value() * WT.col(it.row());
       XTX& WTW = *xtxs.getLocal();
-      WTW.setConstant(0);
+      WTW.setZero(dim, dim);
       for (Sp::InnerIterator it(A, col); it; ++it)
         WTW.triangularView<Eigen::Upper>() +=
             WT.col(it.row()) * WT.col(it.row()).transpose();
-      for (int i = 0; i < LATENT_VECTOR_SIZE; ++i)
+      for (int i = 0; i < dim; ++i)
         WTW(i, i) += lambda;
       HT.col(col) = WTW.selfadjointView<Eigen::Upper>().llt().solve(r);
     }
@@ -1226,15 +1401,13 @@ struct SyncALSalgo {
     // squares problems:
     //   (W^T W + lambda I) H^T = W^T A (solving for H^T)
     //   (H^T H + lambda I) W^T = H^T A^T (solving for W^T)
-    MT WT{LATENT_VECTOR_SIZE, NUM_ITEM_NODES};
-    MT HT{LATENT_VECTOR_SIZE, g.size() - NUM_ITEM_NODES};
+    MT WT = mapLatents(0, NUM_ITEM_NODES);
+    MT HT = mapLatents(NUM_ITEM_NODES, g.size() - NUM_ITEM_NODES);
 
     initializeA(g);
-    copyFromGraph(g, WT, HT);
 
     double last = -1.0;
     galois::StatTimer updateTime("UpdateTime");
-    galois::StatTimer copyTime("CopyTime");
     galois::StatTimer totalExecTime("totalExecTime");
     galois::StatTimer totalAlgoTime("Time");
     PerThrdXTX xtxs;
@@ -1259,10 +1432,6 @@ struct SyncALSalgo {
           galois::loopname("syncALS-items"));
 
       updateTime.stop();
-
-      copyTime.start();
-      copyToGraph(g, WT, HT);
-      copyTime.stop();
       totalExecTime.stop();
 
       double error = sumSquaredError(g);
@@ -1301,7 +1470,8 @@ size_t initializeGraphData(Graph& g) {
   galois::gPrint("initializeGraphData\n");
   galois::StatTimer initTimer("InitializeGraph");
   initTimer.start();
-  double top = 1.0 / std::sqrt(LATENT_VECTOR_SIZE);
+  const size_t dim = latents.dimension();
+  double top       = 1.0 / std::sqrt(dim);
   galois::substrate::PerThreadStorage<std::mt19937> gen;
 
 #if __cplusplus >= 201103L || defined(HAVE_CXX11_UNIFORM_INT_DISTRIBUTION)
@@ -1312,26 +1482,26 @@ size_t initializeGraphData(Graph& g) {
 
   if (useDetInit) {
     galois::do_all(galois::iterate(g), [&](typename Graph::GraphNode n) {
-      auto& data = g.getData(n);
-      auto val   = genVal(n);
-      for (int i = 0; i < LATENT_VECTOR_SIZE; i++) {
-        data.latentVector[i] = val;
+      LatentValue* v = latents[n];
+      auto val       = genVal(n);
+      for (size_t i = 0; i < dim; i++) {
+        v[i] = val;
       }
     });
   } else {
     galois::do_all(galois::iterate(g), [&](typename Graph::GraphNode n) {
-      auto& data = g.getData(n);
+      LatentValue* v = latents[n];
 
       // all threads initialize their assignment with same generator or
       // a thread local one
       if (useSameLatentVector) {
         std::mt19937 sameGen;
-        for (int i = 0; i < LATENT_VECTOR_SIZE; i++) {
-          data.latentVector[i] = dist(sameGen);
+        for (size_t i = 0; i < dim; i++) {
+          v[i] = dist(sameGen);
         }
       } else {
-        for (int i = 0; i < LATENT_VECTOR_SIZE; i++) {
-          data.latentVector[i] = dist(*gen.getLocal());
+        for (size_t i = 0; i < dim; i++) {
+          v[i] = dist(*gen.getLocal());
         }
       }
     });
@@ -1368,8 +1538,8 @@ template <typename Graph>
 void writeBinaryLatentVectors(Graph& g, const std::string& filename) {
   std::ofstream file(filename);
   for (auto ii = g.begin(), ei = g.end(); ii != ei; ++ii) {
-    auto& v = g.getData(*ii).latentVector;
-    for (int i = 0; i < LATENT_VECTOR_SIZE; ++i) {
+    LatentValue* v = latents[*ii];
+    for (size_t i = 0; i < latents.dimension(); ++i) {
       file.write(reinterpret_cast<char*>(&v[i]), sizeof(v[i]));
     }
   }
@@ -1380,8 +1550,8 @@ template <typename Graph>
 void writeAsciiLatentVectors(Graph& g, const std::string& filename) {
   std::ofstream file(filename);
   for (auto ii = g.begin(), ei = g.end(); ii != ei; ++ii) {
-    auto& v = g.getData(*ii).latentVector;
-    for (int i = 0; i < LATENT_VECTOR_SIZE; ++i) {
+    LatentValue* v = latents[*ii];
+    for (size_t i = 0; i < latents.dimension(); ++i) {
       file << v[i] << " ";
     }
     file << "\n";
@@ -1409,6 +1579,11 @@ void run() {
 
   galois::runtime::reportNumaAlloc("NumaAlloc1");
 
+  if (latentVectorSize == 0) {
+    GALOIS_DIE("latent vector size must be positive");
+  }
+  latents.allocate(g.size(), latentVectorSize);
+
   // initialize latent vectors and get number of item nodes
   NUM_ITEM_NODES = initializeGraphData(g);
 
@@ -1419,7 +1594,7 @@ void run() {
             << " num ratings: " << g.sizeEdges() << "\n";
 
   std::unique_ptr<StepFunction> sf{newStepFunction()};
-  std::cout << "latent vector size: " << LATENT_VECTOR_SIZE
+  std::cout << "latent vector size: " << latents.dimension()
             << " algo: " << algo.name() << " lambda: " << lambda;
 
   if (algo.isSgd()) {
@@ -1486,6 +1661,12 @@ int main(int argc, char** argv) {
   case Algo::sgdBlockJump:
     run<SGDBlockJumpAlgo>();
     break;
+  case Algo::sgdDiagonal:
+    run<SGDDiagonalAlgo<false>>();
+    break;
+  case Algo::sgdHogwild:
+    run<SGDDiagonalAlgo<true>>();
+    break;
   default:
     GALOIS_DIE("unknown algorithm");
     break;
@@ -27,10 +27,6 @@
 
 typedef double LatentValue;
 
-// Purdue, CSGD: 100; Intel: 20
-// static const int LATENT_VECTOR_SIZE = 100;
-static const int LATENT_VECTOR_SIZE = 20; // Purdue, CSGD: 100; Intel: 20
-
 /**
  * Common commandline parameters to for matrix completion algorithms
  */
@@ -67,6 +63,13 @@ static cll::opt<float> lambda("lambda",
                               cll::desc("regularization parameter [lambda]"),
                               cll::init(0.05));
 
+// Purdue, CSGD: 100; Intel: 20
+static cll::opt<unsigned>
+    latentVectorSize("latentVectorSize",
+                     cll::desc("number of elements in each latent vector "
+                               "(default 20)"),
+                     cll::init(20));
+
 static cll::opt<unsigned> usersPerBlock("usersPerBlock",
                                         cll::desc("users per block"),
                                         cll::init(2048));
@@ -116,75 +119,6 @@ static cll::opt<bool>
                          "use deterministic values for latent vector"),
                cll::init(false));
 
-/**
- * Inner product of 2 vectors.
- *
- * Like std::inner_product but rewritten here to check vectorization
- *
- * @param first1 Pointer to beginning of vector 1
- * @param last1 Pointer to end of vector 1. Should be exactly LATENT_VECTOR_SIZE
- * away from first1
- * @param first2 Pointer to beginning of vector 2. Should have at least
- * LATENT_VECTOR_SIZE elements from this point.
- * @param init Initial value to accumulate sum into
- *
- * @returns init + the inner product (i.e. the inner product if init is 0, error
- * if init is -"ground truth"
- */
-template <typename T>
-T innerProduct(T* __restrict__ first1, T* __restrict__ last1,
-               T* __restrict__ first2, T init) {
-  assert(first1 + LATENT_VECTOR_SIZE == last1);
-  for (int i = 0; i < LATENT_VECTOR_SIZE; ++i) {
-    init += first1[i] * first2[i];
-  }
-  return init;
-}
-
-template <typename T>
-T predictionError(T* __restrict__ itemLatent, T* __restrict__ userLatent,
-                  double actual) {
-  T v = actual;
-  return innerProduct(itemLatent, itemLatent + LATENT_VECTOR_SIZE, userLatent,
-                      -v);
-}
-
-/**
- * Objective: squared loss with weighted-square-norm regularization
- *
- * Updates latent vectors to reduce the error from the edge value.
- *
- * @param itemLatent latent vector of the item
- * @param userLatent latent vector of the user
- * @param lambda learning parameter
- * @param edgeRating Data on the edge, i.e. the number that the inner product
- * of the 2 latent vectors should eventually get to
- * @param stepSize learning parameter: how much to adjust vectors by to
- * correct for erro
- *
- * @return Error before gradient update
- */
-template <typename T>
-T doGradientUpdate(T* __restrict__ itemLatent, T* __restrict__ userLatent,
-                   double lambda, double edgeRating, double stepSize) {
-  // Implicit cast to type T
-  T l      = lambda;
-  T step   = stepSize;
-  T rating = edgeRating;
-  T error  = innerProduct(itemLatent, itemLatent + LATENT_VECTOR_SIZE,
-                         userLatent, -rating);
-
-  // Take gradient step to reduce error
-  for (int i = 0; i < LATENT_VECTOR_SIZE; i++) {
-    T prevItem = itemLatent[i];
-    T prevUser = userLatent[i];
-    itemLatent[i] -= step * (error * prevUser + l * prevItem);
-    userLatent[i] -= step * (error * prevItem + l * prevUser);
-  }
-
-  return error;
-}
-
 struct StepFunction {
   virtual LatentValue stepSize(int round) const = 0;
   virtual std::string name() const              = 0;
@@ -38,6 +38,12 @@ static cll::opt<Algo> algo("algo", cll::desc("Choose an algorithm:"),
                                        clEnumValEnd),
                            cll::init(Residual));
 
+static cll::opt<unsigned int> prefetchDist(
+    "prefetchDist",
+    cll::desc("Number of in-edges ahead to prefetch source data; 0 disables "
+              "prefetching (default value 0)"),
+    cll::init(0));
+
 constexpr static const unsigned CHUNK_SIZE = 32;
 
 struct LNode {
@@ -138,12 +144,19 @@ void computePRResidual(Graph& graph, DeltaArray& delta,
     galois::do_all(galois::iterate(graph),
                    [&](const GNode& src) {
                      float sum = 0;
-                     for (auto nbr : graph.edges(src)) {
-                       GNode dst = graph.getEdgeDst(nbr);
-                       if (delta[dst] > 0) {
-                         sum += delta[dst];
-                       }
-                     }
+                     // prefetch delta[dst] a batch of in-edges at a time
+                     graph.forEachEdgeBatched(
+                         graph.edge_begin(src), graph.edge_end(src),
+                         prefetchDist,
+                         [&](GNode dst) {
+                           galois::substrate::prefetch(&delta[dst]);
+                         },
+                         [&](Graph::edge_iterator nbr) {
+                           GNode dst = graph.getEdgeDst(nbr);
+                           if (delta[dst] > 0) {
+                             sum += delta[dst];
+                           }
+                         });
                      if (sum > 0) {
                        residual[src] = sum;
                      }
@@ -184,9 +197,8 @@ void computePRTopological(Graph& graph) {
                      LNode& sdata = graph.getData(src, flag);
                      float sum    = 0.0;
 
-                     for (auto jj = graph.edge_begin(src, flag),
-                               ej = graph.edge_end(src, flag);
-                          jj != ej; ++jj) {
+                     for (auto jj :
+                          graph.prefetched_edges(src, flag, prefetchDist)) {
                        GNode dst = graph.getEdgeDst(jj);
 
                        LNode& ddata = graph.getData(dst, flag);
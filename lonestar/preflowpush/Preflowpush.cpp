@@ -28,8 +28,10 @@
 
 #include <boost/iterator/iterator_adaptor.hpp>
 
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 namespace cll = llvm::cl;
 
@@ -40,6 +42,8 @@ const char* url = "preflow_push";
 
 enum DetAlgo { nondet = 0, detBase, detDisjoint };
 
+enum RelabelMode { restart = 0, deferred };
+
 static cll::opt<std::string> filename(cll::Positional,
                                       cll::desc("<input file>"), cll::Required);
 static cll::opt<uint32_t> sourceId(cll::Positional, cll::desc("sourceID"),
@@ -68,6 +72,17 @@ static cll::opt<DetAlgo> detAlgo(
                 clEnumVal(detBase, "Base execution"),
                 clEnumVal(detDisjoint, "Disjoint execution"), clEnumValEnd),
     cll::init(nondet));
+static cll::opt<RelabelMode> relabelMode(
+    "relabelMode",
+    cll::desc("Global relabel mode for the non-deterministic algorithm:"),
+    cll::values(clEnumValN(restart, "restart",
+                           "Break the discharge loop and rescan the graph for "
+                           "active nodes (default)"),
+                clEnumValN(deferred, "deferred",
+                           "Drain the discharge loop into a deferred set and "
+                           "detect gaps with per-height counters"),
+                clEnumValEnd),
+    cll::init(restart));
 
 /**
  * Alpha parameter the original Goldberg algorithm to control when global
@@ -90,8 +105,10 @@ struct Node {
   int64_t excess;
   int height;
   int current;
+  //! last global relabel epoch in which this node was deferred
+  uint32_t epoch;
 
-  Node() : excess(0), height(1), current(0) {}
+  Node() : excess(0), height(1), current(0), epoch(0) {}
 };
 
 std::ostream& operator<<(std::ostream& os, const Node& n) {
@@ -113,6 +130,12 @@ struct PreflowPush {
   GNode source;
   int global_relabel_interval;
   bool should_global_relabel = false;
+  //! set while discharging in deferred mode once a global relabel is due
+  std::atomic<bool> relabelPending{false};
+  //! number of global relabels so far; stamps deferred nodes
+  uint32_t epoch = 0;
+  //! number of nodes at each height (deferred mode only)
+  std::vector<std::atomic<int>> heightCount;
   galois::LargeArray<Graph::edge_iterator>
       reverseDirectionEdgeIterator; // ideally should be on the graph as
                                     // graph.getReverseEdgeIterator()
@@ -206,6 +229,24 @@ struct PreflowPush {
     }
   }
 
+  /**
+   * Moves a node between height counters. If the node was the last one at
+   * its old height and some other node sits right above it, the nodes above
+   * the gap can no longer reach the sink; a global relabel is requested to
+   * lift them all at once.
+   */
+  void moveHeight(int oldHeight, int newHeight) {
+    heightCount[newHeight].fetch_add(1, std::memory_order_relaxed);
+    if (heightCount[oldHeight].fetch_sub(1, std::memory_order_relaxed) == 1 &&
+        oldHeight + 1 < (int)graph.size()) {
+      int above = heightCount[oldHeight + 1].load(std::memory_order_relaxed);
+      if (newHeight == oldHeight + 1)
+        --above;
+      if (above > 0)
+        relabelPending = true;
+    }
+  }
+
   void relabel(const GNode& src) {
     int minHeight = std::numeric_limits<int>::max();
     int minEdge   = 0;
@@ -227,13 +268,17 @@ struct PreflowPush {
     assert(minHeight != std::numeric_limits<int>::max());
     ++minHeight;
 
-    Node& node = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+    Node& node    = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+    int oldHeight = node.height;
     if (minHeight < (int)graph.size()) {
       node.height  = minHeight;
       node.current = minEdge;
     } else {
       node.height = graph.size();
     }
+
+    if (!heightCount.empty())
+      moveHeight(oldHeight, node.height);
   }
 
   template <typename C>
@@ -380,6 +425,48 @@ struct PreflowPush {
         galois::loopname("nonDetDischarge"), galois::parallel_break(), wl_opt);
   }
 
+  /**
+   * Like nonDetDischarge, but instead of breaking the loop when a global
+   * relabel is due, the remaining active nodes are moved to deferred as they
+   * come off the worklist. No active node is lost, so the next round starts
+   * from deferred rather than from a scan of the whole graph.
+   */
+  template <typename W>
+  void deferredDischarge(galois::InsertBag<GNode>& initial,
+                         galois::InsertBag<GNode>& deferred, Counter& counter,
+                         const W& wl_opt) {
+
+    // per thread
+    const int relabel_interval =
+        global_relabel_interval / galois::getActiveThreads();
+
+    galois::for_each(
+        galois::iterate(initial),
+        [&, relabel_interval, this](GNode& src, auto& ctx) {
+          if (this->relabelPending.load(std::memory_order_relaxed)) {
+            Node& node = this->graph.getData(src, galois::MethodFlag::WRITE);
+            if (node.epoch != this->epoch) {
+              node.epoch = this->epoch;
+              deferred.push(src);
+            }
+            return;
+          }
+
+          int increment = 1;
+          this->acquire(src);
+          if (this->discharge(src, ctx)) {
+            increment += BETA;
+          }
+
+          counter += increment;
+          if (this->global_relabel_interval > 0 &&
+              counter.peekLocal() >= relabel_interval) { // local check
+            this->relabelPending = true;
+          }
+        },
+        galois::loopname("deferredDischarge"), wl_opt);
+  }
+
   /**
    * Do reverse BFS on residual graph.
    */
@@ -446,9 +533,10 @@ struct PreflowPush {
         galois::loopname("updateHeights"));
   }
 
-  template <typename IncomingWL>
-  void globalRelabel(IncomingWL& incoming) {
-
+  /**
+   * Recomputes all heights as distances to the sink in the residual graph.
+   */
+  void computeHeights() {
     galois::do_all(galois::iterate(graph),
                    [&](const GNode& src) {
                      Node& node =
@@ -476,6 +564,26 @@ struct PreflowPush {
       std::cerr << "Unknown algorithm" << detAlgo << "\n";
       abort();
     }
+  }
+
+  void countHeights() {
+    galois::do_all(galois::iterate(heightCount.begin(), heightCount.end()),
+                   [](std::atomic<int>& count) { count = 0; },
+                   galois::no_stats());
+    galois::do_all(galois::iterate(graph),
+                   [this](const GNode& src) {
+                     int height =
+                         graph.getData(src, galois::MethodFlag::UNPROTECTED)
+                             .height;
+                     heightCount[height].fetch_add(1,
+                                                   std::memory_order_relaxed);
+                   },
+                   galois::loopname("CountHeights"));
+  }
+
+  template <typename IncomingWL>
+  void globalRelabel(IncomingWL& incoming) {
+    computeHeights();
 
     galois::do_all(galois::iterate(graph),
                    [&incoming, this](const GNode& src) {
@@ -503,6 +611,55 @@ struct PreflowPush {
     }
   }
 
+  template <typename W>
+  void runDeferred(const W& wl_opt) {
+    galois::InsertBag<GNode> bags[2];
+    galois::InsertBag<GNode>* initial  = &bags[0];
+    galois::InsertBag<GNode>* deferred = &bags[1];
+
+    heightCount = std::vector<std::atomic<int>>(graph.size() + 1);
+    initializePreflow(*initial);
+    countHeights();
+    epoch = 1;
+
+    while (!initial->empty()) {
+      galois::StatTimer T_discharge("DischargeTime");
+      T_discharge.start();
+      Counter counter;
+      deferredDischarge(*initial, *deferred, counter, wl_opt);
+      initial->clear();
+      T_discharge.stop();
+
+      if (!relabelPending) {
+        assert(deferred->empty());
+        break;
+      }
+
+      galois::StatTimer T_global_relabel("GlobalRelabelTime");
+      T_global_relabel.start();
+      computeHeights();
+      countHeights();
+      galois::do_all(galois::iterate(*deferred),
+                     [&, this](const GNode& src) {
+                       Node& node = this->graph.getData(
+                           src, galois::MethodFlag::UNPROTECTED);
+                       if (node.height < (int)this->graph.size() &&
+                           node.excess > 0)
+                         initial->push(src);
+                     },
+                     galois::loopname("FilterDeferred"));
+      deferred->clear();
+      relabelPending = false;
+      ++epoch;
+      std::cout << " Flow after global relabel: "
+                << graph.getData(sink).excess << "\n";
+      T_global_relabel.stop();
+    }
+
+    galois::runtime::reportStat_Single("PreflowPush", "GlobalRelabels",
+                                       epoch - 1);
+  }
+
   void run() {
     Graph *captured_graph = &graph;
     auto obimIndexer = [=](const GNode& n) {
@@ -514,6 +671,15 @@ struct PreflowPush {
                                                       Chunk>
         OBIM;
 
+    if (relabelMode == deferred && detAlgo == nondet) {
+      if (useHLOrder) {
+        runDeferred(galois::wl<OBIM>(obimIndexer));
+      } else {
+        runDeferred(galois::wl<Chunk>());
+      }
+      return;
+    }
+
     galois::InsertBag<GNode> initial;
     initializePreflow(initial);
 
@@ -55,6 +55,11 @@ static cll::opt<unsigned int>
     stepShift("delta",
               cll::desc("Shift value for the deltastep (default value 13)"),
               cll::init(13));
+static cll::opt<unsigned int> prefetchDist(
+    "prefetchDist",
+    cll::desc("Number of edges ahead to prefetch destination labels; 0 "
+              "disables prefetching (default value 0)"),
+    cll::init(0));
 
 enum Algo {
   deltaTile = 0,
@@ -411,27 +416,27 @@ int main(int argc, char** argv) {
   switch (algo) {
   case deltaTile:
     deltaStepAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
-                               TileRangeFn());
+                               TileRangeFn{graph, prefetchDist});
     break;
   case deltaStep:
     deltaStepAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
-                                 OutEdgeRangeFn{graph});
+                                 OutEdgeRangeFn{graph, prefetchDist});
     break;
   case serDeltaTile:
     serDeltaAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
-                              TileRangeFn());
+                              TileRangeFn{graph, prefetchDist});
     break;
   case serDelta:
     serDeltaAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
-                                OutEdgeRangeFn{graph});
+                                OutEdgeRangeFn{graph, prefetchDist});
     break;
   case dijkstraTile:
     dijkstraAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
-                              TileRangeFn());
+                              TileRangeFn{graph, prefetchDist});
     break;
   case dijkstra:
     dijkstraAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
-                                OutEdgeRangeFn{graph});
+                                OutEdgeRangeFn{graph, prefetchDist});
     break;
   case topo:
     topoAlgo(graph, source);
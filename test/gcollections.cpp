@@ -17,6 +17,7 @@
  * Documentation, or loss or inaccuracy of data of any kind.
  */
 
+#include "galois/Galois.h"
 #include "galois/Bag.h"
 #include "galois/gdeque.h"
 #include "galois/gslist.h"
@@ -26,10 +27,12 @@
 
 #include <boost/iterator/counting_iterator.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <string>
 #include <deque>
+#include <numeric>
 #include <vector>
 #include <random>
 
@@ -160,6 +163,30 @@ void testSort(std::string prefix, C&& collection, int N) {
   }
 }
 
+template <unsigned BlockSize>
+void testBagRange(std::string prefix, int N) {
+  galois::InsertBag<int, BlockSize> c;
+  std::vector<int> v(N);
+  std::iota(v.begin(), v.end(), 0);
+  c.push_range(v.begin(), v.begin() + N / 3);
+  c.push(N / 3);
+  c.push_range(v.begin() + N / 3 + 1, v.end());
+
+  GALOIS_ASSERT(std::equal(v.begin(), v.end(), c.begin()), prefix);
+
+  // page-skipping distance and advance found by ADL
+  GALOIS_ASSERT(N == distance(c.begin(), c.end()), prefix);
+  for (int k : {0, 1, N / 2, N - 1, N}) {
+    auto it = c.begin();
+    advance(it, k);
+    auto expected = c.begin();
+    for (int i = 0; i < k; ++i)
+      ++expected;
+    GALOIS_ASSERT(it == expected, prefix);
+    GALOIS_ASSERT(N - k == distance(it, c.end()), prefix);
+  }
+}
+
 template <typename C, typename Iterator>
 void timeAccess(std::string prefix, C&& c, Iterator first, Iterator last) {
   Heap<C, needs_heap<C>(0)> heap;
@@ -192,9 +219,12 @@ struct element {
 };
 
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+
   testBasic("galois::gslist", galois::gslist<int>(), 32 * 32);
   testNormal("galois::gdeque", galois::gdeque<int>(), 32 * 32);
   // testSort("galois::gdeque", galois::gdeque<int>(), 32 * 32);
+  testBagRange<256>("galois::InsertBag", 32 * 32);
 
   int size = 100;
   if (argc > 1)
@@ -23,15 +23,17 @@
 
 int main(int argc, char** argv) {
   auto t = galois::substrate::getHWTopo();
-  std::cout << "T,C,P,N: " << t.first.maxThreads << " " << t.first.maxCores
-            << " " << t.first.maxSockets << " " << t.first.maxNumaNodes << "\n";
+  std::cout << "T,C,P,N,L3: " << t.first.maxThreads << " " << t.first.maxCores
+            << " " << t.first.maxSockets << " " << t.first.maxNumaNodes << " "
+            << t.first.maxL3Domains << "\n";
   for (unsigned i = 0; i < t.first.maxThreads; ++i) {
     auto& c = t.second[i];
     std::cout << "tid: " << c.tid << " leader: " << c.socketLeader
               << " socket: " << c.socket << " numaNode: " << c.numaNode
               << " cumulativeMaxSocket: " << c.cumulativeMaxSocket
               << " osContext: " << c.osContext
-              << " osNumaNode: " << c.osNumaNode << "\n";
+              << " osNumaNode: " << c.osNumaNode << " l3Domain: " << c.l3Domain
+              << " l3Leader: " << c.l3Leader << "\n";
   }
   return 0;
 }
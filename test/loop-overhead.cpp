@@ -20,6 +20,7 @@
 #include "galois/Galois.h"
 #include "galois/Timer.h"
 #include "galois/substrate/ThreadPool.h"
+#include "galois/substrate/Termination.h"
 
 #include <iostream>
 #include <cstdlib>
@@ -123,6 +124,7 @@ void test(
 }
 
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
   using namespace std::placeholders;
 #pragma omp parallel for
   for (int x = 0; x < 100; ++x) {
@@ -139,6 +141,10 @@ int main(int argc, char** argv) {
     maxVector = 1024 * 1024;
 
   unsigned M = galois::substrate::getThreadPool().getMaxThreads() / 2;
+  // foreach timings include termination detection; rerun with
+  // GALOIS_TERM=ring|tree|topo to compare detectors
+  std::cout << "termination: "
+            << galois::substrate::getSystemTermination(1).name() << "\n\n";
   test("inline\t", 1, 16, maxVector,
        [](std::vector<unsigned>& V, unsigned num, unsigned th) {
          return t_inline(V, num);
@@ -17,9 +17,14 @@
  * Documentation, or loss or inaccuracy of data of any kind.
  */
 
+#include "galois/Galois.h"
 #include "galois/runtime/Mem.h"
+#include "galois/substrate/NumaMem.h"
 #include "galois/gIO.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace galois::runtime;
 using namespace galois::substrate;
 
@@ -29,7 +34,47 @@ struct element {
   element(int i) : val(i), next(0) {}
 };
 
+struct bigElement {
+  char data[32];
+};
+
+//! Thread 0 fills a slab, thread 1 frees it all, thread 0 must get every
+//! object back without taking a new page
+void testRemoteFree() {
+  if (galois::getActiveThreads() < 2)
+    return;
+
+  SlabHeap heap(sizeof(bigElement));
+  std::vector<void*> mine(heap.objectsPerSlab());
+
+  galois::on_each([&](unsigned tid, unsigned) {
+    if (tid == 0)
+      for (auto& p : mine)
+        p = heap.allocate(sizeof(bigElement));
+  });
+  // freed in partial batches; the last one only reaches thread 0 through the
+  // end-of-run flush
+  galois::on_each([&](unsigned tid, unsigned) {
+    if (tid == 1)
+      for (auto p : mine)
+        heap.deallocate(p);
+  });
+
+  int pagesBefore = numPagePoolAllocTotal();
+  std::vector<void*> again(mine.size());
+  galois::on_each([&](unsigned tid, unsigned) {
+    if (tid == 0)
+      for (auto& p : again)
+        p = heap.allocate(sizeof(bigElement));
+  });
+  GALOIS_ASSERT(numPagePoolAllocTotal() == pagesBefore);
+  std::sort(mine.begin(), mine.end());
+  std::sort(again.begin(), again.end());
+  GALOIS_ASSERT(mine == again);
+}
+
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
   unsigned baseAllocSize = SystemHeap::AllocSize;
 
   FixedSizeAllocator<element> falloc;
@@ -50,6 +95,18 @@ int main(int argc, char** argv) {
   }
   GALOIS_ASSERT(!last);
 
+  // Empty pages beyond the reclaim threshold go back to the page pool, where
+  // other sizes can pick them up
+  int pagesBefore = numPagePoolAllocTotal();
+  FixedSizeAllocator<bigElement> balloc;
+  for (unsigned i = 0; i < baseAllocSize / 4; ++i)
+    balloc.allocate(1);
+  GALOIS_ASSERT(numPagePoolAllocTotal() == pagesBefore);
+
+  galois::setActiveThreads(2);
+  testRemoteFree();
+  galois::setActiveThreads(1);
+
   VariableSizeHeap valloc;
   size_t allocated;
   GALOIS_ASSERT(1 < baseAllocSize);
@@ -66,5 +123,16 @@ int main(int argc, char** argv) {
     GALOIS_ASSERT(allocated);
   }
 
+  // Large allocations follow the page policy and are accounted by page size
+  PagePolicy policy = getPagePolicy();
+  setPagePolicy(PagePolicy::NORMAL);
+  size_t normalBefore = numPageBytes(PAGE_NORMAL);
+  {
+    LAptr p = largeMallocLocal(1);
+    GALOIS_ASSERT(p.get());
+  }
+  GALOIS_ASSERT(numPageBytes(PAGE_NORMAL) == normalBefore + allocSize());
+  setPagePolicy(policy);
+
   return 0;
 }
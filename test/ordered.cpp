@@ -0,0 +1,136 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+
+#include <iostream>
+#include <vector>
+
+// Each task appends its time to the log of the slot it touches and may
+// schedule a later task on another slot. Running tasks in priority order
+// keeps every slot's log sorted.
+struct Task {
+  unsigned time;
+  unsigned slot;
+};
+
+struct TaskCmp {
+  bool operator()(const Task& a, const Task& b) const {
+    return a.time < b.time;
+  }
+};
+
+//! for_each_ordered documents the comparison as "less than or equal"
+struct TaskCmpLE {
+  bool operator()(const Task& a, const Task& b) const {
+    return a.time <= b.time;
+  }
+};
+
+struct Slot {
+  galois::runtime::Lockable lock;
+  std::vector<unsigned> log;
+};
+
+void runTasks(unsigned numSlots, unsigned numTasks, bool stable) {
+  std::vector<Slot> slots(numSlots);
+  std::vector<Task> initial;
+  for (unsigned i = 0; i < numTasks; ++i) {
+    initial.push_back(Task{(i * 7919u) % numTasks, i % numSlots});
+  }
+  galois::GAccumulator<size_t> executed;
+
+  auto nhFunc = [&](const Task& t) {
+    galois::runtime::acquire(&slots[t.slot].lock, galois::MethodFlag::WRITE);
+  };
+  auto opFunc = [&](const Task& t, galois::UserContext<Task>& ctx) {
+    slots[t.slot].log.push_back(t.time);
+    executed += 1;
+    if (t.time % 3 == 0) {
+      ctx.push(Task{t.time + numTasks, (t.slot * 31 + 1) % numSlots});
+    }
+  };
+
+  if (stable) {
+    galois::for_each_ordered(initial.begin(), initial.end(), TaskCmp(), nhFunc,
+                             opFunc, "ordered-stable");
+  } else {
+    // pretend only even-timed tasks can be executed early
+    auto stabilityTest = [](const Task& t) { return t.time % 2 == 0; };
+    galois::for_each_ordered(initial.begin(), initial.end(), TaskCmp(), nhFunc,
+                             opFunc, stabilityTest, "ordered-unstable");
+  }
+
+  size_t expected = numTasks + (numTasks + 2) / 3;
+  GALOIS_ASSERT(executed.reduce() == expected, "executed ", executed.reduce(),
+                " tasks instead of ", expected);
+  for (const Slot& s : slots) {
+    GALOIS_ASSERT(std::is_sorted(s.log.begin(), s.log.end()),
+                  "tasks executed out of order");
+  }
+}
+
+// Many tasks share each priority and all of them need the same two locks;
+// equal items must neither keep aborting each other nor be left out of the
+// window
+template <typename Cmp>
+void runTies(unsigned numTasks, unsigned numPrios) {
+  std::vector<Slot> slots(2);
+  std::vector<Task> initial;
+  for (unsigned i = 0; i < numTasks; ++i) {
+    initial.push_back(Task{i % numPrios, i % 2});
+  }
+  galois::GAccumulator<size_t> executed;
+
+  auto nhFunc = [&](const Task& t) {
+    galois::runtime::acquire(&slots[t.slot].lock, galois::MethodFlag::WRITE);
+    galois::runtime::acquire(&slots[1 - t.slot].lock,
+                             galois::MethodFlag::WRITE);
+  };
+  auto opFunc = [&](const Task& t, galois::UserContext<Task>&) {
+    slots[t.slot].log.push_back(t.time);
+    executed += 1;
+  };
+  galois::for_each_ordered(initial.begin(), initial.end(), Cmp(), nhFunc,
+                           opFunc, "ordered-ties");
+
+  GALOIS_ASSERT(executed.reduce() == numTasks, "executed ", executed.reduce(),
+                " tasks instead of ", numTasks);
+  for (const Slot& s : slots) {
+    GALOIS_ASSERT(std::is_sorted(s.log.begin(), s.log.end()),
+                  "tasks executed out of order");
+  }
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  galois::setActiveThreads(4);
+
+  runTasks(1, 1000, true);
+  runTasks(64, 100000, true);
+  runTasks(64, 100000, false);
+  runTies<TaskCmp>(10000, 1);
+  runTies<TaskCmp>(10000, 8);
+  runTies<TaskCmpLE>(10000, 1);
+  runTies<TaskCmpLE>(10000, 8);
+  std::cout << "ordered executor ok\n";
+
+  return 0;
+}
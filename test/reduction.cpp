@@ -0,0 +1,71 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+#include "galois/gIO.h"
+
+#include <iostream>
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  unsigned numThreads = galois::setActiveThreads(8);
+  const int N         = 1000;
+
+  galois::GAccumulator<long> sum;
+  galois::GReduceMax<int> max;
+  galois::GReduceTuple<galois::ReduceSum<long>, galois::ReduceMax<double>,
+                       galois::ReduceMin<int>>
+      tuple;
+  galois::GVectorAccumulator<int> vec;
+
+  // the last two rounds take the per socket path even on one socket
+  for (int round = 0; round < 4; ++round) {
+    galois::internal::forceHierarchicalReduce() = round >= 2;
+    galois::do_all(galois::iterate(0, N), [&](int i) {
+      sum += i;
+      max.update(i);
+      tuple.update<0>(i);
+      tuple.update<1>(i * 0.5);
+      tuple.update<2>(i);
+      vec.update(i);
+    });
+
+    long expected = (long)N * (N - 1) / 2;
+    GALOIS_ASSERT(sum.reduce() == expected);
+    GALOIS_ASSERT(sum.reduceHierarchical() == expected);
+    GALOIS_ASSERT(sum.reduceHierarchical(true) == expected);
+    GALOIS_ASSERT(sum.reduce() == 0);
+    GALOIS_ASSERT(max.reduceAndReset() == N - 1);
+
+    auto t = tuple.reduce();
+    GALOIS_ASSERT(std::get<0>(t) == expected);
+    GALOIS_ASSERT(std::get<1>(t) == (N - 1) * 0.5);
+    GALOIS_ASSERT(std::get<2>(t) == 0);
+    GALOIS_ASSERT(tuple.reduceAndReset() == t);
+    GALOIS_ASSERT(std::get<0>(tuple.reduce()) == 0);
+
+    GALOIS_ASSERT(vec.reduceHierarchical().size() == (size_t)N);
+    GALOIS_ASSERT(vec.reduceAndReset().size() == (size_t)N);
+    GALOIS_ASSERT(vec.reduce().empty());
+  }
+
+  std::cout << "reductions ok with " << numThreads << " threads\n";
+  return 0;
+}
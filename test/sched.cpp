@@ -19,6 +19,7 @@
 
 #include "galois/Timer.h"
 #include "galois/Galois.h"
+#include "galois/Reduction.h"
 
 #include "Lonestar/BoilerPlate.h"
 
@@ -27,6 +28,7 @@
 #endif
 
 #include <iostream>
+#include <vector>
 
 static const char* name = "Scheduler Micro Benchmark";
 static const char* desc = "Measures stuff";
@@ -39,21 +41,37 @@ static llvm::cl::opt<int> ival(llvm::cl::Positional,
                                llvm::cl::desc("<init num>"),
                                llvm::cl::init(100));
 
+//! number of items processed starting from one item of value v
+static size_t expected(int v) { return v <= 0 ? 1 : 1 + v * expected(v - 1); }
+
+template <typename WL>
+void run(const std::vector<int>& v, const char* name) {
+  galois::GAccumulator<size_t> count;
+
+  galois::StatTimer T(name);
+  T.start();
+  galois::for_each(galois::iterate(v),
+                   [&](int item, auto& lwl) {
+                     count += 1;
+                     for (int i = 0; i < item; ++i)
+                       lwl.push(item - 1);
+                   },
+                   galois::wl<WL>());
+  T.stop();
+
+  GALOIS_ASSERT(count.reduce() == v.size() * expected(sval),
+                name, " processed ", count.reduce(), " items");
+}
+
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
   LonestarStart(argc, argv, name, desc, url);
 
   std::vector<int> v((int)ival, (int)sval);
 
   std::cout << "Initial: " << (int)ival << " using " << (int)sval << "\n";
 
-  galois::StatTimer T2("T2");
-  T2.start();
   using namespace galois::worklists;
-  galois::for_each(galois::iterate(v),
-                   [&](int item, auto& lwl) {
-                     for (int i = 0; i < item; ++i)
-                       lwl.push(item - 1);
-                   },
-                   galois::wl<PerSocketChunkLIFO<64>>());
-  T2.stop();
+  run<PerSocketChunkLIFO<64>>(v, "T2");
+  run<PerL3ChunkFIFO<64>>(v, "L3FIFO");
 }
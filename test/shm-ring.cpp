@@ -0,0 +1,115 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/runtime/ShmRing.h"
+#include "galois/gIO.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using galois::runtime::ShmRing;
+
+static const size_t capacity = 1 << 12;
+
+//! byte i of the stream passed through the ring
+static uint8_t streamByte(size_t i) { return (i * 131 + (i >> 8)) & 0xff; }
+
+void testSingle(void* mem) {
+  ShmRing ring = ShmRing::at(mem, 0, capacity);
+  ring.init();
+
+  std::vector<uint8_t> in(capacity + 1), out(capacity + 1);
+  for (size_t i = 0; i < in.size(); ++i)
+    in[i] = streamByte(i);
+
+  // empty ring reads nothing, full ring takes nothing
+  GALOIS_ASSERT(ring.read(out.data(), 1) == 0);
+  GALOIS_ASSERT(ring.write(in.data(), in.size()) == capacity);
+  GALOIS_ASSERT(ring.write(in.data(), 1) == 0);
+  GALOIS_ASSERT(ring.read(out.data(), out.size()) == capacity);
+  GALOIS_ASSERT(std::equal(in.begin(), in.begin() + capacity, out.begin()));
+
+  // writes and reads that straddle the end of the buffer
+  for (size_t round = 0; round < 8; ++round) {
+    size_t n = capacity / 3 + round;
+    GALOIS_ASSERT(ring.write(in.data(), n) == n);
+    GALOIS_ASSERT(ring.read(out.data(), n) == n);
+    GALOIS_ASSERT(std::equal(in.begin(), in.begin() + n, out.begin()));
+  }
+}
+
+//! stream total bytes from a child process to this one in random chunks
+void testProcesses(void* mem, size_t total) {
+  ShmRing ring = ShmRing::at(mem, 1, capacity);
+  ring.init();
+
+  pid_t child = fork();
+  GALOIS_ASSERT(child != -1);
+  if (child == 0) {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<size_t> chunk(1, capacity + capacity / 2);
+    std::vector<uint8_t> buf(capacity + capacity / 2);
+    size_t sent = 0;
+    while (sent < total) {
+      size_t n = std::min(chunk(gen), total - sent);
+      for (size_t i = 0; i < n; ++i)
+        buf[i] = streamByte(sent + i);
+      size_t done = 0;
+      while (done < n)
+        done += ring.write(buf.data() + done, n - done);
+      sent += n;
+    }
+    _exit(0);
+  }
+
+  std::mt19937 gen(2);
+  std::uniform_int_distribution<size_t> chunk(1, capacity);
+  std::vector<uint8_t> buf(capacity);
+  size_t received = 0;
+  while (received < total) {
+    size_t n = ring.read(buf.data(), chunk(gen));
+    for (size_t i = 0; i < n; ++i)
+      GALOIS_ASSERT(buf[i] == streamByte(received + i));
+    received += n;
+  }
+
+  int status;
+  GALOIS_ASSERT(waitpid(child, &status, 0) == child);
+  GALOIS_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  GALOIS_ASSERT(ring.read(buf.data(), 1) == 0);
+}
+
+int main() {
+  size_t bytes = 2 * (sizeof(ShmRing::Header) + capacity);
+  void* mem    = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  GALOIS_ASSERT(mem != MAP_FAILED);
+
+  testSingle(mem);
+  testProcesses(mem, 64 * capacity + 17);
+
+  munmap(mem, bytes);
+  std::cout << "shm ring ok\n";
+  return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/runtime/SyncEncoding.h"
+#include "galois/gIO.h"
+
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace galois::runtime;
+
+void roundTripOffsets(const std::vector<unsigned int>& in) {
+  galois::PODResizeableArray<unsigned int> offsets;
+  offsets.resize(in.size());
+  std::copy(in.begin(), in.end(), offsets.begin());
+
+  galois::PODResizeableArray<uint8_t> encoded;
+  encodeOffsets(offsets, in.size(), encoded);
+  GALOIS_ASSERT(encoded.size() == encodedOffsetsSize(offsets, in.size()));
+
+  galois::PODResizeableArray<unsigned int> decoded;
+  decodeOffsets(encoded, in.size(), decoded);
+  GALOIS_ASSERT(decoded.size() == in.size());
+  GALOIS_ASSERT(std::equal(in.begin(), in.end(), decoded.begin()));
+}
+
+//! evenly spaced offsets: the estimate is exact except for the first delta
+void checkEstimate(unsigned int stride) {
+  size_t count = 1000;
+  galois::PODResizeableArray<unsigned int> offsets;
+  offsets.resize(count);
+  for (size_t i = 0; i < count; ++i)
+    offsets[i] = i * stride;
+
+  size_t exact    = encodedOffsetsSize(offsets, count);
+  size_t estimate = estimateEncodedOffsetsSize(count, count * stride);
+  GALOIS_ASSERT(estimate >= exact && estimate - exact < 4, stride, ": ",
+                estimate, " vs ", exact);
+}
+
+template <typename ValTy>
+void roundTripValues(const std::vector<ValTy>& in, bool expectPacked) {
+  PackedValues<ValTy> packed;
+  bool isPacked = packValues<ValTy>(in, in.size(), packed);
+  GALOIS_ASSERT(isPacked == expectPacked);
+  if (!isPacked)
+    return;
+
+  std::vector<ValTy> decoded;
+  unpackValues<ValTy>(packed, in.size(), decoded);
+  GALOIS_ASSERT(decoded == in);
+}
+
+int main() {
+  std::mt19937 gen(0);
+
+  // offsets: deltas around the 7 bit boundaries of the varints
+  roundTripOffsets({});
+  roundTripOffsets({0});
+  roundTripOffsets({0, 127, 128, 255, 16383, 16384, 16512});
+  roundTripOffsets({5, std::numeric_limits<unsigned int>::max()});
+  {
+    std::vector<unsigned int> sorted(10000);
+    std::uniform_int_distribution<unsigned int> gap(0, 1000);
+    unsigned int cur = 0;
+    for (auto& o : sorted)
+      o = cur += gap(gen);
+    roundTripOffsets(sorted);
+  }
+  GALOIS_ASSERT(estimateEncodedOffsetsSize(0, 100) == 0);
+  for (unsigned int stride : {1, 127, 128, 16383, 16384})
+    checkEstimate(stride);
+
+  // values: equal values need 0 bits, mixed signs, bit widths that straddle
+  // word boundaries
+  roundTripValues<uint32_t>({7, 7, 7}, true);
+  roundTripValues<int32_t>({-5, 3, -1, 0, 2}, true);
+  roundTripValues<int8_t>({-100, 0, 27}, true);
+  roundTripValues<int8_t>({-128, 127}, false);
+  roundTripValues<uint64_t>({0, (uint64_t(1) << 63) - 1, 42}, true);
+  roundTripValues<uint64_t>({0, std::numeric_limits<uint64_t>::max()}, false);
+  {
+    std::vector<uint32_t> values(1000);
+    std::uniform_int_distribution<uint32_t> dist(100000, 100000 + (1 << 13));
+    for (auto& v : values)
+      v = dist(gen);
+    roundTripValues<uint32_t>(values, true);
+  }
+  roundTripValues<float>({1.0f, 2.0f}, false);
+  roundTripValues<uint32_t>({}, false);
+
+  std::cout << "sync encoding ok\n";
+  return 0;
+}
@@ -19,6 +19,18 @@
 
 #include "dist-graph-convert-helpers.h"
 
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/version.hpp>
+#if BOOST_VERSION >= 106700
+#include <boost/iostreams/filter/zstd.hpp>
+#endif
+
+#include <cstring>
+
+uint64_t shuffleBatchSize = 0;
+
 std::vector<uint32_t> readRandomNodeMapping(const std::string& nodeMapBinary,
                                             uint64_t nodeOffset,
                                             uint64_t numToRead) {
@@ -116,6 +128,94 @@ uint32_t findOwner(const uint64_t gID,
   return -1;
 }
 
+namespace {
+
+enum class Compression { none, gzip, zstd };
+
+Compression getCompression(const std::string& inputFile) {
+  std::ifstream file(inputFile, std::ios::binary);
+  unsigned char magic[4] = {0, 0, 0, 0};
+  file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+
+  if (file.gcount() >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+    return Compression::gzip;
+  }
+  if (file.gcount() == 4 && magic[0] == 0x28 && magic[1] == 0xb5 &&
+      magic[2] == 0x2f && magic[3] == 0xfd) {
+    return Compression::zstd;
+  }
+  return Compression::none;
+}
+
+} // namespace
+
+bool isCompressedEdgeList(const std::string& inputFile) {
+  return getCompression(inputFile) != Compression::none;
+}
+
+void forEachLocalEdgeListBlock(
+    const std::string& inputFile, uint64_t blockSize,
+    const std::function<void(const char*, const char*)>& parseBlock) {
+  auto& net              = galois::runtime::getSystemNetworkInterface();
+  uint64_t hostID        = net.ID;
+  uint64_t totalNumHosts = net.Num;
+
+  boost::iostreams::filtering_istream in;
+  switch (getCompression(inputFile)) {
+  case Compression::gzip:
+    in.push(boost::iostreams::gzip_decompressor());
+    break;
+  case Compression::zstd:
+#if BOOST_VERSION >= 106700
+    in.push(boost::iostreams::zstd_decompressor());
+    break;
+#else
+    GALOIS_DIE("zstd input needs Boost 1.67 or newer");
+#endif
+  default:
+    GALOIS_DIE("edge list is not gzip or zstd compressed");
+  }
+  in.push(boost::iostreams::file_source(inputFile, std::ios::binary));
+
+  std::vector<char> block(blockSize);
+  uint64_t filled     = 0;
+  uint64_t blockIndex = 0;
+
+  try {
+    while (true) {
+      in.read(block.data() + filled, blockSize - filled);
+      filled += in.gcount();
+      bool atEnd = !in;
+
+      // the block ends after its last full line; the rest begins the next one
+      uint64_t blockEnd = filled;
+      if (!atEnd) {
+        while (blockEnd > 0 && block[blockEnd - 1] != '\n') {
+          blockEnd--;
+        }
+        GALOIS_ASSERT(blockEnd > 0, "edge list line longer than ", blockSize,
+                      " bytes");
+      }
+
+      if (blockIndex % totalNumHosts == hostID) {
+        parseBlock(block.data(), block.data() + blockEnd);
+      }
+      blockIndex++;
+
+      std::memmove(block.data(), block.data() + blockEnd, filled - blockEnd);
+      filled -= blockEnd;
+      if (atEnd) {
+        break;
+      }
+    }
+  } catch (const std::ios_base::failure& e) {
+    GALOIS_DIE("failed to decompress ", inputFile, ": ", e.what());
+  }
+
+  printf("[%lu] Parsed %lu of %lu blocks\n", hostID,
+         (blockIndex + totalNumHosts - 1 - hostID) / totalNumHosts, blockIndex);
+}
+
 uint64_t getFileSize(std::ifstream& openFile) {
   openFile.seekg(0, std::ios_base::end);
   return openFile.tellg();
@@ -676,29 +776,59 @@ void writeGrHeader(MPI_File& gr, uint64_t version, uint64_t sizeOfEdge,
                              MPI_UINT64_T, MPI_STATUS_IGNORE));
 }
 
-void writeNodeIndexData(MPI_File& gr, uint64_t nodesToWrite,
-                        uint64_t nodeIndexOffset,
-                        const std::vector<uint64_t>& edgePrefixSum) {
+/**
+ * Collectively writes an array to a file: each host passes its own offset and
+ * data, and MPI may aggregate the writes of all hosts into large contiguous
+ * requests. Writes are split into chunks of at most INT_MAX elements; every
+ * host takes part in every chunk (with 0 elements once it is done) since all
+ * hosts must make the same number of collective calls.
+ *
+ * @param file File to write to
+ * @param offset byte offset into the file at which to write the data
+ * @param data array to write
+ * @param numToWrite number of elements in data
+ * @param dataType MPI type of the elements
+ * @param typeSize size in bytes of an element
+ */
+static void writeAtAll(MPI_File& file, uint64_t offset, const void* data,
+                       uint64_t numToWrite, MPI_Datatype dataType,
+                       uint64_t typeSize) {
   MPI_Status writeStatus;
-  uint64_t totalWritten = 0;
-  while (nodesToWrite != 0) {
-    uint64_t toWrite =
-        std::min(nodesToWrite, (uint64_t)std::numeric_limits<int>::max());
+  const char* toWriteFrom = static_cast<const char*>(data);
+
+  while (true) {
+    int localMore = (numToWrite != 0);
+    int globalMore;
+    MPICheck(MPI_Allreduce(&localMore, &globalMore, 1, MPI_INT, MPI_LOR,
+                           MPI_COMM_WORLD));
+    if (!globalMore) {
+      break;
+    }
 
-    MPICheck(MPI_File_write_at(gr, nodeIndexOffset,
-                               ((uint64_t*)edgePrefixSum.data()) + totalWritten,
-                               toWrite, MPI_UINT64_T, &writeStatus));
+    uint64_t toWrite =
+        std::min(numToWrite, (uint64_t)std::numeric_limits<int>::max());
+    MPICheck(MPI_File_write_at_all(file, offset, toWriteFrom, toWrite,
+                                   dataType, &writeStatus));
 
-    int itemsWritten;
-    MPI_Get_count(&writeStatus, MPI_UINT64_T, &itemsWritten);
-    GALOIS_ASSERT(itemsWritten != MPI_UNDEFINED,
-                  "itemsWritten is MPI_UNDEFINED");
-    nodesToWrite -= itemsWritten;
-    totalWritten += itemsWritten;
-    nodeIndexOffset += itemsWritten * sizeof(uint64_t);
+    int itemsWritten = 0;
+    if (toWrite != 0) {
+      MPI_Get_count(&writeStatus, dataType, &itemsWritten);
+      GALOIS_ASSERT(itemsWritten != MPI_UNDEFINED,
+                    "itemsWritten is MPI_UNDEFINED");
+    }
+    numToWrite -= itemsWritten;
+    toWriteFrom += itemsWritten * typeSize;
+    offset += itemsWritten * typeSize;
   }
 }
 
+void writeNodeIndexData(MPI_File& gr, uint64_t nodesToWrite,
+                        uint64_t nodeIndexOffset,
+                        const std::vector<uint64_t>& edgePrefixSum) {
+  writeAtAll(gr, nodeIndexOffset, edgePrefixSum.data(), nodesToWrite,
+             MPI_UINT64_T, sizeof(uint64_t));
+}
+
 // vector of vectors version
 void writeEdgeDestData(MPI_File& gr, uint64_t edgeDestOffset,
                        std::vector<std::vector<uint32_t>>& localSrcToDest) {
@@ -731,49 +861,50 @@ void writeEdgeDestData(MPI_File& gr, uint64_t edgeDestOffset,
 // 1 vector version (MUCH FASTER, USE WHEN POSSIBLE)
 void writeEdgeDestData(MPI_File& gr, uint64_t edgeDestOffset,
                        std::vector<uint32_t>& destVector) {
-  MPI_Status writeStatus;
-  uint64_t numToWrite   = destVector.size();
-  uint64_t totalWritten = 0;
-
-  while (numToWrite != 0) {
-    uint64_t toWrite =
-        std::min(numToWrite, (uint64_t)std::numeric_limits<int>::max());
-
-    MPICheck(MPI_File_write_at(gr, edgeDestOffset,
-                               ((uint32_t*)destVector.data()) + totalWritten,
-                               toWrite, MPI_UINT32_T, &writeStatus));
-
-    int itemsWritten;
-    MPI_Get_count(&writeStatus, MPI_UINT32_T, &itemsWritten);
-    GALOIS_ASSERT(itemsWritten != MPI_UNDEFINED,
-                  "itemsWritten is MPI_UNDEFINED");
-    numToWrite -= itemsWritten;
-    totalWritten += itemsWritten;
-    edgeDestOffset += sizeof(uint32_t) * itemsWritten;
-  }
+  writeAtAll(gr, edgeDestOffset, destVector.data(), destVector.size(),
+             MPI_UINT32_T, sizeof(uint32_t));
 }
 
 void writeEdgeDataData(MPI_File& gr, uint64_t edgeDataOffset,
                        const std::vector<uint32_t>& edgeDataToWrite) {
-  MPI_Status writeStatus;
-  uint64_t numToWrite = edgeDataToWrite.size();
-  uint64_t numWritten = 0;
-
-  while (numToWrite != 0) {
-    uint64_t toWrite =
-        std::min(numToWrite, (uint64_t)std::numeric_limits<int>::max());
+  writeAtAll(gr, edgeDataOffset, edgeDataToWrite.data(),
+             edgeDataToWrite.size(), MPI_UINT32_T, sizeof(uint32_t));
+}
 
-    MPICheck(MPI_File_write_at(gr, edgeDataOffset,
-                               ((uint32_t*)edgeDataToWrite.data()) + numWritten,
-                               toWrite, MPI_UINT32_T, &writeStatus));
-    int itemsWritten;
-    MPI_Get_count(&writeStatus, MPI_UINT32_T, &itemsWritten);
-    GALOIS_ASSERT(itemsWritten != MPI_UNDEFINED,
-                  "itemsWritten is MPI_UNDEFINED");
-    numToWrite -= itemsWritten;
-    numWritten += itemsWritten;
-    edgeDataOffset += itemsWritten * sizeof(uint32_t);
+/**
+ * Builds the node index data (the edge prefix sum) of the local nodes.
+ *
+ * @param localSrcToDest the vector at index i specifies the destinations of
+ * local node i
+ * @param globalEdgeOffset number of edges before the first local edge
+ * @returns node index data of the local nodes
+ */
+static std::vector<uint64_t>
+getEdgePrefixSum(const std::vector<std::vector<uint32_t>>& localSrcToDest,
+                 uint64_t globalEdgeOffset) {
+  std::vector<uint64_t> edgePrefixSum(localSrcToDest.size());
+  uint64_t edgeCount = globalEdgeOffset;
+  for (unsigned i = 0; i < localSrcToDest.size(); i++) {
+    edgeCount += localSrcToDest[i].size();
+    edgePrefixSum[i] = edgeCount;
   }
+  return edgePrefixSum;
+}
+
+/**
+ * Determines if any host has edge data to write. Hosts without nodes have no
+ * edge data storage, so they cannot tell on their own.
+ *
+ * @param localSrcToData edge data of this host's nodes
+ * @returns true if edge data needs to be written
+ */
+static bool
+anyEdgeData(const std::vector<std::vector<uint32_t>>& localSrcToData) {
+  int localHasData = !localSrcToData.empty();
+  int hasData;
+  MPICheck(MPI_Allreduce(&localHasData, &hasData, 1, MPI_INT, MPI_LOR,
+                         MPI_COMM_WORLD));
+  return hasData;
 }
 
 void writeToGr(const std::string& outputFile, uint64_t totalNumNodes,
@@ -782,6 +913,7 @@ void writeToGr(const std::string& outputFile, uint64_t totalNumNodes,
                std::vector<std::vector<uint32_t>>& localSrcToDest,
                std::vector<std::vector<uint32_t>>& localSrcToData) {
   uint64_t hostID = galois::runtime::getSystemNetworkInterface().ID;
+  bool writeData  = anyEdgeData(localSrcToData);
 
   printf("[%lu] Beginning write to file\n", hostID);
   MPI_File newGR;
@@ -790,7 +922,7 @@ void writeToGr(const std::string& outputFile, uint64_t totalNumNodes,
                          &newGR));
 
   if (hostID == 0) {
-    if (localSrcToData.empty()) {
+    if (!writeData) {
       writeGrHeader(newGR, 1, 0, totalNumNodes, totalNumEdges);
     } else {
       // edge data size hard set to 4 if there is data to write (uint32_t)
@@ -798,46 +930,39 @@ void writeToGr(const std::string& outputFile, uint64_t totalNumNodes,
     }
   }
 
-  if (localNumNodes > 0) {
-    // prepare edge prefix sum for file writing
-    std::vector<uint64_t> edgePrefixSum(localNumNodes);
-    edgePrefixSum[0] = localSrcToDest[0].size();
-    for (unsigned i = 1; i < localNumNodes; i++) {
-      edgePrefixSum[i] = (edgePrefixSum[i - 1] + localSrcToDest[i].size());
-    }
-
-    // account for edge offset
-    for (unsigned i = 0; i < localNumNodes; i++) {
-      edgePrefixSum[i] = edgePrefixSum[i] + globalEdgeOffset;
-    }
-
-    // begin file writing
-    uint64_t headerSize      = sizeof(uint64_t) * 4;
-    uint64_t nodeIndexOffset = headerSize + (localNodeBegin * sizeof(uint64_t));
-    printf("[%lu] Write node index data\n", hostID);
-    writeNodeIndexData(newGR, localNumNodes, nodeIndexOffset, edgePrefixSum);
-    freeVector(edgePrefixSum);
-
-    uint64_t edgeDestOffset = headerSize + (totalNumNodes * sizeof(uint64_t)) +
-                              globalEdgeOffset * sizeof(uint32_t);
-    printf("[%lu] Write edge dest data\n", hostID);
-    std::vector<uint32_t> destVector = flattenVectors(localSrcToDest);
-    freeVector(localSrcToDest);
-    writeEdgeDestData(newGR, edgeDestOffset, destVector);
-
-    // edge data writing if necessary
-    if (!localSrcToData.empty()) {
-      uint64_t edgeDataOffset = getOffsetToLocalEdgeData(
-          totalNumNodes, totalNumEdges, globalEdgeOffset);
-      printf("[%lu] Write edge data data\n", hostID);
-      std::vector<uint32_t> dataVector = flattenVectors(localSrcToData);
-      freeVector(localSrcToData);
-      writeEdgeDataData(newGR, edgeDataOffset, dataVector);
-    }
-
-    printf("[%lu] Write to file done\n", hostID);
+  // writes are collective: hosts without nodes write nothing, but still
+  // take part
+  GALOIS_ASSERT(localSrcToDest.size() == localNumNodes);
+  std::vector<uint64_t> edgePrefixSum =
+      getEdgePrefixSum(localSrcToDest, globalEdgeOffset);
+
+  // begin file writing
+  uint64_t headerSize      = sizeof(uint64_t) * 4;
+  uint64_t nodeIndexOffset = headerSize + (localNodeBegin * sizeof(uint64_t));
+  printf("[%lu] Write node index data\n", hostID);
+  writeNodeIndexData(newGR, localNumNodes, nodeIndexOffset, edgePrefixSum);
+  freeVector(edgePrefixSum);
+
+  uint64_t edgeDestOffset = headerSize + (totalNumNodes * sizeof(uint64_t)) +
+                            globalEdgeOffset * sizeof(uint32_t);
+  printf("[%lu] Write edge dest data\n", hostID);
+  std::vector<uint32_t> destVector = flattenVectors(localSrcToDest);
+  freeVector(localSrcToDest);
+  writeEdgeDestData(newGR, edgeDestOffset, destVector);
+  freeVector(destVector);
+
+  // edge data writing if necessary
+  if (writeData) {
+    uint64_t edgeDataOffset = getOffsetToLocalEdgeData(
+        totalNumNodes, totalNumEdges, globalEdgeOffset);
+    printf("[%lu] Write edge data data\n", hostID);
+    std::vector<uint32_t> dataVector = flattenVectors(localSrcToData);
+    freeVector(localSrcToData);
+    writeEdgeDataData(newGR, edgeDataOffset, dataVector);
   }
 
+  printf("[%lu] Write to file done\n", hostID);
+
   MPICheck(MPI_File_close(&newGR));
 }
 
@@ -847,6 +972,7 @@ void writeToLux(const std::string& outputFile, uint64_t totalNumNodes,
                 std::vector<std::vector<uint32_t>>& localSrcToDest,
                 std::vector<std::vector<uint32_t>>& localSrcToData) {
   uint64_t hostID = galois::runtime::getSystemNetworkInterface().ID;
+  bool writeData  = anyEdgeData(localSrcToData);
 
   printf("[%lu] Beginning write to file\n", hostID);
   MPI_File newGR;
@@ -864,53 +990,46 @@ void writeToLux(const std::string& outputFile, uint64_t totalNumNodes,
                                MPI_UINT64_T, MPI_STATUS_IGNORE));
   }
 
-  if (localNumNodes > 0) {
-    // prepare edge prefix sum for file writing
-    std::vector<uint64_t> edgePrefixSum(localNumNodes);
-    edgePrefixSum[0] = localSrcToDest[0].size();
-    for (unsigned i = 1; i < localNumNodes; i++) {
-      edgePrefixSum[i] = (edgePrefixSum[i - 1] + localSrcToDest[i].size());
-    }
-
-    // account for edge offset
-    for (unsigned i = 0; i < localNumNodes; i++) {
-      edgePrefixSum[i] = edgePrefixSum[i] + globalEdgeOffset;
-    }
-
-    // begin file writing
-    // Lux header differs from Galois header
-    uint64_t headerSize      = sizeof(uint32_t) + sizeof(uint64_t);
-    uint64_t nodeIndexOffset = headerSize + (localNodeBegin * sizeof(uint64_t));
-
-    printf("[%lu] Write node index data\n", hostID);
-    writeNodeIndexData(newGR, localNumNodes, nodeIndexOffset, edgePrefixSum);
-    freeVector(edgePrefixSum);
-
-    uint64_t edgeDestOffset = headerSize + (totalNumNodes * sizeof(uint64_t)) +
-                              globalEdgeOffset * sizeof(uint32_t);
-    printf("[%lu] Write edge dest data\n", hostID);
-    std::vector<uint32_t> destVector = flattenVectors(localSrcToDest);
-    freeVector(localSrcToDest);
-    writeEdgeDestData(newGR, edgeDestOffset, destVector);
-
-    // edge data writing if necessary
-    if (!localSrcToData.empty()) {
-      uint64_t byteOffsetToEdgeData = sizeof(uint32_t) + sizeof(uint64_t) +
-                                      (totalNumNodes * sizeof(uint64_t)) +
-                                      (totalNumEdges * sizeof(uint32_t));
-      byteOffsetToEdgeData += globalEdgeOffset * sizeof(uint32_t);
-      // NO PADDING
-      uint64_t edgeDataOffset = byteOffsetToEdgeData;
-
-      printf("[%lu] Write edge data data\n", hostID);
-      std::vector<uint32_t> dataVector = flattenVectors(localSrcToData);
-      freeVector(localSrcToData);
-      writeEdgeDataData(newGR, edgeDataOffset, dataVector);
-    }
-
-    printf("[%lu] Write to file done\n", hostID);
+  // writes are collective: hosts without nodes write nothing, but still
+  // take part
+  GALOIS_ASSERT(localSrcToDest.size() == localNumNodes);
+  std::vector<uint64_t> edgePrefixSum =
+      getEdgePrefixSum(localSrcToDest, globalEdgeOffset);
+
+  // begin file writing
+  // Lux header differs from Galois header
+  uint64_t headerSize      = sizeof(uint32_t) + sizeof(uint64_t);
+  uint64_t nodeIndexOffset = headerSize + (localNodeBegin * sizeof(uint64_t));
+
+  printf("[%lu] Write node index data\n", hostID);
+  writeNodeIndexData(newGR, localNumNodes, nodeIndexOffset, edgePrefixSum);
+  freeVector(edgePrefixSum);
+
+  uint64_t edgeDestOffset = headerSize + (totalNumNodes * sizeof(uint64_t)) +
+                            globalEdgeOffset * sizeof(uint32_t);
+  printf("[%lu] Write edge dest data\n", hostID);
+  std::vector<uint32_t> destVector = flattenVectors(localSrcToDest);
+  freeVector(localSrcToDest);
+  writeEdgeDestData(newGR, edgeDestOffset, destVector);
+  freeVector(destVector);
+
+  // edge data writing if necessary
+  if (writeData) {
+    uint64_t byteOffsetToEdgeData = sizeof(uint32_t) + sizeof(uint64_t) +
+                                    (totalNumNodes * sizeof(uint64_t)) +
+                                    (totalNumEdges * sizeof(uint32_t));
+    byteOffsetToEdgeData += globalEdgeOffset * sizeof(uint32_t);
+    // NO PADDING
+    uint64_t edgeDataOffset = byteOffsetToEdgeData;
+
+    printf("[%lu] Write edge data data\n", hostID);
+    std::vector<uint32_t> dataVector = flattenVectors(localSrcToData);
+    freeVector(localSrcToData);
+    writeEdgeDataData(newGR, edgeDataOffset, dataVector);
   }
 
+  printf("[%lu] Write to file done\n", hostID);
+
   MPICheck(MPI_File_close(&newGR));
 }
 
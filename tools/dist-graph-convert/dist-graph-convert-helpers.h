@@ -22,7 +22,9 @@
 
 #include <mutex>
 #include <fstream>
+#include <functional>
 #include <random>
+#include <cctype>
 #include <mpi.h>
 
 #include "galois/Galois.h"
@@ -168,6 +170,165 @@ loadEdgesFromEdgeList(std::ifstream& edgeListFile, uint64_t localStartByte,
   return localEdges;
 }
 
+/**
+ * Checks if a file starts with the magic number of a gzip or zstd stream.
+ *
+ * @param inputFile file to check
+ * @returns true if the file is gzip or zstd compressed
+ */
+bool isCompressedEdgeList(const std::string& inputFile);
+
+/**
+ * Decompresses a gzip or zstd compressed edge list as a stream, cuts it into
+ * blocks of whole lines, and hands every numHosts-th block (starting at this
+ * host's ID) to a parse function. Compressed streams cannot be seeked into, so
+ * every host inflates the entire stream, but each only parses its own blocks.
+ *
+ * @param inputFile compressed edge list
+ * @param blockSize size in bytes of the blocks (lines may not be longer)
+ * @param parseBlock called with the begin and end of each block this host
+ * is responsible for
+ */
+void forEachLocalEdgeListBlock(
+    const std::string& inputFile, uint64_t blockSize,
+    const std::function<void(const char*, const char*)>& parseBlock);
+
+/**
+ * Parses a number from an edge list buffer, skipping leading whitespace.
+ *
+ * @param cur where to start parsing
+ * @param end end of the buffer
+ * @param value (output) parsed number
+ * @returns pointer to the first character after the number
+ */
+inline const char* parseEdgeListNumber(const char* cur, const char* end,
+                                       uint64_t& value) {
+  while (cur != end && std::isspace(static_cast<unsigned char>(*cur))) {
+    cur++;
+  }
+  GALOIS_ASSERT(cur != end && *cur >= '0' && *cur <= '9',
+                "malformed edge list");
+  value = 0;
+  while (cur != end && *cur >= '0' && *cur <= '9') {
+    value = value * 10 + (*cur - '0');
+    cur++;
+  }
+  return cur;
+}
+
+/**
+ * Parses the edges in a buffer of whole edge list lines and appends them to
+ * a vector in the same layout as loadEdgesFromEdgeList.
+ *
+ * @tparam EdgeDataTy type of edge data to read
+ * @param cur beginning of the buffer
+ * @param end end of the buffer
+ * @param totalNumNodes Total number of nodes in the graph: used for correctness
+ * checking of src/dest ids
+ * @param startAtOne true if the edge list node ids start at 1
+ * @param ignoreWeights true if a third column should be skipped
+ * @param edges (output) vector to append the edges to
+ */
+template <typename EdgeDataTy>
+void parseEdgeListRange(const char* cur, const char* end,
+                        uint64_t totalNumNodes, bool startAtOne,
+                        bool ignoreWeights, std::vector<uint32_t>& edges) {
+  while (true) {
+    while (cur != end && std::isspace(static_cast<unsigned char>(*cur))) {
+      cur++;
+    }
+    if (cur == end) {
+      break;
+    }
+
+    uint64_t src;
+    uint64_t dst;
+    cur = parseEdgeListNumber(cur, end, src);
+    cur = parseEdgeListNumber(cur, end, dst);
+    if (startAtOne) {
+      src--;
+      dst--;
+    }
+    GALOIS_ASSERT(src < totalNumNodes, "src ", src, " and ", totalNumNodes);
+    GALOIS_ASSERT(dst < totalNumNodes, "dst ", dst, " and ", totalNumNodes);
+    edges.emplace_back(src);
+    edges.emplace_back(dst);
+
+    // same restriction as the uncompressed path: uint32_t data only
+    if (ignoreWeights || !std::is_void<EdgeDataTy>::value) {
+      uint64_t edgeData;
+      cur = parseEdgeListNumber(cur, end, edgeData);
+      if (!ignoreWeights) {
+        edges.emplace_back(edgeData);
+      }
+    }
+  }
+}
+
+/**
+ * Reads this host's share of the edges of a gzip or zstd compressed edge list
+ * into memory. Blocks are assigned to hosts round robin; each block is split
+ * among threads at line boundaries.
+ *
+ * @tparam EdgeDataTy type of edge data to read
+ * @param inputFile compressed edge list
+ * @param totalNumNodes Total number of nodes in the graph: used for correctness
+ * checking of src/dest ids
+ * @param startAtOne true if the edge list node ids start at 1
+ * @param ignoreWeights true if the edge list has weights that should be
+ * skipped
+ * @param blockSize size in bytes of the blocks hosts take turns parsing
+ * @returns Vector representing the read in edges: every 2-3 elements represents
+ * src, dest, and edge data (if the latter exists)
+ */
+template <typename EdgeDataTy>
+std::vector<uint32_t> loadEdgesFromCompressedEdgeList(
+    const std::string& inputFile, uint64_t totalNumNodes,
+    bool startAtOne = false, bool ignoreWeights = false,
+    uint64_t blockSize = (uint64_t)1 << 26) {
+  std::vector<uint32_t> localEdges;
+  galois::substrate::PerThreadStorage<std::vector<uint32_t>> threadEdges;
+
+  forEachLocalEdgeListBlock(
+      inputFile, blockSize, [&](const char* blockBegin, const char* blockEnd) {
+        galois::on_each(
+            [&](unsigned tid, unsigned nthreads) {
+              const char* begin;
+              const char* end;
+              std::tie(begin, end) =
+                  galois::block_range(blockBegin, blockEnd, tid, nthreads);
+              // move both ends forward to the next line start; the end
+              // moves the same way as the next thread's beginning
+              while (begin != blockBegin && begin != blockEnd &&
+                     *(begin - 1) != '\n') {
+                begin++;
+              }
+              while (end != blockBegin && end != blockEnd &&
+                     *(end - 1) != '\n') {
+                end++;
+              }
+              if (begin < end) {
+                parseEdgeListRange<EdgeDataTy>(begin, end, totalNumNodes,
+                                               startAtOne, ignoreWeights,
+                                               *threadEdges.getLocal());
+              }
+            },
+            galois::loopname("ParseEdgeListBlock"));
+
+        for (unsigned i = 0; i < threadEdges.size(); i++) {
+          auto& edges = *threadEdges.getRemote(i);
+          localEdges.insert(localEdges.end(), edges.begin(), edges.end());
+          edges.clear();
+        }
+      });
+
+  printf("[%u] Local num edges from file is %lu\n",
+         galois::runtime::getSystemNetworkInterface().ID,
+         getNumEdges<EdgeDataTy>(localEdges));
+
+  return localEdges;
+}
+
 /**
  * Gets a mapping of host to nodes of all hosts in the system. Divides
  * nodes evenly among hosts.
@@ -811,10 +972,13 @@ std::vector<uint32_t> loadMappedSourceEdgesFromBufferedGraph(
  * @tparam EdgeDataTy type of edge data to read
  * @param hostToNodes mapping of a host to the nodes it is assigned
  * @param localEdges in-memory buffer of edges this host has loaded
+ * @param edgeBegin first local edge to count
+ * @param edgeEnd one past the last local edge to count
  */
 template <typename EdgeDataTy>
 void sendEdgeCounts(const std::vector<Uint64Pair>& hostToNodes,
-                    const std::vector<uint32_t>& localEdges) {
+                    const std::vector<uint32_t>& localEdges,
+                    uint64_t edgeBegin, uint64_t edgeEnd) {
   auto& net              = galois::runtime::getSystemNetworkInterface();
   uint64_t hostID        = net.ID;
   uint64_t totalNumHosts = net.Num;
@@ -823,9 +987,8 @@ void sendEdgeCounts(const std::vector<Uint64Pair>& hostToNodes,
 
   std::vector<galois::GAccumulator<uint64_t>> numEdgesPerHost(totalNumHosts);
 
-  uint64_t localNumEdges = getNumEdges<EdgeDataTy>(localEdges);
   // determine to which host each edge will go
-  galois::do_all(galois::iterate((uint64_t)0, localNumEdges),
+  galois::do_all(galois::iterate(edgeBegin, edgeEnd),
                  [&](uint64_t edgeIndex) {
                    uint32_t src;
                    if (std::is_void<EdgeDataTy>::value) {
@@ -864,6 +1027,8 @@ uint64_t receiveEdgeCounts();
  *
  * @param hostToNodes mapping of a host to the nodes it is assigned
  * @param localEdges in-memory buffer of edges this host has loaded
+ * @param edgeBegin first local edge to send
+ * @param edgeEnd one past the last local edge to send
  * @param localSrcToDest local mapping of LOCAL sources to destinations (we
  * may have some edges that do not need sending; they are saved here)
  * @param localSrcToData Vector of vectors: the vector at index i specifies
@@ -880,6 +1045,7 @@ template <
     typename std::enable_if<std::is_void<EdgeDataTy>::value>::type* = nullptr>
 void sendAssignedEdges(const std::vector<Uint64Pair>& hostToNodes,
                        const std::vector<uint32_t>& localEdges,
+                       uint64_t edgeBegin, uint64_t edgeEnd,
                        std::vector<std::vector<uint32_t>>& localSrcToDest,
                        std::vector<std::vector<uint32_t>>& localSrcToData,
                        std::vector<std::mutex>& nodeLocks) {
@@ -907,9 +1073,8 @@ void sendAssignedEdges(const std::vector<Uint64Pair>& hostToNodes,
 
   printf("[%lu] Passing through edges and assigning\n", hostID);
 
-  uint64_t localNumEdges = getNumEdges<EdgeDataTy>(localEdges);
   // determine to which host each edge will go
-  galois::do_all(galois::iterate((uint64_t)0, localNumEdges),
+  galois::do_all(galois::iterate(edgeBegin, edgeEnd),
                  [&](uint64_t edgeIndex) {
                    uint32_t src       = localEdges[edgeIndex * 2];
                    uint32_t edgeOwner = findOwner(src, hostToNodes);
@@ -988,6 +1153,7 @@ template <
     typename std::enable_if<!std::is_void<EdgeDataTy>::value>::type* = nullptr>
 void sendAssignedEdges(const std::vector<Uint64Pair>& hostToNodes,
                        const std::vector<uint32_t>& localEdges,
+                       uint64_t edgeBegin, uint64_t edgeEnd,
                        std::vector<std::vector<uint32_t>>& localSrcToDest,
                        std::vector<std::vector<uint32_t>>& localSrcToData,
                        std::vector<std::mutex>& nodeLocks) {
@@ -997,11 +1163,12 @@ void sendAssignedEdges(const std::vector<Uint64Pair>& hostToNodes,
 
   printf("[%lu] Going to send assigned edges\n", hostID);
 
-  // initialize localsrctodata
-  GALOIS_ASSERT(localSrcToData.empty());
+  // initialize localsrctodata (on the first batch of edges sent)
   using EdgeVectorTy = std::vector<std::vector<uint32_t>>;
-  EdgeVectorTy tmp   = EdgeVectorTy(localSrcToDest.size());
-  localSrcToData.swap(tmp);
+  if (localSrcToData.empty()) {
+    EdgeVectorTy tmp = EdgeVectorTy(localSrcToDest.size());
+    localSrcToData.swap(tmp);
+  }
   GALOIS_ASSERT(localSrcToData.size() == localSrcToDest.size());
 
   galois::substrate::PerThreadStorage<EdgeVectorTy> dstVectors(totalNumHosts);
@@ -1023,10 +1190,9 @@ void sendAssignedEdges(const std::vector<Uint64Pair>& hostToNodes,
 
   printf("[%lu] Passing through edges and assigning\n", hostID);
 
-  uint64_t localNumEdges = getNumEdges<EdgeDataTy>(localEdges);
   // determine to which host each edge will go
   galois::do_all(
-      galois::iterate((uint64_t)0, localNumEdges),
+      galois::iterate(edgeBegin, edgeEnd),
       [&](uint64_t edgeIndex) {
         uint32_t src       = localEdges[edgeIndex * 3];
         uint32_t edgeOwner = findOwner(src, hostToNodes);
@@ -1159,7 +1325,8 @@ void writeGrHeader(MPI_File& gr, uint64_t version, uint64_t sizeOfEdge,
                    uint64_t totalNumNodes, uint64_t totalEdgeCount);
 
 /**
- * Writes the node index data of a galois binary graph.
+ * Writes the node index data of a galois binary graph. Collective: every host
+ * must call it (hosts with nothing to write pass 0 nodes).
  *
  * @param gr File to write to
  * @param nodesToWrite number of nodes to write
@@ -1173,7 +1340,8 @@ void writeNodeIndexData(MPI_File& gr, uint64_t nodesToWrite,
                         const std::vector<uint64_t>& edgePrefixSum);
 
 /**
- * Writes the edge destination data of a galois binary graph.
+ * Writes the edge destination data of a galois binary graph with independent
+ * (per host) writes.
  *
  * @param gr File to write to
  * @param edgeDestOffset offset into file specifying where to start writing
@@ -1184,7 +1352,9 @@ void writeEdgeDestData(MPI_File& gr, uint64_t edgeDestOffset,
                        std::vector<std::vector<uint32_t>>& localSrcToDest);
 
 /**
- * Writes the edge destination data of a galois binary graph.
+ * Writes the edge destination data of a galois binary graph. Collective: every
+ * host must call it (hosts with nothing to write pass an empty vector).
+ *
  * @param gr File to write to
  * @param edgeDestOffset offset into file specifying where to start writing
  * @param destVector Vector of edge destinations IN THE ORDER THAT THEY SHOULD
@@ -1193,7 +1363,8 @@ void writeEdgeDestData(MPI_File& gr, uint64_t edgeDestOffset,
 void writeEdgeDestData(MPI_File& gr, uint64_t edgeDestOffset,
                        std::vector<uint32_t>& destVector);
 /**
- * Writes the edge data data of a galois binary graph.
+ * Writes the edge data data of a galois binary graph. Collective: every host
+ * must call it (hosts with nothing to write pass an empty vector).
  *
  * @param gr File to write to
  * @param edgeDataOffset offset into file specifying where to start writing
@@ -1282,10 +1453,21 @@ uint64_t getOffsetToLocalEdgeData(uint64_t totalNumNodes,
  */
 Uint64Pair getLocalAssignment(uint64_t numToSplit);
 
+/**
+ * Maximum number of local edges each host sends in one round of
+ * sendAndReceiveAssignedEdges; 0 sends all edges in a single round.
+ */
+extern uint64_t shuffleBatchSize;
+
 /**
  * Given a host to node assignment, send the edges we have to the appropriate
  * place + receieve edges sent by other hosts.
  *
+ * Edges are sent in rounds of at most shuffleBatchSize edges per host, and
+ * each round is fully received before the next one starts, so the messages
+ * in flight (which would otherwise hold a second copy of all edges) stay
+ * bounded.
+ *
  * @param hostToNodes Vector specifying assignment of nodes to hosts
  * @param localEdges array that represents edges on this host (to keep or to
  * send)
@@ -1301,22 +1483,41 @@ sendAndReceiveAssignedEdges(const std::vector<Uint64Pair>& hostToNodes,
   uint64_t localNumNodes =
       hostToNodes[hostID].second - hostToNodes[hostID].first;
 
-  sendEdgeCounts<EdgeTy>(hostToNodes, localEdges);
-  std::atomic<uint64_t> edgesToReceive;
-  edgesToReceive.store(receiveEdgeCounts());
-
-  printf("[%u] Need to receive %lu edges\n", hostID, edgesToReceive.load());
+  // every host takes part in every round, so agree on the number of rounds
+  uint64_t localNumEdges = getNumEdges<EdgeTy>(localEdges);
+  uint64_t batchSize     = shuffleBatchSize
+                           ? shuffleBatchSize
+                           : std::max(localNumEdges, (uint64_t)1);
+  // at least 1 round so that sendAssignedEdges sets up edge data storage
+  uint64_t localRounds =
+      std::max((localNumEdges + batchSize - 1) / batchSize, (uint64_t)1);
+  uint64_t numRounds;
+  MPICheck(MPI_Allreduce(&localRounds, &numRounds, 1, MPI_UINT64_T, MPI_MAX,
+                         MPI_COMM_WORLD));
 
   // FIXME ONLY V1 SUPPORT
   VoVUint32 localSrcToDest(localNumNodes);
   VoVUint32 localSrcToData;
   std::vector<std::mutex> nodeLocks(localNumNodes);
 
-  sendAssignedEdges<EdgeTy>(hostToNodes, localEdges, localSrcToDest,
-                            localSrcToData, nodeLocks);
+  for (uint64_t round = 0; round < numRounds; round++) {
+    uint64_t edgeBegin = std::min(round * batchSize, localNumEdges);
+    uint64_t edgeEnd   = std::min(edgeBegin + batchSize, localNumEdges);
+
+    sendEdgeCounts<EdgeTy>(hostToNodes, localEdges, edgeBegin, edgeEnd);
+    std::atomic<uint64_t> edgesToReceive;
+    edgesToReceive.store(receiveEdgeCounts());
+
+    printf("[%u] Round %lu of %lu: need to receive %lu edges\n", hostID,
+           round + 1, numRounds, edgesToReceive.load());
+
+    sendAssignedEdges<EdgeTy>(hostToNodes, localEdges, edgeBegin, edgeEnd,
+                              localSrcToDest, localSrcToData, nodeLocks);
+    receiveAssignedEdges(edgesToReceive, hostToNodes, localSrcToDest,
+                         localSrcToData, nodeLocks);
+  }
   freeVector(localEdges);
-  receiveAssignedEdges(edgesToReceive, hostToNodes, localSrcToDest,
-                       localSrcToData, nodeLocks);
+
   return PairVoVUint32(localSrcToDest, localSrcToData);
 }
 
@@ -53,7 +53,8 @@ static cll::opt<EdgeType>
              cll::init(EdgeType::void_));
 static cll::opt<ConvertMode> convertMode(
     cll::desc("Conversion mode:"),
-    cll::values(clEnumVal(edgelist2gr, "Convert edge list to binary gr"),
+    cll::values(clEnumVal(edgelist2gr, "Convert edge list (optionally gzip or zstd "
+                                       "compressed) to binary gr"),
                 clEnumVal(gr2wgr,
                           "Convert unweighted binary gr to weighted binary gr "
                           "(in-place)"),
@@ -87,6 +88,12 @@ static cll::opt<bool>
     ignoreWeights("ignoreWeights",
                   cll::desc("Set this to ignore edgelist weights"),
                   cll::init(false));
+static cll::opt<unsigned long long>
+    edgeBatchSize("edgeBatchSize",
+                  cll::desc("Max edges each host sends per round when "
+                            "exchanging edges; bounds memory used by messages "
+                            "(0 sends all at once)"),
+                  cll::init(1ull << 26));
 
 struct Conversion {};
 
@@ -158,24 +165,34 @@ struct Edgelist2Gr : public Conversion {
     auto& net       = galois::runtime::getSystemNetworkInterface();
     uint64_t hostID = net.ID;
 
-    std::ifstream edgeListFile(inputFile.c_str());
-    uint64_t fileSize = getFileSize(edgeListFile);
-    if (hostID == 0) {
-      printf("File size is %lu\n", fileSize);
-    }
+    std::vector<uint32_t> localEdges;
+    if (isCompressedEdgeList(inputFile)) {
+      // gzip/zstd: hosts take turns parsing blocks of the inflated stream
+      if (hostID == 0) {
+        printf("Reading compressed edge list\n");
+      }
+      localEdges = loadEdgesFromCompressedEdgeList<EdgeTy>(
+          inputFile, totalNumNodes, startAtOne, ignoreWeights);
+    } else {
+      std::ifstream edgeListFile(inputFile.c_str());
+      uint64_t fileSize = getFileSize(edgeListFile);
+      if (hostID == 0) {
+        printf("File size is %lu\n", fileSize);
+      }
 
-    uint64_t localStartByte;
-    uint64_t localEndByte;
-    std::tie(localStartByte, localEndByte) =
-        determineByteRange(edgeListFile, fileSize);
-    // printf("[%lu] Byte start %lu byte end %lu, num bytes %lu\n", hostID,
-    //               localStartByte, localEndByte, localEndByte -
-    //               localStartByte);
-    // load edges into a vector
-    std::vector<uint32_t> localEdges = loadEdgesFromEdgeList<EdgeTy>(
-        edgeListFile, localStartByte, localEndByte, totalNumNodes, startAtOne,
-        ignoreWeights);
-    edgeListFile.close();
+      uint64_t localStartByte;
+      uint64_t localEndByte;
+      std::tie(localStartByte, localEndByte) =
+          determineByteRange(edgeListFile, fileSize);
+      // printf("[%lu] Byte start %lu byte end %lu, num bytes %lu\n", hostID,
+      //               localStartByte, localEndByte, localEndByte -
+      //               localStartByte);
+      // load edges into a vector
+      localEdges = loadEdgesFromEdgeList<EdgeTy>(
+          edgeListFile, localStartByte, localEndByte, totalNumNodes,
+          startAtOne, ignoreWeights);
+      edgeListFile.close();
+    }
 
     uint64_t totalEdgeCount = accumulateValue(getNumEdges<EdgeTy>(localEdges));
     if (hostID == 0) {
@@ -576,6 +593,7 @@ int main(int argc, char** argv) {
   galois::DistMemSys G;
   llvm::cl::ParseCommandLineOptions(argc, argv);
   galois::setActiveThreads(threadsToUse);
+  shuffleBatchSize = edgeBatchSize;
 
 // need to initialize MPI if using LWCI (else already initialized)
 #ifdef GALOIS_USE_LWCI
@@ -18,18 +18,27 @@
  */
 
 #include "galois/Galois.h"
+#include "galois/AtomicHelpers.h"
+#include "galois/Bag.h"
 #include "galois/LargeArray.h"
+#include "galois/ParallelSTL.h"
+#include "galois/Reduction.h"
 #include "galois/graphs/FileGraph.h"
+#include "galois/substrate/SimpleLock.h"
 
 #include "llvm/Support/CommandLine.h"
 
 #include <boost/mpl/if.hpp>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <deque>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <numeric>
 #include <stdint.h>
+#include <tuple>
 #include <vector>
 #include <random>
 
@@ -52,6 +61,7 @@ enum ConvertMode {
   gr2adjacencylist,
   gr2edgelist,
   gr2edgelist1ind,
+  gr2gordergr,
   gr2linegr,
   gr2lowdegreegr,
   gr2mtx,
@@ -59,8 +69,10 @@ enum ConvertMode {
   gr2partsrcgr,
   gr2pbbs,
   gr2pbbsedges,
+  gr2rabbitgr,
   gr2randgr,
   gr2randomweightgr,
+  gr2rcmgr,
   gr2ringgr,
   gr2rmat,
   gr2metis,
@@ -139,6 +151,7 @@ static cll::opt<ConvertMode> convertMode(
         clEnumVal(gr2adjacencylist, "Convert binary gr to adjacency list"),
         clEnumVal(gr2edgelist, "Convert binary gr to edgelist"),
         clEnumVal(gr2edgelist1ind, "Convert binary gr to edgelist, 1-indexed"),
+        clEnumVal(gr2gordergr, "Sort nodes by Gorder"),
         clEnumVal(gr2linegr, "Overlay line graph"),
         clEnumVal(gr2lowdegreegr, "Remove high degree nodes from binary gr"),
         clEnumVal(gr2mtx, "Convert binary gr to matrix market format"),
@@ -148,8 +161,11 @@ static cll::opt<ConvertMode> convertMode(
                   "Partition binary gr in N pieces by source nodes"),
         clEnumVal(gr2pbbs, "Convert binary gr to pbbs graph"),
         clEnumVal(gr2pbbsedges, "Convert binary gr to pbbs edge list"),
+        clEnumVal(gr2rabbitgr, "Sort nodes by Rabbit Order (symmetric gr)"),
         clEnumVal(gr2randgr, "Randomly permute nodes of binary gr"),
         clEnumVal(gr2randomweightgr, "Add or Randomize edge weights"),
+        clEnumVal(gr2rcmgr,
+                  "Sort nodes by reverse Cuthill-McKee (symmetric gr)"),
         clEnumVal(gr2ringgr, "Convert binary gr to strongly connected graph by "
                              "adding ring overlay"),
         clEnumVal(gr2rmat, "Convert binary gr to RMAT graph"),
@@ -196,6 +212,15 @@ static cll::opt<int>
              cll::init(1));
 static cll::opt<int> maxDegree("maxDegree", cll::desc("maximum degree to keep"),
                                cll::init(2 * 1024));
+static cll::opt<unsigned> gorderWindow("gorderWindow",
+                                       cll::desc("window size for Gorder"),
+                                       cll::init(5));
+static cll::opt<unsigned> gorderPartSize(
+    "gorderPartSize",
+    cll::desc("number of nodes in each part Gorder orders independently"),
+    cll::init(1 << 20));
+static cll::opt<int> numThreads("t", cll::desc("Number of threads"),
+                                cll::init(1));
 
 struct Conversion {};
 struct HasOnlyVoidSpecialization {};
@@ -1000,6 +1025,557 @@ struct SortByBFS : public Conversion {
   }
 };
 
+//! Converts an order (new id -> old id) into a permutation (old id -> new id)
+template <typename Permutation>
+static void orderToPermutation(const Permutation& order, Permutation& perm) {
+  perm.create(order.size());
+  galois::do_all(galois::iterate(size_t{0}, order.size()),
+                 [&](size_t i) { perm[order[i]] = i; }, galois::no_stats());
+}
+
+/**
+ * Reverse Cuthill-McKee. BFS levels are expanded in parallel; each new level
+ * is then sorted by (position of its earliest parent, degree, id), which
+ * gives the same order as serial Cuthill-McKee. Each connected component
+ * starts from a pseudo-peripheral node found by repeated BFS (George-Liu).
+ * Expects a symmetric graph.
+ */
+struct SortByRCM : public Conversion {
+  typedef galois::graphs::FileGraph Graph;
+  typedef Graph::GraphNode GNode;
+
+  Graph graph;
+  galois::LargeArray<uint64_t> degree;
+  galois::LargeArray<std::atomic<uint32_t>> mark;
+
+  //! Marks the nodes reachable from root with stamp, level by level, and
+  //! returns the number of levels after the first; last gets the final level
+  size_t eccentricity(GNode root, uint32_t stamp, std::vector<GNode>& last) {
+    std::vector<GNode> cur{root};
+    mark[root] = stamp;
+    for (size_t levels = 0;; ++levels) {
+      galois::InsertBag<GNode> next;
+      galois::do_all(galois::iterate(cur),
+                     [&](GNode src) {
+                       for (auto jj : graph.edges(src)) {
+                         GNode dst    = graph.getEdgeDst(jj);
+                         uint32_t old = mark[dst].load(std::memory_order_relaxed);
+                         if (old != stamp &&
+                             mark[dst].compare_exchange_strong(old, stamp)) {
+                           next.push(dst);
+                         }
+                       }
+                     },
+                     galois::steal(), galois::no_stats());
+      if (next.empty()) {
+        last.swap(cur);
+        return levels;
+      }
+      cur.assign(next.begin(), next.end());
+    }
+  }
+
+  GNode pseudoPeripheral(GNode start, uint32_t& stamp) {
+    std::vector<GNode> last;
+    GNode root = start;
+    size_t ecc = eccentricity(root, ++stamp, last);
+    // a few rounds are enough in practice
+    for (int round = 0; round < 8; ++round) {
+      GNode candidate = *std::min_element(
+          last.begin(), last.end(), [&](GNode a, GNode b) {
+            return std::make_pair(degree[a], a) < std::make_pair(degree[b], b);
+          });
+      std::vector<GNode> candidateLast;
+      size_t e = eccentricity(candidate, ++stamp, candidateLast);
+      if (e <= ecc)
+        break;
+      root = candidate;
+      ecc  = e;
+      last.swap(candidateLast);
+    }
+    return root;
+  }
+
+  template <typename EdgeTy>
+  void convert(const std::string& infilename, const std::string& outfilename) {
+    typedef galois::LargeArray<GNode> Permutation;
+    const uint32_t unvisited = std::numeric_limits<uint32_t>::max();
+
+    graph.fromFile(infilename);
+    size_t numNodes = graph.size();
+
+    galois::LargeArray<std::atomic<uint32_t>> level;
+    galois::LargeArray<std::atomic<uint64_t>> parentPos;
+    Permutation byDegree;
+    degree.create(numNodes);
+    mark.create(numNodes);
+    level.create(numNodes);
+    parentPos.create(numNodes);
+    byDegree.create(numNodes);
+    galois::do_all(galois::iterate(size_t{0}, numNodes),
+                   [&](GNode n) {
+                     degree[n]    = std::distance(graph.edge_begin(n),
+                                               graph.edge_end(n));
+                     mark[n]      = 0;
+                     level[n]     = unvisited;
+                     parentPos[n] = std::numeric_limits<uint64_t>::max();
+                     byDegree[n]  = n;
+                   },
+                   galois::no_stats());
+
+    auto lessDegree = [&](GNode a, GNode b) {
+      return std::make_pair(degree[a], a) < std::make_pair(degree[b], b);
+    };
+    galois::ParallelSTL::sort(byDegree.begin(), byDegree.end(), lessDegree);
+
+    // Cuthill-McKee order: order[i] is the i-th node placed
+    Permutation order;
+    order.create(numNodes);
+    size_t placed     = 0;
+    uint32_t curLevel = 0;
+    uint32_t stamp    = 0;
+
+    for (GNode start : byDegree) {
+      if (level[start] != unvisited)
+        continue;
+      GNode root      = degree[start] ? pseudoPeripheral(start, stamp) : start;
+      level[root]     = curLevel;
+      order[placed++] = root;
+
+      size_t begin = placed - 1;
+      size_t end   = placed;
+      while (begin != end) {
+        galois::InsertBag<GNode> next;
+        galois::do_all(
+            galois::iterate(begin, end),
+            [&](size_t pos) {
+              for (auto jj : graph.edges(order[pos])) {
+                GNode dst = graph.getEdgeDst(jj);
+                uint32_t l = level[dst].load(std::memory_order_relaxed);
+                if (l == unvisited &&
+                    level[dst].compare_exchange_strong(l, curLevel + 1)) {
+                  next.push(dst);
+                  l = curLevel + 1;
+                }
+                if (l == curLevel + 1)
+                  galois::atomicMin(parentPos[dst], uint64_t(pos));
+              }
+            },
+            galois::steal(), galois::no_stats());
+
+        size_t nextEnd = end;
+        for (GNode n : next)
+          order[nextEnd++] = n;
+        galois::ParallelSTL::sort(
+            &order[end], &order[nextEnd], [&](GNode a, GNode b) {
+              return std::make_tuple(parentPos[a].load(), degree[a], a) <
+                     std::make_tuple(parentPos[b].load(), degree[b], b);
+            });
+
+        begin = end;
+        end   = nextEnd;
+        ++curLevel;
+      }
+      placed = end;
+    }
+    assert(placed == numNodes);
+
+    // reverse
+    Permutation perm;
+    perm.create(numNodes);
+    galois::do_all(galois::iterate(size_t{0}, numNodes),
+                   [&](size_t i) { perm[order[i]] = numNodes - 1 - i; },
+                   galois::no_stats());
+
+    Graph out;
+    galois::graphs::permute<EdgeTy>(graph, perm, out);
+    outputPermutation(perm);
+
+    out.toFile(outfilename);
+    printStatus(out.size(), out.sizeEdges());
+  }
+};
+
+/**
+ * Rabbit Order (Arai et al., IPDPS 2016). Nodes are visited in increasing
+ * degree order and each is merged into the neighboring community with the
+ * largest positive modularity gain, building a dendrogram of merges. A
+ * depth-first walk of the dendrogram then places every community, and the
+ * communities merged into it, in consecutive ids. Merges run in parallel:
+ * a node locks itself and only tries to lock its target, and nodes that
+ * lose a race are retried. The result depends on the interleaving of merges.
+ * Expects a symmetric graph.
+ */
+struct SortByRabbit : public Conversion {
+  typedef galois::graphs::FileGraph Graph;
+  typedef Graph::GraphNode GNode;
+  typedef std::vector<std::pair<GNode, uint64_t>> Adjacency;
+
+  struct Vertex {
+    galois::substrate::SimpleLock lock;
+    //! some ancestor in the dendrogram; the vertex itself while top-level
+    std::atomic<GNode> rep;
+    //! total edge weight of the community rooted here
+    std::atomic<uint64_t> strength;
+    GNode child;
+    GNode sibling;
+    Adjacency adj;
+  };
+
+  std::vector<Vertex> vertices;
+  double totalWeight;
+
+  GNode find(GNode v) {
+    GNode r;
+    while ((r = vertices[v].rep.load(std::memory_order_acquire)) != v) {
+      GNode rr = vertices[r].rep.load(std::memory_order_acquire);
+      // ancestors never change, so any of them is a valid shortcut
+      vertices[v].rep.store(rr, std::memory_order_release);
+      v = r;
+    }
+    return v;
+  }
+
+  //! Rewrites the adjacency of u to distinct top-level neighbors
+  void compact(GNode u) {
+    Adjacency& adj = vertices[u].adj;
+    for (auto& e : adj)
+      e.first = find(e.first);
+    std::sort(adj.begin(), adj.end());
+    size_t k = 0;
+    for (size_t i = 0; i < adj.size(); ++i) {
+      if (adj[i].first == u)
+        continue;
+      if (k && adj[k - 1].first == adj[i].first)
+        adj[k - 1].second += adj[i].second;
+      else
+        adj[k++] = adj[i];
+    }
+    adj.resize(k);
+  }
+
+  //! Returns false if u has to be retried because of a concurrent merge
+  bool tryMerge(GNode u) {
+    Vertex& U = vertices[u];
+    U.lock.lock();
+    compact(u);
+
+    double su       = U.strength.load(std::memory_order_relaxed);
+    double bestGain = 0;
+    GNode best      = u;
+    for (auto& e : U.adj) {
+      double sv   = vertices[e.first].strength.load(std::memory_order_relaxed);
+      double gain = e.second - su * sv / totalWeight;
+      if (gain > bestGain) {
+        bestGain = gain;
+        best     = e.first;
+      }
+    }
+    if (best == u) {
+      U.lock.unlock();
+      return true;
+    }
+
+    Vertex& B = vertices[best];
+    if (!B.lock.try_lock()) {
+      U.lock.unlock();
+      return false;
+    }
+    if (B.rep.load(std::memory_order_acquire) != best) {
+      B.lock.unlock();
+      U.lock.unlock();
+      return false;
+    }
+
+    B.adj.insert(B.adj.end(), U.adj.begin(), U.adj.end());
+    Adjacency().swap(U.adj);
+    B.strength.fetch_add(U.strength.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    U.sibling = B.child;
+    B.child   = u;
+    U.rep.store(best, std::memory_order_release);
+
+    B.lock.unlock();
+    U.lock.unlock();
+    return true;
+  }
+
+  template <typename EdgeTy>
+  void convert(const std::string& infilename, const std::string& outfilename) {
+    typedef galois::LargeArray<GNode> Permutation;
+    const GNode none = std::numeric_limits<GNode>::max();
+
+    Graph graph;
+    graph.fromFile(infilename);
+    size_t numNodes = graph.size();
+
+    std::vector<Vertex>(numNodes).swap(vertices);
+    galois::GAccumulator<uint64_t> weight;
+    galois::do_all(galois::iterate(size_t{0}, numNodes),
+                   [&](GNode n) {
+                     Vertex& v = vertices[n];
+                     v.rep     = n;
+                     v.child = v.sibling = none;
+                     for (auto jj : graph.edges(n)) {
+                       GNode dst = graph.getEdgeDst(jj);
+                       if (dst != n)
+                         v.adj.emplace_back(dst, 1);
+                     }
+                     v.strength = v.adj.size();
+                     weight += v.adj.size();
+                   },
+                   galois::steal(), galois::no_stats());
+    totalWeight = std::max<uint64_t>(weight.reduce(), 1);
+
+    Permutation byDegree;
+    byDegree.create(numNodes);
+    std::copy(graph.begin(), graph.end(), byDegree.begin());
+    galois::ParallelSTL::sort(byDegree.begin(), byDegree.end(),
+                              [&](GNode a, GNode b) {
+                                return std::make_pair(vertices[a].strength.load(), a) <
+                                       std::make_pair(vertices[b].strength.load(), b);
+                              });
+
+    galois::InsertBag<GNode> retries[2];
+    galois::do_all(galois::iterate(byDegree),
+                   [&](GNode u) {
+                     if (!tryMerge(u))
+                       retries[0].push(u);
+                   },
+                   galois::steal(), galois::loopname("RabbitMerge"));
+    // a few parallel retries, then serially where merges cannot fail
+    for (int round = 0; !retries[round & 1].empty(); ++round) {
+      auto& cur  = retries[round & 1];
+      auto& next = retries[(round + 1) & 1];
+      if (round < 4) {
+        galois::do_all(galois::iterate(cur),
+                       [&](GNode u) {
+                         if (!tryMerge(u))
+                           next.push(u);
+                       },
+                       galois::steal(), galois::no_stats());
+      } else {
+        for (GNode u : cur)
+          tryMerge(u);
+      }
+      cur.clear();
+    }
+
+    // top-level communities keep their relative id order
+    Permutation offset;
+    offset.create(numNodes + 1);
+    galois::do_all(galois::iterate(size_t{0}, numNodes),
+                   [&](GNode n) { offset[n + 1] = 0; }, galois::no_stats());
+    offset[0] = 0;
+    galois::do_all(galois::iterate(size_t{0}, numNodes),
+                   [&](GNode n) {
+                     GNode r = find(n);
+                     __sync_fetch_and_add(&offset[r + 1], 1);
+                   },
+                   galois::no_stats());
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+    Permutation order;
+    order.create(numNodes);
+    galois::do_all(galois::iterate(size_t{0}, numNodes),
+                   [&](GNode r) {
+                     if (vertices[r].rep != r)
+                       return;
+                     size_t pos = offset[r];
+                     std::vector<GNode> stack{r};
+                     while (!stack.empty()) {
+                       GNode v = stack.back();
+                       stack.pop_back();
+                       order[pos++] = v;
+                       for (GNode c = vertices[v].child; c != none;
+                            c       = vertices[c].sibling)
+                         stack.push_back(c);
+                     }
+                     assert(pos == offset[r + 1]);
+                   },
+                   galois::steal(), galois::no_stats());
+    std::vector<Vertex>().swap(vertices);
+
+    Permutation perm;
+    orderToPermutation(order, perm);
+
+    Graph out;
+    galois::graphs::permute<EdgeTy>(graph, perm, out);
+    outputPermutation(perm);
+
+    out.toFile(outfilename);
+    printStatus(out.size(), out.sizeEdges());
+  }
+};
+
+/**
+ * Gorder (Wei et al., SIGMOD 2016). Greedily places next the node that
+ * shares the most in-neighbors with, or is adjacent to, the last
+ * gorderWindow placed nodes. Scores live in a bucketed priority queue with
+ * unit updates. In-neighbors come from the graph given by -graphTranspose,
+ * or the graph itself if none is given. Nodes are split into contiguous
+ * parts of gorderPartSize ids that are ordered independently in parallel,
+ * ignoring edges between parts; a single part gives the serial algorithm.
+ */
+struct SortByGorder : public Conversion {
+  typedef galois::graphs::FileGraph Graph;
+  typedef Graph::GraphNode GNode;
+
+  //! Max priority queue over [0, size) with keys changed by small deltas
+  class UnitHeap {
+    const uint32_t NIL = std::numeric_limits<uint32_t>::max();
+    std::vector<int64_t> key;
+    std::vector<uint32_t> prev;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> head;
+    std::vector<bool> present;
+    int64_t top;
+
+    void unlink(uint32_t v) {
+      if (prev[v] != NIL)
+        next[prev[v]] = next[v];
+      else
+        head[key[v]] = next[v];
+      if (next[v] != NIL)
+        prev[next[v]] = prev[v];
+    }
+
+    void link(uint32_t v) {
+      if (size_t(key[v]) >= head.size())
+        head.resize(key[v] + 1, NIL);
+      prev[v] = NIL;
+      next[v] = head[key[v]];
+      if (next[v] != NIL)
+        prev[next[v]] = v;
+      head[key[v]] = v;
+      top          = std::max(top, key[v]);
+    }
+
+  public:
+    explicit UnitHeap(uint32_t size)
+        : key(size, 0), prev(size), next(size), head(1, NIL),
+          present(size, true), top(0) {
+      for (uint32_t v = size; v > 0; --v)
+        link(v - 1);
+    }
+
+    bool contains(uint32_t v) const { return present[v]; }
+
+    void add(uint32_t v, int64_t delta) {
+      unlink(v);
+      key[v] += delta;
+      assert(key[v] >= 0);
+      link(v);
+    }
+
+    void remove(uint32_t v) {
+      unlink(v);
+      present[v] = false;
+    }
+
+    uint32_t popMax() {
+      while (head[top] == NIL)
+        --top;
+      uint32_t v = head[top];
+      remove(v);
+      return v;
+    }
+  };
+
+  Graph graph;
+  Graph transpose;
+  Graph* inGraph;
+  size_t hubDegree;
+
+  void orderPart(GNode begin, GNode end, GNode* out) {
+    const uint32_t size = end - begin;
+    if (!size)
+      return;
+    UnitHeap heap(size);
+    auto inPart = [&](GNode n) { return begin <= n && n < end; };
+
+    auto update = [&](GNode v, int64_t delta) {
+      for (auto jj : graph.edges(v)) {
+        GNode x = graph.getEdgeDst(jj);
+        if (inPart(x) && heap.contains(x - begin))
+          heap.add(x - begin, delta);
+      }
+      for (auto jj : inGraph->edges(v)) {
+        GNode u = inGraph->getEdgeDst(jj);
+        if (!inPart(u))
+          continue;
+        if (heap.contains(u - begin))
+          heap.add(u - begin, delta);
+        // siblings through u; skip hubs as they relate everything
+        if (size_t(std::distance(graph.edge_begin(u), graph.edge_end(u))) >
+            hubDegree)
+          continue;
+        for (auto kk : graph.edges(u)) {
+          GNode x = graph.getEdgeDst(kk);
+          if (x != v && inPart(x) && heap.contains(x - begin))
+            heap.add(x - begin, delta);
+        }
+      }
+    };
+
+    GNode start = begin;
+    size_t maxIn = 0;
+    for (GNode n = begin; n < end; ++n) {
+      size_t in = std::distance(inGraph->edge_begin(n), inGraph->edge_end(n));
+      if (in > maxIn) {
+        maxIn = in;
+        start = n;
+      }
+    }
+    heap.remove(start - begin);
+    out[0] = start;
+
+    for (uint32_t i = 1; i < size; ++i) {
+      update(out[i - 1], 1);
+      if (i > gorderWindow)
+        update(out[i - 1 - gorderWindow], -1);
+      out[i] = begin + heap.popMax();
+    }
+  }
+
+  template <typename EdgeTy>
+  void convert(const std::string& infilename, const std::string& outfilename) {
+    typedef galois::LargeArray<GNode> Permutation;
+
+    graph.fromFile(infilename);
+    inGraph = &graph;
+    if (!transposeFilename.empty()) {
+      transpose.fromFile(transposeFilename);
+      inGraph = &transpose;
+    }
+    size_t numNodes = graph.size();
+    hubDegree       = std::sqrt(double(numNodes));
+
+    Permutation order;
+    order.create(numNodes);
+    size_t partSize = std::max<size_t>(gorderPartSize, 1);
+    size_t numParts = (numNodes + partSize - 1) / partSize;
+    galois::do_all(galois::iterate(size_t{0}, numParts),
+                   [&](size_t p) {
+                     GNode begin = p * partSize;
+                     GNode end   = std::min(numNodes, (p + 1) * partSize);
+                     orderPart(begin, end, &order[begin]);
+                   },
+                   galois::steal(), galois::chunk_size<1>(),
+                   galois::loopname("Gorder"));
+
+    Permutation perm;
+    orderToPermutation(order, perm);
+
+    Graph out;
+    galois::graphs::permute<EdgeTy>(graph, perm, out);
+    outputPermutation(perm);
+
+    out.toFile(outfilename);
+    printStatus(out.size(), out.sizeEdges());
+  }
+};
+
 template <typename T, bool IsInteger = std::numeric_limits<T>::is_integer>
 struct UniformDistribution {};
 
@@ -2764,6 +3340,7 @@ struct Svmlight2Gr : public HasNoVoidSpecialization {
 int main(int argc, char** argv) {
   galois::SharedMemSys G;
   llvm::cl::ParseCommandLineOptions(argc, argv);
+  galois::setActiveThreads(numThreads);
   std::ios_base::sync_with_stdio(false);
   switch (convertMode) {
   case bipartitegr2bigpetsc:
@@ -2808,6 +3385,9 @@ int main(int argc, char** argv) {
   case gr2edgelist1ind:
     convert<Gr2Edgelist1Ind>();
     break;
+  case gr2gordergr:
+    convert<SortByGorder>();
+    break;
   case gr2linegr:
     convert<AddRing<true>>();
     break;
@@ -2829,12 +3409,18 @@ int main(int argc, char** argv) {
   case gr2pbbsedges:
     convert<Gr2Pbbsedges>();
     break;
+  case gr2rabbitgr:
+    convert<SortByRabbit>();
+    break;
   case gr2randgr:
     convert<RandomizeNodes>();
     break;
   case gr2randomweightgr:
     convert<RandomizeEdgeWeights>();
     break;
+  case gr2rcmgr:
+    convert<SortByRCM>();
+    break;
   case gr2ringgr:
     convert<AddRing<false>>();
     break;
@@ -18,10 +18,20 @@
  */
 
 #include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/Reduction.h"
 #include "galois/graphs/FileGraph.h"
-#include "galois/graphs/BufferedGraph.h"
 #include "llvm/Support/CommandLine.h"
 
+#include <cctype>
+#include <numeric>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace cll = llvm::cl;
 
 static cll::opt<std::string>
@@ -31,89 +41,199 @@ static cll::opt<std::string> mappingFilename(cll::Positional,
                                              cll::Required);
 static cll::opt<std::string>
     outputFilename(cll::Positional, cll::desc("<output file>"), cll::Required);
+static cll::opt<bool>
+    binaryMapping("binaryMapping",
+                  cll::desc("Mapping file is an array of 32 bit node ids, "
+                            "e.g. from dist-graph-convert -nodemap2binary"),
+                  cll::init(false));
+static cll::opt<unsigned> numThreads("t", cll::desc("Number of threads"),
+                                     cll::init(1));
 
 using Writer = galois::graphs::FileGraphWriter;
+using GNode  = galois::graphs::FileGraph::GraphNode;
+
+static const uint32_t UNMAPPED = std::numeric_limits<uint32_t>::max();
 
 /**
- * Create node map from file
+ * Read-only mapping of a whole file
  */
-std::map<uint32_t, uint32_t> createNodeMap() {
-  galois::gInfo("Creating node map");
-  // read new mapping
-  std::ifstream mapFile;
-  mapFile.open(mappingFilename);
-  int64_t endOfFile = mapFile.seekg(0, std::ios_base::end).tellg();
-  mapFile.seekg(0, std::ios_base::beg);
-
-  // remap node listed on line n in the mapping to node n
-  std::map<uint32_t, uint32_t> remapper;
-  uint64_t counter = 0;
-  while (((int64_t)mapFile.tellg() + 1) != endOfFile) {
-    uint64_t nodeID;
-    mapFile >> nodeID;
-    remapper[nodeID] = counter++;
+class MappedFile {
+  int fd;
+  size_t length;
+  char* base;
+
+public:
+  explicit MappedFile(const std::string& filename) : length(0), base(nullptr) {
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+      GALOIS_SYS_DIE("failed opening ", "'", filename, "'");
+    struct stat buf;
+    if (fstat(fd, &buf) == -1)
+      GALOIS_SYS_DIE("failed reading ", "'", filename, "'");
+    length = buf.st_size;
+    if (length) {
+      void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m == MAP_FAILED)
+        GALOIS_SYS_DIE("failed reading ", "'", filename, "'");
+      base = static_cast<char*>(m);
+      madvise(base, length, MADV_SEQUENTIAL);
+    }
   }
 
-  GALOIS_ASSERT(remapper.size() == counter);
-  galois::gInfo("Remapping ", counter, " nodes");
-  mapFile.close();
+  ~MappedFile() {
+    if (base)
+      munmap(base, length);
+    close(fd);
+  }
 
-  galois::gInfo("Node map created");
+  const char* data() const { return base; }
+  size_t size() const { return length; }
+};
 
-  return remapper;
+/**
+ * Calls fn(index, value) for each number in the whitespace separated text
+ * buf, with threads parsing disjoint byte ranges. A number belongs to the
+ * range it starts in. Returns how many numbers there are.
+ */
+template <typename Fn>
+static size_t parseNumbers(const char* buf, size_t size, Fn fn) {
+  unsigned numT = galois::getActiveThreads();
+  galois::LargeArray<size_t> counts;
+  counts.create(numT + 1);
+
+  auto forEachNumber = [&](unsigned tid, auto visit) {
+    size_t b, e;
+    std::tie(b, e) = galois::block_range(size_t{0}, size, tid, numT);
+    // skip the tail of a number that started in the previous range
+    if (b > 0 && isdigit(buf[b - 1])) {
+      while (b < size && isdigit(buf[b]))
+        ++b;
+    }
+    while (b < e) {
+      if (!isdigit(buf[b])) {
+        ++b;
+        continue;
+      }
+      uint64_t v = 0;
+      for (; b < size && isdigit(buf[b]); ++b)
+        v = v * 10 + (buf[b] - '0');
+      visit(v);
+    }
+  };
+
+  galois::on_each([&](unsigned tid, unsigned) {
+    size_t c = 0;
+    forEachNumber(tid, [&](uint64_t) { ++c; });
+    counts[tid + 1] = c;
+  });
+  counts[0] = 0;
+  std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+  galois::on_each([&](unsigned tid, unsigned) {
+    size_t index = counts[tid];
+    forEachNumber(tid, [&](uint64_t v) { fn(index++, v); });
+  });
+
+  return counts[numT];
+}
+
+/**
+ * Reads the mapping: the node listed n-th becomes node n. Returns the old
+ * ids in new id order.
+ */
+static void readNodeMap(galois::LargeArray<uint32_t>& oldIds) {
+  galois::gInfo("Reading node map");
+  MappedFile mapFile(mappingFilename);
+
+  if (binaryMapping) {
+    GALOIS_ASSERT(mapFile.size() % sizeof(uint32_t) == 0,
+                  "binary mapping size is not a multiple of 4 bytes");
+    size_t count = mapFile.size() / sizeof(uint32_t);
+    oldIds.create(count);
+    const uint32_t* ids = reinterpret_cast<const uint32_t*>(mapFile.data());
+    galois::do_all(galois::iterate(size_t{0}, count),
+                   [&](size_t i) { oldIds[i] = ids[i]; }, galois::no_stats());
+  } else {
+    size_t count =
+        parseNumbers(mapFile.data(), mapFile.size(), [](size_t, uint64_t) {});
+    oldIds.create(count);
+    parseNumbers(mapFile.data(), mapFile.size(),
+                 [&](size_t i, uint64_t v) {
+                   GALOIS_ASSERT(v < UNMAPPED, "node id ", v, " too large");
+                   oldIds[i] = v;
+                 });
+  }
+
+  galois::gInfo("Read ", oldIds.size(), " nodes");
 }
 
 int main(int argc, char** argv) {
   galois::SharedMemSys G;
   llvm::cl::ParseCommandLineOptions(argc, argv);
+  galois::setActiveThreads(numThreads);
 
-  std::map<uint32_t, uint32_t> remapper = createNodeMap();
+  galois::LargeArray<uint32_t> oldIds;
+  readNodeMap(oldIds);
+  size_t numNewNodes = oldIds.size();
 
   galois::gInfo("Loading graph to remap");
-  galois::graphs::BufferedGraph<void> graphToRemap;
-  graphToRemap.loadGraph(inputFilename);
+  galois::graphs::FileGraph graphToRemap;
+  graphToRemap.fromFile(inputFilename);
+  size_t prevNumNodes = graphToRemap.size();
   galois::gInfo("Graph loaded");
 
+  // dense inverse of the mapping over the old id space
+  galois::LargeArray<uint32_t> newIds;
+  newIds.create(prevNumNodes);
+  galois::do_all(galois::iterate(size_t{0}, prevNumNodes),
+                 [&](size_t i) { newIds[i] = UNMAPPED; }, galois::no_stats());
+  galois::do_all(galois::iterate(size_t{0}, numNewNodes),
+                 [&](size_t i) {
+                   GALOIS_ASSERT(oldIds[i] < prevNumNodes, "node ", oldIds[i],
+                                 " is not in the graph");
+                   newIds[oldIds[i]] = i;
+                 },
+                 galois::no_stats());
+  // catches ids listed more than once
+  galois::do_all(galois::iterate(size_t{0}, numNewNodes),
+                 [&](size_t i) {
+                   GALOIS_ASSERT(newIds[oldIds[i]] == i, "node ", oldIds[i],
+                                 " is mapped more than once");
+                 },
+                 galois::no_stats());
+
   Writer graphWriter;
-  graphWriter.setNumNodes(remapper.size());
-  graphWriter.setNumEdges(graphToRemap.sizeEdges());
+  graphWriter.setNumNodes(numNewNodes);
 
-  // phase 1: count degrees
+  // phase 1: count degrees; each new node has a single source
   graphWriter.phase1();
   galois::gInfo("Starting degree counting");
-  size_t prevNumNodes  = graphToRemap.size();
-  size_t nodeIDCounter = 0;
-  for (size_t i = 0; i < prevNumNodes; i++) {
-    // see if current node is to be remapped, i.e. exists in the map
-    if (remapper.find(i) != remapper.end()) {
-      GALOIS_ASSERT(nodeIDCounter == remapper[i]);
-      for (auto e = graphToRemap.edgeBegin(i); e < graphToRemap.edgeEnd(i);
-           e++) {
-        graphWriter.incrementDegree(nodeIDCounter);
-      }
-      nodeIDCounter++;
-    }
-  }
-  GALOIS_ASSERT(nodeIDCounter == remapper.size());
+  galois::GAccumulator<size_t> numEdges;
+  galois::do_all(galois::iterate(size_t{0}, numNewNodes),
+                 [&](size_t i) {
+                   GNode src = oldIds[i];
+                   size_t degree =
+                       std::distance(graphToRemap.edge_begin(src),
+                                     graphToRemap.edge_end(src));
+                   graphWriter.incrementDegree(i, degree);
+                   numEdges += degree;
+                 },
+                 galois::steal(), galois::loopname("DegreeCounting"));
+  graphWriter.setNumEdges(numEdges.reduce());
 
   // phase 2: edge construction
   graphWriter.phase2();
   galois::gInfo("Starting edge construction");
-  nodeIDCounter = 0;
-  for (size_t i = 0; i < prevNumNodes; i++) {
-    // see if current node is to be remapped, i.e. exists in the map
-    if (remapper.find(i) != remapper.end()) {
-      GALOIS_ASSERT(nodeIDCounter == remapper[i]);
-      for (auto e = graphToRemap.edgeBegin(i); e < graphToRemap.edgeEnd(i);
-           e++) {
-        uint32_t dst = graphToRemap.edgeDestination(*e);
-        GALOIS_ASSERT(remapper.find(dst) != remapper.end());
-        graphWriter.addNeighbor(nodeIDCounter, remapper[dst]);
-      }
-      nodeIDCounter++;
-    }
-  }
-  GALOIS_ASSERT(nodeIDCounter == remapper.size());
+  galois::do_all(galois::iterate(size_t{0}, numNewNodes),
+                 [&](size_t i) {
+                   for (auto e : graphToRemap.edges(oldIds[i])) {
+                     uint32_t dst = newIds[graphToRemap.getEdgeDst(e)];
+                     GALOIS_ASSERT(dst != UNMAPPED, "edge to unmapped node ",
+                                   graphToRemap.getEdgeDst(e));
+                     graphWriter.addNeighbor(i, dst);
+                   }
+                 },
+                 galois::steal(), galois::loopname("EdgeConstruction"));
 
   galois::gInfo("Finishing up: outputting graph shortly");
 
@@ -18,13 +18,23 @@
  */
 
 #include "galois/Galois.h"
+#include "galois/Bag.h"
+#include "galois/LargeArray.h"
+#include "galois/Reduction.h"
+#include "galois/graphs/FileGraph.h"
 #include "galois/graphs/LCGraph.h"
-#include "galois/graphs/OfflineGraph.h"
+#include "galois/substrate/PerThreadStorage.h"
 
 #include "llvm/Support/CommandLine.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <numeric>
 #include <vector>
 
 namespace cll = llvm::cl;
@@ -37,7 +47,11 @@ enum StatMode {
   indegreehist,
   sortedlogoffsethist,
   sparsityPattern,
-  summary
+  summary,
+  diameter,
+  clustering,
+  components,
+  powerlaw
 };
 
 static cll::opt<std::string>
@@ -53,14 +67,101 @@ static cll::list<StatMode> statModeList(
                           "Histogram of neighbor offsets with sorted edges"),
                 clEnumVal(sparsityPattern, "Pattern of non-zeros when graph is "
                                            "interpreted as a sparse matrix"),
-                clEnumVal(summary, "Graph summary"), clEnumValEnd));
+                clEnumVal(summary, "Graph summary"),
+                clEnumVal(diameter, "Approximate effective diameter from BFS "
+                                    "of sampled sources (JSON)"),
+                clEnumVal(clustering,
+                          "Approximate global clustering coefficient from "
+                          "sampled wedges; expects a symmetric graph (JSON)"),
+                clEnumVal(components, "Sizes of (weakly) connected "
+                                      "components (JSON)"),
+                clEnumVal(powerlaw, "Power-law fit of out and in degree "
+                                    "distributions (JSON)"),
+                clEnumValEnd));
 static cll::opt<int> numBins("numBins", cll::desc("Number of bins"),
                              cll::init(-1));
 static cll::opt<int> columns("columns", cll::desc("Columns for sparsity"),
                              cll::init(80));
+static cll::opt<unsigned> numThreads("t", cll::desc("Number of threads"),
+                                     cll::init(1));
+static cll::opt<unsigned>
+    numSources("sources", cll::desc("Number of BFS sources for diameter"),
+               cll::init(64));
+static cll::opt<double>
+    diameterPercentile("percentile",
+                       cll::desc("Fraction of reachable pairs the effective "
+                                 "diameter covers"),
+                       cll::init(0.9));
+static cll::opt<uint64_t>
+    numWedges("wedges", cll::desc("Number of wedges sampled for clustering"),
+              cll::init(1000000));
+static cll::opt<uint64_t>
+    powerLawXmin("xmin",
+                 cll::desc("Smallest degree in the power-law tail (0 picks "
+                           "the one with the best Kolmogorov-Smirnov fit)"),
+                 cll::init(0));
+static cll::opt<uint64_t> seed("seed", cll::desc("Seed for sampling"),
+                               cll::init(0));
+static cll::opt<std::string>
+    statFile("statFile",
+             cll::desc("Optional file to write loop statistics to (they are "
+                       "discarded otherwise to keep stdout parseable)"),
+             cll::init(""));
 
-typedef galois::graphs::OfflineGraph Graph;
+typedef galois::graphs::FileGraph Graph;
 typedef Graph::GraphNode GNode;
+typedef std::map<uint64_t, uint64_t> Histogram;
+
+static uint64_t degree(Graph& graph, GNode n) {
+  return std::distance(graph.edge_begin(n), graph.edge_end(n));
+}
+
+/**
+ * Histogram of f(n) over all nodes, built in per-thread maps that are merged
+ * at the end.
+ */
+template <typename Fn>
+static Histogram nodeHistogram(Graph& graph, Fn f) {
+  galois::substrate::PerThreadStorage<Histogram> hists;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) { ++(*hists.getLocal())[f(n)]; },
+                 galois::steal(), galois::loopname("NodeHistogram"));
+
+  Histogram hist;
+  for (unsigned i = 0; i < hists.size(); ++i) {
+    for (auto& p : *hists.getRemote(i)) {
+      hist[p.first] += p.second;
+    }
+  }
+  return hist;
+}
+
+/**
+ * Counts incoming edges of every node.
+ */
+static void computeInDegrees(Graph& graph,
+                             galois::LargeArray<std::atomic<uint64_t>>& inv) {
+  inv.allocateInterleaved(graph.size());
+  galois::do_all(galois::iterate(graph), [&](GNode n) { inv[n] = 0; },
+                 galois::no_stats());
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   for (auto jj : graph.edges(n)) {
+                     inv[graph.getEdgeDst(jj)].fetch_add(
+                         1, std::memory_order_relaxed);
+                   }
+                 },
+                 galois::steal(), galois::loopname("InDegrees"));
+}
+
+//! Mixes the bits of x; used to derive independent random numbers from a
+//! seed and a sample index regardless of the thread running the sample
+static uint64_t splitMix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
 
 void doSummary(Graph& graph) {
   std::cout << "NumNodes: " << graph.size() << "\n";
@@ -69,23 +170,32 @@ void doSummary(Graph& graph) {
 }
 
 void doDegrees(Graph& graph) {
-  for (auto n : graph) {
-    std::cout << std::distance(graph.edge_begin(n), graph.edge_end(n)) << "\n";
+  std::vector<uint64_t> degrees(graph.size());
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) { degrees[n] = degree(graph, n); },
+                 galois::loopname("Degrees"));
+  for (uint64_t d : degrees) {
+    std::cout << d << "\n";
   }
 }
 
 void findMaxDegreeNode(Graph& graph) {
-  uint64_t nodeId        = 0;
-  size_t MaxDegree       = 0;
-  uint64_t MaxDegreeNode = 0;
-  for (auto n : graph) {
-    size_t degree = std::distance(graph.edge_begin(n), graph.edge_end(n));
-    if (MaxDegree < degree) {
-      MaxDegree     = degree;
-      MaxDegreeNode = nodeId;
-    }
-    ++nodeId;
-  }
+  galois::GReduceMax<uint64_t> maxDegree;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) { maxDegree.update(degree(graph, n)); },
+                 galois::loopname("MaxDegree"));
+  uint64_t MaxDegree = maxDegree.reduce();
+
+  // ties go to the smallest node like they would in a serial scan
+  galois::GReduceMin<uint64_t> maxDegreeNode;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   if (degree(graph, n) == MaxDegree) {
+                     maxDegreeNode.update(n);
+                   }
+                 },
+                 galois::loopname("MaxDegreeNode"));
+  uint64_t MaxDegreeNode = graph.size() ? maxDegreeNode.reduce() : 0;
   std::cout << "MaxDegreeNode : " << MaxDegreeNode
             << " , MaxDegree : " << MaxDegree << "\n";
 }
@@ -125,39 +235,37 @@ void doSparsityPattern(Graph& graph,
                        std::function<void(unsigned, unsigned, bool)> printFn) {
   unsigned blockSize = (graph.size() + columns - 1) / columns;
 
+  // rows are independent; a vector<char> per row so threads do not share words
+  std::vector<std::vector<char>> rows(columns, std::vector<char>(columns));
+  galois::do_all(
+      galois::iterate(0, (int)columns),
+      [&](int i) {
+        auto& row = rows[i];
+        auto p    = galois::block_range(graph.begin(), graph.end(), i, columns);
+        for (auto ii = p.first, ei = p.second; ii != ei; ++ii) {
+          for (auto jj : graph.edges(*ii)) {
+            row[graph.getEdgeDst(jj) / blockSize] = true;
+          }
+        }
+      },
+      galois::steal(), galois::loopname("SparsityPattern"));
+
   for (int i = 0; i < columns; ++i) {
-    std::vector<bool> row(columns);
-    auto p = galois::block_range(graph.begin(), graph.end(), i, columns);
-    for (auto ii = p.first, ei = p.second; ii != ei; ++ii) {
-      for (auto jj : graph.edges(*ii)) {
-        row[graph.getEdgeDst(jj) / blockSize] = true;
-      }
-    }
     for (int x = 0; x < columns; ++x) {
-      printFn(x, i, row[x]);
+      printFn(x, i, rows[i][x]);
     }
   }
 }
 
 void doDegreeHistogram(Graph& graph) {
-  std::map<uint64_t, uint64_t> hist;
-  for (auto ii : graph) {
-    ++hist[std::distance(graph.edge_begin(ii), graph.edge_end(ii))];
-  }
+  Histogram hist = nodeHistogram(graph, [&](GNode n) { return degree(graph, n); });
   printHistogram("Degree", hist);
 }
 
 void doInDegreeHistogram(Graph& graph) {
-  std::vector<uint64_t> inv(graph.size());
-  std::map<uint64_t, uint64_t> hist;
-  for (auto ii : graph) {
-    for (auto jj : graph.edges(ii)) {
-      ++inv[graph.getEdgeDst(jj)];
-    }
-  }
-  for (uint64_t n : inv) {
-    ++hist[n];
-  }
+  galois::LargeArray<std::atomic<uint64_t>> inv;
+  computeInDegrees(graph, inv);
+  Histogram hist = nodeHistogram(graph, [&](GNode n) { return inv[n].load(); });
   printHistogram("InDegree", hist);
 }
 
@@ -230,19 +338,373 @@ void doSortedLogOffsetHistogram(Graph& graph) {
 }
 
 void doDestinationHistogram(Graph& graph) {
-  std::map<uint64_t, uint64_t> hist;
-  for (auto ii : graph) {
-    for (auto jj : graph.edges(ii)) {
-      ++hist[graph.getEdgeDst(jj)];
+  galois::LargeArray<std::atomic<uint64_t>> inv;
+  computeInDegrees(graph, inv);
+  // only destinations that appear
+  Histogram hist;
+  for (GNode n : graph) {
+    if (inv[n]) {
+      hist[n] = inv[n];
     }
   }
   printHistogram("DestinationBin", hist);
 }
 
+//! Prints a histogram as a JSON array of [value, count] pairs
+static void printJsonHistogram(const Histogram& hist) {
+  std::cout << '[';
+  bool first = true;
+  for (auto& p : hist) {
+    std::cout << (first ? "" : ",") << '[' << p.first << ',' << p.second
+              << ']';
+    first = false;
+  }
+  std::cout << ']';
+}
+
+/**
+ * Approximate effective diameter: the number of hops within which a given
+ * fraction of the reachable (source, destination) pairs lie, estimated with
+ * BFS (along out-edges) from sampled sources and interpolated between hop
+ * counts as in SNAP. The largest distance seen is a lower bound on the
+ * diameter.
+ */
+void doDiameter(Graph& graph) {
+  const uint32_t infinity = std::numeric_limits<uint32_t>::max();
+  uint64_t numNodes       = graph.size();
+
+  galois::LargeArray<std::atomic<uint32_t>> dist;
+  dist.allocateInterleaved(numNodes);
+  // hopCounts[d] = number of sampled pairs at distance d
+  std::vector<uint64_t> hopCounts;
+
+  unsigned sources = numNodes ? numSources : 0;
+  for (unsigned s = 0; s < sources; ++s) {
+    GNode source = splitMix64(seed + s) % numNodes;
+
+    galois::do_all(galois::iterate(graph), [&](GNode n) { dist[n] = infinity; },
+                   galois::no_stats());
+    dist[source] = 0;
+
+    galois::InsertBag<GNode> frontiers[2];
+    frontiers[0].push(source);
+    for (uint32_t level = 0; !frontiers[level % 2].empty(); ++level) {
+      auto& cur  = frontiers[level % 2];
+      auto& next = frontiers[(level + 1) % 2];
+      galois::GAccumulator<uint64_t> reached;
+
+      galois::do_all(galois::iterate(cur),
+                     [&](GNode n) {
+                       for (auto jj : graph.edges(n)) {
+                         GNode dst         = graph.getEdgeDst(jj);
+                         uint32_t expected = infinity;
+                         if (dist[dst].load(std::memory_order_relaxed) ==
+                                 infinity &&
+                             dist[dst].compare_exchange_strong(expected,
+                                                               level + 1)) {
+                           next.push(dst);
+                           reached += 1;
+                         }
+                       }
+                     },
+                     galois::steal(), galois::chunk_size<64>(),
+                     galois::no_stats(), galois::loopname("DiameterBFS"));
+      cur.clear();
+
+      if (reached.reduce()) {
+        if (hopCounts.size() < level + 2) {
+          hopCounts.resize(level + 2);
+        }
+        hopCounts[level + 1] += reached.reduce();
+      }
+    }
+  }
+
+  uint64_t reachablePairs = 0;
+  for (uint64_t c : hopCounts) {
+    reachablePairs += c;
+  }
+
+  // smallest d where the cumulative fraction reaches the percentile,
+  // interpolated linearly from d - 1
+  double effectiveDiameter = 0;
+  if (reachablePairs) {
+    double target       = diameterPercentile * reachablePairs;
+    uint64_t cumulative = 0;
+    for (size_t d = 1; d < hopCounts.size(); ++d) {
+      if (cumulative + hopCounts[d] >= target) {
+        effectiveDiameter =
+            (d - 1) + (target - cumulative) / (double)hopCounts[d];
+        break;
+      }
+      cumulative += hopCounts[d];
+    }
+  }
+
+  std::cout << "{\"stat\":\"diameter\",\"sources\":" << sources
+            << ",\"percentile\":" << diameterPercentile
+            << ",\"effectiveDiameter\":" << effectiveDiameter
+            << ",\"maxDistance\":"
+            << (hopCounts.empty() ? 0 : hopCounts.size() - 1)
+            << ",\"reachablePairs\":" << reachablePairs << "}\n";
+}
+
+/**
+ * Approximate global clustering coefficient (transitivity): the fraction of
+ * closed wedges among wedges sampled uniformly, i.e. centers are picked in
+ * proportion to the number of wedges they have and then 2 distinct neighbors
+ * of the center. The graph should be symmetric.
+ */
+void doClustering(Graph& graph) {
+  uint64_t numNodes = graph.size();
+
+  // prefix sum of wedges per node for sampling centers
+  std::vector<uint64_t> wedgePrefix(numNodes);
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   uint64_t d     = degree(graph, n);
+                   wedgePrefix[n] = d * (d - (d ? 1 : 0)) / 2;
+                 },
+                 galois::loopname("CountWedges"));
+  std::partial_sum(wedgePrefix.begin(), wedgePrefix.end(),
+                   wedgePrefix.begin());
+  uint64_t totalWedges = numNodes ? wedgePrefix.back() : 0;
+
+  uint64_t samples = totalWedges ? numWedges : 0;
+  galois::GAccumulator<uint64_t> closed;
+  galois::do_all(
+      galois::iterate((uint64_t)0, samples),
+      [&](uint64_t i) {
+        uint64_t r = splitMix64(seed ^ splitMix64(i));
+        GNode center =
+            std::upper_bound(wedgePrefix.begin(), wedgePrefix.end(),
+                             r % totalWedges) -
+            wedgePrefix.begin();
+
+        // 2 distinct neighbor positions
+        uint64_t d  = degree(graph, center);
+        uint64_t r2 = splitMix64(r);
+        uint64_t a  = r2 % d;
+        uint64_t b  = (a + 1 + (r2 >> 32) % (d - 1)) % d;
+        GNode u     = graph.getEdgeDst(*(graph.edge_begin(center) + a));
+        GNode w     = graph.getEdgeDst(*(graph.edge_begin(center) + b));
+        if (u == w || u == center || w == center) {
+          return;
+        }
+
+        // scan the shorter adjacency list
+        if (degree(graph, u) > degree(graph, w)) {
+          std::swap(u, w);
+        }
+        for (auto jj : graph.edges(u)) {
+          if (graph.getEdgeDst(jj) == w) {
+            closed += 1;
+            break;
+          }
+        }
+      },
+      galois::steal(), galois::loopname("SampleWedges"));
+
+  double coefficient = samples ? closed.reduce() / (double)samples : 0;
+  // normal approximation of the binomial proportion
+  double confidence =
+      samples ? 1.96 * std::sqrt(coefficient * (1 - coefficient) / samples)
+              : 0;
+
+  std::cout << "{\"stat\":\"clustering\",\"totalWedges\":" << totalWedges
+            << ",\"sampledWedges\":" << samples
+            << ",\"closedWedges\":" << closed.reduce()
+            << ",\"globalClusteringCoefficient\":" << coefficient
+            << ",\"confidence95\":" << confidence << "}\n";
+}
+
+//! Root of n's tree with path halving
+static GNode findRoot(galois::LargeArray<std::atomic<GNode>>& parent,
+                      GNode n) {
+  while (true) {
+    GNode p = parent[n].load(std::memory_order_relaxed);
+    if (p == n) {
+      return n;
+    }
+    GNode gp = parent[p].load(std::memory_order_relaxed);
+    if (p != gp) {
+      parent[n].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+    }
+    n = gp;
+  }
+}
+
+/**
+ * Sizes of the connected components of the graph with edge directions
+ * ignored, from a concurrent union-find (larger roots are linked under
+ * smaller ones).
+ */
+void doComponents(Graph& graph) {
+  galois::LargeArray<std::atomic<GNode>> parent;
+  parent.allocateInterleaved(graph.size());
+  galois::do_all(galois::iterate(graph), [&](GNode n) { parent[n] = n; },
+                 galois::no_stats());
+
+  galois::do_all(
+      galois::iterate(graph),
+      [&](GNode src) {
+        for (auto jj : graph.edges(src)) {
+          GNode a = src;
+          GNode b = graph.getEdgeDst(jj);
+          while (true) {
+            a = findRoot(parent, a);
+            b = findRoot(parent, b);
+            if (a == b) {
+              break;
+            }
+            if (a < b) {
+              std::swap(a, b);
+            }
+            GNode expected = a;
+            if (parent[a].compare_exchange_strong(expected, b)) {
+              break;
+            }
+          }
+        }
+      },
+      galois::steal(), galois::loopname("UnionFind"));
+
+  galois::LargeArray<std::atomic<uint64_t>> componentSize;
+  componentSize.allocateInterleaved(graph.size());
+  galois::do_all(galois::iterate(graph), [&](GNode n) { componentSize[n] = 0; },
+                 galois::no_stats());
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   componentSize[findRoot(parent, n)].fetch_add(
+                       1, std::memory_order_relaxed);
+                 },
+                 galois::loopname("ComponentSizes"));
+
+  // componentSize is nonzero exactly at roots
+  Histogram hist =
+      nodeHistogram(graph, [&](GNode n) { return componentSize[n].load(); });
+  hist.erase(0);
+
+  uint64_t numComponents = 0;
+  for (auto& p : hist) {
+    numComponents += p.second;
+  }
+
+  std::cout << "{\"stat\":\"components\",\"numComponents\":" << numComponents
+            << ",\"largestComponent\":"
+            << (hist.empty() ? 0 : hist.rbegin()->first)
+            << ",\"sizeDistribution\":";
+  printJsonHistogram(hist);
+  std::cout << "}\n";
+}
+
+struct PowerLawFit {
+  double alpha;
+  uint64_t xmin;
+  uint64_t tailNodes;
+  double ks;
+};
+
+/**
+ * Discrete power-law fit of a degree histogram (Clauset, Shalizi and Newman):
+ * the exponent is the approximate maximum likelihood estimate for degrees at
+ * least xmin, and xmin is the degree (with at least 50 nodes in the tail)
+ * whose fit has the smallest Kolmogorov-Smirnov distance to the data, unless
+ * given. Candidates are evaluated in parallel.
+ */
+static PowerLawFit fitPowerLaw(const Histogram& hist) {
+  std::vector<std::pair<uint64_t, uint64_t>> values(hist.lower_bound(1),
+                                                    hist.end());
+  size_t numValues = values.size();
+
+  // suffix sums of counts and of count * log(degree)
+  std::vector<uint64_t> tailCount(numValues + 1, 0);
+  std::vector<double> tailLog(numValues + 1, 0);
+  for (size_t i = numValues; i-- > 0;) {
+    tailCount[i] = tailCount[i + 1] + values[i].second;
+    tailLog[i]   = tailLog[i + 1] + values[i].second * std::log(values[i].first);
+  }
+
+  auto fitFrom = [&](size_t first) {
+    PowerLawFit fit;
+    fit.xmin      = values[first].first;
+    fit.tailNodes = tailCount[first];
+    double shift  = fit.xmin - 0.5;
+    fit.alpha =
+        1 + fit.tailNodes / (tailLog[first] - fit.tailNodes * std::log(shift));
+
+    // largest distance between empirical and fitted P(X >= x)
+    fit.ks = 0;
+    for (size_t i = first; i < numValues; ++i) {
+      double empirical = tailCount[i] / (double)fit.tailNodes;
+      double fitted = std::pow((values[i].first - 0.5) / shift, 1 - fit.alpha);
+      fit.ks        = std::max(fit.ks, std::abs(empirical - fitted));
+    }
+    return fit;
+  };
+
+  if (powerLawXmin) {
+    size_t first = std::lower_bound(values.begin(), values.end(),
+                                    std::make_pair((uint64_t)powerLawXmin,
+                                                   (uint64_t)0)) -
+                   values.begin();
+    if (first == numValues) {
+      return PowerLawFit{0, powerLawXmin, 0, 0};
+    }
+    return fitFrom(first);
+  }
+
+  size_t numCandidates = 0;
+  while (numCandidates < numValues && tailCount[numCandidates] >= 50) {
+    ++numCandidates;
+  }
+  if (numCandidates == 0) {
+    return numValues ? fitFrom(0) : PowerLawFit{0, 0, 0, 0};
+  }
+
+  std::vector<PowerLawFit> fits(numCandidates);
+  galois::do_all(galois::iterate((size_t)0, numCandidates),
+                 [&](size_t i) { fits[i] = fitFrom(i); }, galois::steal(),
+                 galois::loopname("PowerLawCandidates"));
+  return *std::min_element(fits.begin(), fits.end(),
+                           [](const PowerLawFit& a, const PowerLawFit& b) {
+                             return a.ks < b.ks;
+                           });
+}
+
+static void printJsonPowerLawFit(const PowerLawFit& fit) {
+  std::cout << "{\"alpha\":" << fit.alpha << ",\"alphaStdError\":"
+            << (fit.tailNodes ? (fit.alpha - 1) / std::sqrt(fit.tailNodes) : 0)
+            << ",\"xmin\":" << fit.xmin << ",\"tailNodes\":" << fit.tailNodes
+            << ",\"ks\":" << fit.ks << '}';
+}
+
+void doPowerLaw(Graph& graph) {
+  Histogram outHist =
+      nodeHistogram(graph, [&](GNode n) { return degree(graph, n); });
+
+  galois::LargeArray<std::atomic<uint64_t>> inv;
+  computeInDegrees(graph, inv);
+  Histogram inHist =
+      nodeHistogram(graph, [&](GNode n) { return inv[n].load(); });
+
+  std::cout << "{\"stat\":\"powerlaw\",\"outDegree\":";
+  printJsonPowerLawFit(fitPowerLaw(outHist));
+  std::cout << ",\"inDegree\":";
+  printJsonPowerLawFit(fitPowerLaw(inHist));
+  std::cout << "}\n";
+}
+
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
   llvm::cl::ParseCommandLineOptions(argc, argv);
+  galois::setActiveThreads(numThreads);
+  galois::runtime::setStatFile(statFile.empty() ? "/dev/null"
+                                                  : statFile.c_str());
   try {
-    Graph graph(inputfilename);
+    Graph graph;
+    graph.fromFile(inputfilename);
+    std::cout.precision(10);
     for (unsigned i = 0; i != statModeList.size(); ++i) {
       switch (statModeList[i]) {
       case degreehist:
@@ -278,6 +740,18 @@ int main(int argc, char** argv) {
       case summary:
         doSummary(graph);
         break;
+      case diameter:
+        doDiameter(graph);
+        break;
+      case clustering:
+        doClustering(graph);
+        break;
+      case components:
+        doComponents(graph);
+        break;
+      case powerlaw:
+        doPowerLaw(graph);
+        break;
       default:
         std::cerr << "Unknown stat requested\n";
         break;